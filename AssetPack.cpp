@@ -0,0 +1,150 @@
+﻿#include "AssetPack.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+using namespace GamesEngineeringBase;
+
+static const char kMagic[4] = { 'G', 'E', 'P', 'K' };
+static const uint64_t kBlobAlign = 64;
+
+/* Loading ---------------------------------------------------------------------
+ * Every entry is bounds-checked against the file before a view is made, so a
+ * truncated or foreign file is rejected up front rather than read out of
+ * range later.
+ * ---------------------------------------------------------------------------*/
+bool AssetPack::open(const char* path)
+{
+    close();
+    if (!file.open(path)) return false;
+    base = file.data();
+    const size_t size = file.size();
+
+    Header h;
+    if (size < sizeof(h)) { close(); return false; }
+    memcpy(&h, base, sizeof(h));
+    if (memcmp(h.magic, kMagic, 4) != 0 || h.version != kVersion || h.fileBytes != size ||
+        h.entryOffset > size || (size - h.entryOffset) / sizeof(Entry) < h.count) {
+        close();
+        return false;
+    }
+
+    views.resize(h.count);
+    flags.resize(h.count);
+    for (uint32_t i = 0; i < h.count; ++i) {
+        Entry e;
+        memcpy(&e, base + h.entryOffset + (size_t)i * sizeof(Entry), sizeof(e));
+        e.name[sizeof(e.name) - 1] = '\0';
+        const uint64_t need = (uint64_t)e.width * e.height * 4;
+        if (e.channels != 4 || e.width == 0 || e.height == 0 || e.bytes != need ||
+            e.offset > size || size - e.offset < e.bytes + e.height) {
+            close();
+            return false;
+        }
+        Image& v = views[i];
+        v.width = e.width; v.height = e.height; v.channels = e.channels;
+        v.data = const_cast<unsigned char*>(base + e.offset);   // read-only mapping, never written
+        flags[i] = e.flags;
+        index[e.name] = (int)i;
+    }
+    return true;
+}
+
+void AssetPack::close()
+{
+    for (Image& v : views) v.data = nullptr;   // views don't own their pixels
+    views.clear();
+    flags.clear();
+    index.clear();
+    file.close();
+    base = nullptr;
+}
+
+const Image* AssetPack::find(const std::string& name) const
+{
+    auto it = index.find(name);
+    return it == index.end() ? nullptr : &views[it->second];
+}
+
+bool AssetPack::viewPixels(const std::string& name, PixelImage& out) const
+{
+    auto it = index.find(name);
+    if (it == index.end()) { out.clear(); return false; }
+    const Image& v = views[it->second];
+    return out.view(v.data, (int)v.width, (int)v.height, (int)v.width * 4, v.data + (size_t)v.width * v.height * 4);
+}
+
+bool AssetPack::isOpaque(const std::string& name) const
+{
+    auto it = index.find(name);
+    return it != index.end() && (flags[it->second] & kFlagOpaque) != 0;
+}
+
+/* Packing ---------------------------------------------------------------------
+ * Each image goes through PixelImage::assign, the same normalization a
+ * decoded tile gets at load time; its rows are written without padding
+ * (so find()'s Image view stays valid) followed by the row coverage.
+ * ---------------------------------------------------------------------------*/
+int writeAssetPack(const char* folder, const char* outPath)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::vector<std::string> files;
+    for (const fs::directory_entry& d : fs::directory_iterator(folder, ec)) {
+        if (!d.is_regular_file()) continue;
+        std::string ext = d.path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return (char)tolower(c); });
+        if (ext == ".png") files.push_back(d.path().generic_string());
+    }
+    if (ec) return -1;
+    std::sort(files.begin(), files.end());   // stable output for identical inputs
+
+    std::vector<AssetPack::Entry> entries;
+    std::vector<PixelImage> images;
+    entries.reserve(files.size());
+    images.reserve(files.size());
+    for (const std::string& f : files) {
+        AssetPack::Entry e;
+        memset(&e, 0, sizeof(e));
+        if (f.size() >= sizeof(e.name)) { printf("[pack] name too long, skipped: %s\n", f.c_str()); continue; }
+        Image img;
+        PixelImage pix;
+        if (!img.load(f) || !img.data || !pix.assign(img)) { printf("[pack] failed to decode, skipped: %s\n", f.c_str()); continue; }
+        memcpy(e.name, f.c_str(), f.size());
+        e.width = img.width; e.height = img.height; e.channels = 4;
+        e.bytes = (uint64_t)img.width * img.height * 4;
+        e.flags = pix.coverage() == PixelImage::Opaque ? AssetPack::kFlagOpaque : 0;
+        entries.push_back(e);
+        images.push_back(std::move(pix));
+    }
+
+    AssetPack::Header h;
+    memcpy(h.magic, kMagic, 4);
+    h.version = AssetPack::kVersion;
+    h.count = (uint32_t)entries.size();
+    h.entryOffset = (uint32_t)sizeof(h);
+    uint64_t cursor = sizeof(h) + (uint64_t)entries.size() * sizeof(AssetPack::Entry);
+    for (AssetPack::Entry& e : entries) {
+        cursor = (cursor + kBlobAlign - 1) / kBlobAlign * kBlobAlign;
+        e.offset = cursor;
+        cursor += e.bytes + e.height;
+    }
+    h.fileBytes = cursor;
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    if (!out) return -1;
+    out.write((const char*)&h, sizeof(h));
+    out.write((const char*)entries.data(), (std::streamsize)(entries.size() * sizeof(AssetPack::Entry)));
+    uint64_t written = sizeof(h) + (uint64_t)entries.size() * sizeof(AssetPack::Entry);
+    static const char zeros[kBlobAlign] = {};
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const PixelImage& pix = images[i];
+        out.write(zeros, (std::streamsize)(entries[i].offset - written));
+        for (int y = 0; y < pix.getHeight(); ++y)
+            out.write((const char*)pix.row(y), (std::streamsize)pix.getWidth() * 4);
+        for (int y = 0; y < pix.getHeight(); ++y) out.put((char)pix.rowCoverage(y));
+        written = entries[i].offset + entries[i].bytes + entries[i].height;
+    }
+    return out ? (int)entries.size() : -1;
+}
@@ -0,0 +1,79 @@
+﻿#pragma once
+#include "Image.h"
+#include "MappedFile.h"
+#include "PixelImage.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+/********************************  AssetPack  **********************************
+ * Read-only, memory-mapped pack of pre-decoded images.
+ *   - Built offline by writeAssetPack() (game: --pack-assets): every PNG in
+ *     a folder is decoded once and normalized by PixelImage::assign, so
+ *     each image is stored as tight RGBA8888 rows followed by its per-row
+ *     coverage bytes (3-channel sources gain alpha 255 on disk).
+ *   - open() maps the file (MappedFile) and validates the header
+ *     and entry table; find() then hands out Image views whose `data` points
+ *     straight into the mapping, and viewPixels() PixelImage views of the
+ *     same bytes. Nothing is decoded, converted or copied at runtime and
+ *     pages are only faulted in when first drawn.
+ *   - Views stay valid until close(); never free() them.
+ *
+ * File layout (little-endian, version 2):
+ *   Header | Entry[count] | blobs, each 64-byte aligned:
+ *   width * height * 4 pixel bytes, then height coverage bytes
+ * Entry names are the paths the game passes to Image::load, with '/'
+ * separators (e.g. "Resources/14.png").
+ *******************************************************************************/
+class AssetPack
+{
+public:
+    static const uint32_t kVersion = 2;
+    static const uint32_t kFlagOpaque = 1;     // no alpha below kBlitAlphaCutoff
+
+    struct Header
+    {
+        char     magic[4];                     // "GEPK"
+        uint32_t version;
+        uint32_t count;                        // Entries
+        uint32_t entryOffset;                  // Bytes from file start
+        uint64_t fileBytes;                    // Whole file, for truncation checks
+    };
+    struct Entry
+    {
+        char     name[64];                     // NUL-terminated
+        uint32_t width, height, channels, flags;   // channels is always 4
+        uint64_t offset, bytes;                // Pixels from file start; coverage follows
+    };
+
+    AssetPack() = default;
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+    ~AssetPack() { close(); }
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // Zero-copy view of a packed image, or nullptr if the pack doesn't have it
+    const GamesEngineeringBase::Image* find(const std::string& name) const;
+    // Blit-ready view of the same pixels (rows are 64-byte aligned when
+    // width * 4 is a multiple of 64); false if the pack doesn't have it
+    bool viewPixels(const std::string& name, PixelImage& out) const;
+    bool isOpaque(const std::string& name) const;
+
+    int    count() const { return (int)views.size(); }
+    size_t mappedBytes() const { return file.size(); }
+
+private:
+    MappedFile file;
+    const unsigned char* base = nullptr;   // file.data() while open
+    std::vector<GamesEngineeringBase::Image> views;   // data aliases the mapping
+    std::vector<uint32_t> flags;
+    std::unordered_map<std::string, int> index;
+};
+
+// Decodes every .png under `folder` (non-recursive) with Image::load and writes
+// a pack to `outPath`. Returns the number of images packed, or -1 on error.
+int writeAssetPack(const char* folder, const char* outPath);
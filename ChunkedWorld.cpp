@@ -0,0 +1,125 @@
+﻿#include "ChunkedWorld.h"
+#include <algorithm>
+#include <cstdlib>
+
+/* Noise -----------------------------------------------------------------------
+ * Value noise: a hashed value in [0, 1) on every period-th tile, smoothly
+ * interpolated in between; three octaves summed for the height field.
+ * ---------------------------------------------------------------------------*/
+static inline uint32_t hash3(int x, int y, uint32_t s)
+{
+    uint32_t h = (uint32_t)x * 0x8DA6B343u ^ (uint32_t)y * 0xD8163841u ^ s * 0xCB1AB31Fu;
+    h ^= h >> 15; h *= 0x2C1B3C6Du;
+    h ^= h >> 12; h *= 0x297A2D39u;
+    return h ^ (h >> 15);
+}
+
+static inline float unit(uint32_t h) { return (float)(h >> 8) * (1.0f / 16777216.0f); }
+
+static inline int floorDiv(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+float NoiseTerrainGenerator::noise(int x, int y, int period, uint32_t salt) const
+{
+    const int gx = floorDiv(x, period), gy = floorDiv(y, period);
+    float fx = (float)(x - gx * period) / period, fy = (float)(y - gy * period) / period;
+    fx = fx * fx * (3.f - 2.f * fx);
+    fy = fy * fy * (3.f - 2.f * fy);
+
+    const uint32_t s = seed + salt;
+    const float a = unit(hash3(gx, gy, s)), b = unit(hash3(gx + 1, gy, s));
+    const float c = unit(hash3(gx, gy + 1, s)), d = unit(hash3(gx + 1, gy + 1, s));
+    const float top = a + (b - a) * fx, bottom = c + (d - c) * fx;
+    return top + (bottom - top) * fy;
+}
+
+float NoiseTerrainGenerator::fbm(int x, int y, uint32_t salt) const
+{
+    return (noise(x, y, 32, salt) * 4.f + noise(x, y, 16, salt + 1) * 2.f + noise(x, y, 8, salt + 2)) * (1.f / 7.f);
+}
+
+int NoiseTerrainGenerator::tileAt(int x, int y) const
+{
+    const float height = fbm(x, y, 0);
+    if (height < 0.36f) return 14;                         // deep water (blocking)
+    if (height < 0.41f) return 13;                         // shore
+
+    if (fbm(x, y, 101) > 0.62f) return 4 + (int)(hash3(x, y, seed + 7) % 3);
+
+    static const int kGrassVariants[] = { 1, 2, 3, 23 };
+    const uint32_t h = hash3(x, y, seed + 13);
+    return (h % 100 < 6) ? kGrassVariants[(h >> 8) & 3] : 0;
+}
+
+void NoiseTerrainGenerator::fill(int cx, int cy, uint16_t* cells) const
+{
+    const int x0 = cx * kMapChunkTiles, y0 = cy * kMapChunkTiles;
+    for (int ty = 0; ty < kMapChunkTiles; ++ty)
+        for (int tx = 0; tx < kMapChunkTiles; ++tx)
+            *cells++ = (uint16_t)tileAt(x0 + tx, y0 + ty);
+}
+
+/* Residency -------------------------------------------------------------------
+ * A miss brings a chunk back from the parked edits, else generates it. Chunks
+ * live behind unique_ptr, so `last` stays valid across rehashes; anything that
+ * erases a chunk resets it.
+ * ---------------------------------------------------------------------------*/
+ChunkedWorld::Chunk& ChunkedWorld::fetch(int cx, int cy) const
+{
+    const uint64_t k = key(cx, cy);
+    if (last && k == lastKey) return *last;
+
+    std::unique_ptr<Chunk>& slot = chunks[k];
+    if (!slot) {
+        auto it = parked.find(k);
+        if (it != parked.end()) {
+            slot = std::move(it->second);
+            parked.erase(it);
+        }
+        else {
+            slot.reset(new Chunk());
+            if (gen) gen->fill(cx, cy, slot->cells);
+            else     std::fill(slot->cells, slot->cells + kMapChunkCells, kMapEmptyCell);
+            ++generated;
+        }
+    }
+    lastKey = k;
+    last = slot.get();
+    return *last;
+}
+
+bool ChunkedWorld::set(int x, int y, int id)
+{
+    Chunk& c = fetch(x >> kMapChunkShift, y >> kMapChunkShift);
+    uint16_t& cell = c.cells[((y & (kMapChunkTiles - 1)) << kMapChunkShift) | (x & (kMapChunkTiles - 1))];
+    const uint16_t v = (id < 0 || id >= kMapEmptyCell) ? kMapEmptyCell : (uint16_t)id;
+    if (cell == v) return false;
+    cell = v;
+    c.edited = true;
+    return true;
+}
+
+void ChunkedWorld::update(int centerX, int centerY, int radiusChunks)
+{
+    const int ccx = centerX >> kMapChunkShift, ccy = centerY >> kMapChunkShift;
+
+    const int keep = radiusChunks + 1;
+    for (auto it = chunks.begin(); it != chunks.end(); ) {
+        const int cx = (int)(uint32_t)(it->first >> 32), cy = (int)(uint32_t)it->first;
+        if (std::abs(cx - ccx) <= keep && std::abs(cy - ccy) <= keep) { ++it; continue; }
+        if (it->second->edited) parked[it->first] = std::move(it->second);
+        it = chunks.erase(it);
+        ++unloaded;
+    }
+    last = nullptr;
+
+    for (int cy = ccy - radiusChunks; cy <= ccy + radiusChunks; ++cy)
+        for (int cx = ccx - radiusChunks; cx <= ccx + radiusChunks; ++cx)
+            fetch(cx, cy);
+}
+
+void ChunkedWorld::clear()
+{
+    chunks.clear();
+    parked.clear();
+    last = nullptr;
+}
@@ -0,0 +1,102 @@
+﻿#pragma once
+#include "MapFile.h"
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+/*******************************  TileGenerator  *******************************
+ * Source of tile IDs for chunks nobody has stored: fill() writes the
+ * kMapChunkCells cells of chunk (cx, cy) in MapFile.h chunk order
+ * ((y & 15) << 4 | (x & 15)). It must be deterministic, because an unloaded
+ * chunk is simply generated again the next time it is needed.
+ *******************************************************************************/
+class TileGenerator
+{
+public:
+    virtual ~TileGenerator() {}
+    virtual void fill(int cx, int cy, uint16_t* cells) const = 0;
+};
+
+/****************************  NoiseTerrainGenerator  **************************
+ * Seeded value-noise terrain using the stock tile art: deep water (14, which
+ * blocks), dirt shores (13), grass (0 with the 1-3/23 variants sprinkled in)
+ * and darker meadow patches (4-6) where a second noise field is high.
+ *******************************************************************************/
+class NoiseTerrainGenerator : public TileGenerator
+{
+public:
+    explicit NoiseTerrainGenerator(uint32_t seed = 1337) : seed(seed) {}
+    void fill(int cx, int cy, uint16_t* cells) const override;
+
+    // Tile ID at world tile (x, y); fill() is this over a whole chunk
+    int tileAt(int x, int y) const;
+
+private:
+    uint32_t seed;
+    float noise(int x, int y, int period, uint32_t salt) const;
+    float fbm(int x, int y, uint32_t salt) const;
+};
+
+/********************************  ChunkedWorld  *******************************
+ * Sparse, unbounded tile storage for TileMap::attachWorld.
+ *   - The world is cut into kMapChunkTiles x kMapChunkTiles chunks kept in a
+ *     hash map keyed by chunk coordinate; nothing exists until it is read.
+ *   - get() generates a missing chunk on the spot, so any coordinate answers
+ *     (collision far from the camera included). update() loads the square of
+ *     chunks around the camera ahead of time and unloads everything more than
+ *     one chunk outside it, so resident memory follows the view, not the
+ *     distance travelled.
+ *   - Chunks changed through set() are parked on unload instead of dropped
+ *     and come back from there, so edits survive; only edits cost memory.
+ *******************************************************************************/
+class ChunkedWorld
+{
+public:
+    explicit ChunkedWorld(const TileGenerator* generator) : gen(generator) {}
+    ChunkedWorld(const ChunkedWorld&) = delete;
+    ChunkedWorld& operator=(const ChunkedWorld&) = delete;
+
+    // Tile ID at (x, y), -1 for an empty cell
+    int get(int x, int y) const
+    {
+        const Chunk& c = fetch(x >> kMapChunkShift, y >> kMapChunkShift);
+        const uint16_t cell = c.cells[((y & (kMapChunkTiles - 1)) << kMapChunkShift) | (x & (kMapChunkTiles - 1))];
+        return cell == kMapEmptyCell ? -1 : (int)cell;
+    }
+
+    // Stores id at (x, y); returns false if the tile already held it
+    bool set(int x, int y, int id);
+
+    // Loads the chunks within radiusChunks of the chunk holding tile
+    // (centerX, centerY) and unloads the ones beyond radiusChunks + 1
+    void update(int centerX, int centerY, int radiusChunks);
+
+    // Forgets every chunk, edits included (e.g. a new seed)
+    void clear();
+
+    // Debug counters
+    int    residentChunks() const { return (int)chunks.size(); }
+    size_t residentBytes()  const { return chunks.size() * sizeof(Chunk); }
+    int    parkedChunks()   const { return (int)parked.size(); }
+    int    generatedCount() const { return generated; }
+    int    unloadCount()    const { return unloaded; }
+
+private:
+    struct Chunk
+    {
+        uint16_t cells[kMapChunkCells];
+        bool edited = false;              // Parked instead of dropped on unload
+    };
+    using ChunkMap = std::unordered_map<uint64_t, std::unique_ptr<Chunk>>;
+
+    const TileGenerator* gen;
+    mutable ChunkMap chunks;              // Resident chunks
+    mutable ChunkMap parked;              // Edited chunks outside the view
+    mutable uint64_t lastKey = 0;         // One-entry lookup cache: neighbouring
+    mutable Chunk* last = nullptr;        // reads mostly hit the same chunk
+    mutable int generated = 0;
+    int unloaded = 0;
+
+    static uint64_t key(int cx, int cy) { return ((uint64_t)(uint32_t)cx << 32) | (uint32_t)cy; }
+    Chunk& fetch(int cx, int cy) const;
+};
@@ -0,0 +1,56 @@
+﻿#include "CpuFeatures.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CPU_X86 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <immintrin.h>
+#endif
+#endif
+
+/* Probe -----------------------------------------------------------------------*/
+static CpuIsa probeIsa()
+{
+#if defined(CPU_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool ssse3 = (info[2] & (1 << 9)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osxsave && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+    if (avx2)  return CpuIsa::AVX2;
+    if (ssse3) return CpuIsa::SSSE3;
+    if (sse2)  return CpuIsa::SSE2;
+    return CpuIsa::Scalar;
+#elif defined(CPU_X86)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))  return CpuIsa::AVX2;
+    if (__builtin_cpu_supports("ssse3")) return CpuIsa::SSSE3;
+    if (__builtin_cpu_supports("sse2"))  return CpuIsa::SSE2;
+    return CpuIsa::Scalar;
+#else
+    return CpuIsa::Scalar;
+#endif
+}
+
+CpuIsa cpuDetectIsa()
+{
+    static const CpuIsa detected = probeIsa();
+    return detected;
+}
+
+const char* cpuIsaName(CpuIsa isa)
+{
+    switch (isa) {
+    case CpuIsa::AVX2:  return "avx2";
+    case CpuIsa::SSSE3: return "ssse3";
+    case CpuIsa::SSE2:  return "sse2";
+    default:            return "scalar";
+    }
+}
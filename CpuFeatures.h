@@ -0,0 +1,14 @@
+﻿#pragma once
+
+/********************************  CpuFeatures  ********************************
+ * x86 SIMD level of the running CPU, shared by every kernel with runtime
+ * dispatch (blitRowRGBA, NPCStore::steerAll).
+ *   - cpuDetectIsa() probes once (CPUID; AVX2 also needs the OS to save YMM
+ *     state, checked with XGETBV) and caches the answer.
+ *   - Levels are ordered, so "at least SSSE3" is a plain comparison.
+ *   - Non-x86 builds always report Scalar.
+ *******************************************************************************/
+enum class CpuIsa { Scalar = 0, SSE2 = 1, SSSE3 = 2, AVX2 = 3 };
+
+CpuIsa      cpuDetectIsa();            // best level supported by this CPU
+const char* cpuIsaName(CpuIsa isa);
@@ -0,0 +1,157 @@
+﻿#include "DirtyRects.h"
+#include "GamesEngineeringBase.h"
+#include <algorithm>
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+/* Window attachment -----------------------------------------------------------*/
+struct DirtySlot { const Window* window; DirtyRects* tracker; };
+static DirtySlot gDirtySlot = { nullptr, nullptr };
+
+void DirtyRects::attach(Window& w, DirtyRects* tracker)
+{
+    gDirtySlot.window = tracker ? &w : nullptr;
+    gDirtySlot.tracker = tracker;
+}
+
+DirtyRects* DirtyRects::attachedTo(const Window& w)
+{
+    return (gDirtySlot.window == &w) ? gDirtySlot.tracker : nullptr;
+}
+
+/* Coalescing ------------------------------------------------------------------*/
+static long long area(const DirtyRects::Rect& r) { return (long long)(r.x1 - r.x0) * (r.y1 - r.y0); }
+
+static DirtyRects::Rect unite(const DirtyRects::Rect& a, const DirtyRects::Rect& b)
+{
+    return { std::min(a.x0, b.x0), std::min(a.y0, b.y0), std::max(a.x1, b.x1), std::max(a.y1, b.y1) };
+}
+
+// Overlapping or edge-adjacent
+static bool touches(const DirtyRects::Rect& a, const DirtyRects::Rect& b)
+{
+    return a.x0 <= b.x1 && b.x0 <= a.x1 && a.y0 <= b.y1 && b.y0 <= a.y1;
+}
+
+void DirtyRects::reset(int width, int height)
+{
+    boundsW = width; boundsH = height;
+    rects.clear();
+}
+
+void DirtyRects::add(int x, int y, int w, int h)
+{
+    Rect r = { x, y, x + w, y + h };
+    if (r.x0 < 0) r.x0 = 0; if (r.y0 < 0) r.y0 = 0;
+    if (r.x1 > boundsW) r.x1 = boundsW; if (r.y1 > boundsH) r.y1 = boundsH;
+    if (r.x0 >= r.x1 || r.y0 >= r.y1) return;
+    insert(r);
+}
+
+void DirtyRects::add(const DirtyRects& other)
+{
+    for (const Rect& r : other.rects) insert(r);
+}
+
+void DirtyRects::insert(Rect r)
+{
+    // Absorb everything the growing rect touches; repeat since it may now
+    // reach rects it missed on the previous pass
+    for (bool merged = true; merged; ) {
+        merged = false;
+        for (size_t i = 0; i < rects.size(); ) {
+            if (touches(r, rects[i])) {
+                r = unite(r, rects[i]);
+                rects[i] = rects.back();
+                rects.pop_back();
+                merged = true;
+            }
+            else ++i;
+        }
+    }
+    rects.push_back(r);
+    if ((int)rects.size() <= kMaxRects) return;
+
+    // Over budget: merge the cheapest pair, then re-insert so the list stays disjoint
+    size_t bi = 0, bj = 1;
+    long long best = -1;
+    for (size_t i = 0; i < rects.size(); ++i)
+        for (size_t j = i + 1; j < rects.size(); ++j) {
+            long long waste = area(unite(rects[i], rects[j])) - area(rects[i]) - area(rects[j]);
+            if (best < 0 || waste < best) { best = waste; bi = i; bj = j; }
+        }
+    Rect u = unite(rects[bi], rects[bj]);
+    rects[bj] = rects.back(); rects.pop_back();
+    rects[bi] = rects.back(); rects.pop_back();
+    insert(u);
+}
+
+bool DirtyRects::full() const
+{
+    return rects.size() == 1 && rects[0].x0 == 0 && rects[0].y0 == 0
+        && rects[0].x1 == boundsW && rects[0].y1 == boundsH;
+}
+
+long long DirtyRects::pixelCount() const
+{
+    long long n = 0;
+    for (const Rect& r : rects) n += area(r);
+    return n;
+}
+
+/* DirtyFrame ------------------------------------------------------------------*/
+void DirtyFrame::begin(Window& w)
+{
+    begin((int)w.getWidth(), (int)w.getHeight());
+    DirtyRects::attach(w, &now);
+}
+
+void DirtyFrame::begin(int width, int height)
+{
+    // A resize invalidates what the GPU holds: treat the whole buffer as stale
+    if (previous.width() != width || previous.height() != height) {
+        previous.reset(width, height);
+        previous.addAll();
+    }
+    now.reset(width, height);
+}
+
+void DirtyFrame::clear(unsigned char* rgb, int pitch) const
+{
+    for (int i = 0; i < previous.count(); ++i) {
+        const DirtyRects::Rect& r = previous[i];
+        for (int y = r.y0; y < r.y1; ++y)
+            memset(rgb + (size_t)y * pitch + (size_t)r.x0 * 3, 0, (size_t)(r.x1 - r.x0) * 3);
+    }
+}
+
+// Past half the buffer, one full upload beats a call per rect: the saved
+// bytes no longer pay for the extra calls.
+const DirtyRects& DirtyFrame::endFrame()
+{
+    upload.reset(now.width(), now.height());
+    upload.add(previous);
+    upload.add(now);
+
+    lastDirtyPx = upload.pixelCount();
+    if (lastDirtyPx * 2 > (long long)upload.width() * upload.height()) {
+        upload.clear();
+        upload.addAll();
+    }
+    lastUploadBytes = upload.pixelCount() * 3;
+
+    std::swap(previous, now);
+    now.reset(previous.width(), previous.height());
+    return upload;
+}
+
+void DirtyFrame::present(Window& w)
+{
+    const DirtyRects& u = endFrame();
+    boxes.clear();
+    for (int i = 0; i < u.count(); ++i) {
+        const DirtyRects::Rect& r = u[i];
+        boxes.insert(boxes.end(), { r.x0, r.y0, r.x1, r.y1 });
+    }
+    w.present(boxes.data(), u.count());
+}
@@ -0,0 +1,92 @@
+﻿#pragma once
+#include <vector>
+
+namespace GamesEngineeringBase { class Window; }
+
+/******************************  DirtyRects  ***********************************
+ * Coalesced list of back-buffer rectangles touched this frame.
+ *   - add() clips to the surface bounds, then merges the new rect with any
+ *     rect it overlaps or touches, so the list stays disjoint and small.
+ *     Past kMaxRects the two rects whose union wastes the least area are
+ *     merged, which keeps add() bounded no matter how many sprites draw.
+ *   - A tracker can be attached to a Window: Surface::of(window) then records
+ *     into it, and Window-only loops call markDirty(window, ...).
+ *******************************************************************************/
+class DirtyRects
+{
+public:
+    struct Rect { int x0, y0, x1, y1; };    // Half-open [x0, x1) x [y0, y1)
+    static const int kMaxRects = 32;
+
+    // Sets the clip bounds and empties the list
+    void reset(int width, int height);
+    void clear() { rects.clear(); }
+
+    void add(int x, int y, int w, int h);
+    void addAll() { add(0, 0, boundsW, boundsH); }
+    void add(const DirtyRects& other);
+
+    int  count() const { return (int)rects.size(); }
+    const Rect& operator[](int i) const { return rects[i]; }
+    bool empty() const { return rects.empty(); }
+    bool full() const;
+    long long pixelCount() const;
+    int  width() const { return boundsW; }
+    int  height() const { return boundsH; }
+
+    // Window attachment (one tracker per window; nullptr detaches)
+    static void attach(GamesEngineeringBase::Window& w, DirtyRects* tracker);
+    static DirtyRects* attachedTo(const GamesEngineeringBase::Window& w);
+
+private:
+    std::vector<Rect> rects;
+    int boundsW = 0, boundsH = 0;
+
+    void insert(Rect r);
+};
+
+// Records a rect on the tracker attached to w (no-op when none is attached)
+inline void markDirty(GamesEngineeringBase::Window& w, int x, int y, int wdt, int hgt)
+{
+    if (DirtyRects* d = DirtyRects::attachedTo(w)) d->add(x, y, wdt, hgt);
+}
+
+/******************************  DirtyFrame  ***********************************
+ * Frame-to-frame bookkeeping for a back buffer that is rebuilt every frame.
+ * Pixels that differ from what the GPU already holds are the ones drawn this
+ * frame plus the ones drawn last frame (which have since been cleared or
+ * restored from the background), so:
+ *   - begin() attaches `current` to the window for this frame's draws;
+ *   - stale() is last frame's list: the only area clear() must blank (or a
+ *     background must restore) instead of the whole buffer;
+ *   - present() uploads stale() + current only, one call per coalesced
+ *     rect (or the whole buffer once they cover more than half of it), then
+ *     rolls the lists over.
+ *******************************************************************************/
+class DirtyFrame
+{
+public:
+    void begin(GamesEngineeringBase::Window& w);
+    void begin(int width, int height);      // Headless: no window attached
+
+    const DirtyRects& stale() const { return previous; }
+    DirtyRects& current() { return now; }
+
+    // Blanks last frame's rects in an RGB24 buffer (replaces Window::clear)
+    void clear(unsigned char* rgb, int pitch) const;
+
+    // Uploads the union of stale and current rects and presents
+    void present(GamesEngineeringBase::Window& w);
+
+    // Headless half of present(): computes the rects to upload and rolls over
+    const DirtyRects& endFrame();
+
+    // Last frame's totals, for logging
+    long long dirtyPixels() const { return lastDirtyPx; }
+    long long uploadBytes() const { return lastUploadBytes; }
+
+private:
+    DirtyRects previous, now, upload;
+    std::vector<int> boxes;                 // upload as x0, y0, x1, y1 quads
+    long long lastDirtyPx = 0, lastUploadBytes = 0;
+};
@@ -0,0 +1,93 @@
+﻿#include "FlowField.h"
+#include "TileMap.h"
+#include <cmath>
+
+// Neighbour offsets: 4 orthogonal, then 4 diagonal; k ^ 1 is the opposite of k
+static const int kDx[8] = { 1, -1, 0, 0, 1, -1, 1, -1 };
+static const int kDy[8] = { 0, 0, 1, -1, 1, -1, -1, 1 };
+static const float kDiag = 0.70710678f;
+static const float kUx[8] = { 1.f, -1.f, 0.f, 0.f, kDiag, -kDiag, kDiag, -kDiag };
+static const float kUy[8] = { 0.f, 0.f, 1.f, -1.f, kDiag, -kDiag, -kDiag, kDiag };
+
+static inline int floorDiv(int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); }
+
+bool FlowField::update(const TileMap& map, int goalTx, int goalTy)
+{
+    if (valid && goalTx == goalX && goalTy == goalY && map.getRevision() == mapRevision) return false;
+    goalX = goalTx; goalY = goalTy;
+    rebuild(map);
+    return true;
+}
+
+/* Search ----------------------------------------------------------------------
+ * 8-connected BFS (every step costs one) from the goal. A diagonal step is
+ * only taken when both orthogonal tiles it passes are open, so NPCs never
+ * clip a water corner. Tiles the map reports as empty (off a fixed map)
+ * count as blocked.
+ * ---------------------------------------------------------------------------*/
+void FlowField::rebuild(const TileMap& map)
+{
+    side = 2 * radius + 1;
+    originX = goalX - radius;
+    originY = goalY - radius;
+    tileW = map.getTileW();
+    tileH = map.getTileH();
+    mapRevision = map.getRevision();
+    valid = true;
+    ++rebuilds;
+
+    const size_t n = (size_t)side * side;
+    dist.assign(n, kUnreachable);
+    dirs.assign(n, kNoDir);
+    open.resize(n);
+    for (int y = 0; y < side; ++y)
+        for (int x = 0; x < side; ++x) {
+            const int tx = originX + x, ty = originY + y;
+            open[(size_t)y * side + x] = (map.get(tx, ty) >= 0 && !map.isBlockedAt(tx, ty)) ? 1 : 0;
+        }
+
+    queue.resize(n);
+    int head = 0, tail = 0;
+    const int goal = radius * side + radius;
+    reached = 0;
+    if (!open[goal]) return;   // goal on a blocked tile: nothing to follow
+    dist[goal] = 0;
+    queue[tail++] = goal;
+
+    while (head < tail) {
+        const int cell = queue[head++];
+        const int cx = cell % side, cy = cell / side;
+        const uint16_t next = (uint16_t)(dist[cell] + 1);
+        for (int k = 0; k < 8; ++k) {
+            const int nx = cx + kDx[k], ny = cy + kDy[k];
+            if (nx < 0 || ny < 0 || nx >= side || ny >= side) continue;
+            const int ncell = ny * side + nx;
+            if (!open[ncell] || dist[ncell] != kUnreachable) continue;
+            if (k >= 4 && (!open[cy * side + nx] || !open[ny * side + cx])) continue;
+            dist[ncell] = next;
+            // The neighbour walks back to `cell`: the opposite offset
+            dirs[ncell] = (uint8_t)(k ^ 1);
+            queue[tail++] = ncell;
+        }
+    }
+    reached = tail;
+}
+
+bool FlowField::direction(float wx, float wy, float& dx, float& dy) const
+{
+    if (!valid) return false;
+    const int x = floorDiv((int)std::floor(wx), tileW) - originX;
+    const int y = floorDiv((int)std::floor(wy), tileH) - originY;
+    if (x < 0 || y < 0 || x >= side || y >= side) return false;
+    const uint8_t d = dirs[(size_t)y * side + x];
+    if (d == kNoDir) return false;
+    dx = kUx[d]; dy = kUy[d];
+    return true;
+}
+
+uint16_t FlowField::distanceAt(int tx, int ty) const
+{
+    const int x = tx - originX, y = ty - originY;
+    if (!valid || x < 0 || y < 0 || x >= side || y >= side) return kUnreachable;
+    return dist[(size_t)y * side + x];
+}
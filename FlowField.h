@@ -0,0 +1,60 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+class TileMap;
+
+/*********************************  FlowField  *********************************
+ * Shared pathfinding toward one goal tile (the player) for every NPC.
+ *   - A breadth-first search over the walkable tiles of a square window
+ *     around the goal gives each tile its step distance; each tile then
+ *     stores the direction to its closest neighbour (8-way, no cutting past
+ *     a blocked corner), so an NPC reads its heading in O(1).
+ *   - update() rebuilds only when the goal changes tile or the map changes
+ *     (TileMap revision); other frames cost one comparison.
+ *   - Tiles outside the window, blocked, unreachable or the goal itself have
+ *     no direction; callers steer straight at the target there.
+ *******************************************************************************/
+class FlowField
+{
+public:
+    static constexpr uint16_t kUnreachable = 0xFFFF;
+
+    // Window half-size in tiles: (2r+1)^2 tiles are searched (default 32)
+    void setRadius(int tiles) { radius = tiles < 1 ? 1 : tiles; valid = false; }
+    int  getRadius() const { return radius; }
+
+    // Rebuilds the field if the goal tile or the map changed; returns true
+    // when it did
+    bool update(const TileMap& map, int goalTx, int goalTy);
+
+    // Unit direction to walk from world pixel (wx, wy); false where the
+    // field has none (see above)
+    bool direction(float wx, float wy, float& dx, float& dy) const;
+
+    // Step distance from tile (tx, ty) to the goal, kUnreachable outside
+    // the window or where no path exists
+    uint16_t distanceAt(int tx, int ty) const;
+
+    // Debug counters
+    int rebuildCount() const { return rebuilds; }
+    int reachedTiles() const { return reached; }
+
+private:
+    int radius = 32;
+    int side = 0;                       // 2 * radius + 1
+    int originX = 0, originY = 0;       // Tile at window cell (0, 0)
+    int goalX = 0, goalY = 0;
+    int tileW = 1, tileH = 1;
+    unsigned int mapRevision = 0;
+    bool valid = false;
+
+    std::vector<uint16_t> dist;         // side * side, kUnreachable = not reached
+    std::vector<uint8_t>  dirs;         // Index into kDirs, kNoDir = none
+    std::vector<uint8_t>  open;         // 1 = walkable, 0 = blocked
+    std::vector<int>      queue;        // BFS scratch (cell indices)
+    int rebuilds = 0, reached = 0;
+
+    static constexpr uint8_t kNoDir = 8;
+    void rebuild(const TileMap& map);
+};
@@ -0,0 +1,42 @@
+﻿#pragma once
+#include "GamesEngineeringBase.h"
+#include "Surface.h"
+#include "blit32.h"
+#include <vector>
+
+/*****************************  FrameBuffer32  *********************************
+ * Owned RGBX8888 frame for the alternative back-buffer mode.
+ *   - Draw into surface() with the Surface32 primitives (or a BandRasterizer).
+ *   - resolve() converts to RGB24 once per frame: into the window back buffer
+ *     before Window::present, or into any headless RGB24 buffer (dumps,
+ *     benchmarks). With a DirtyRects list only those rects are converted.
+ *******************************************************************************/
+class FrameBuffer32
+{
+public:
+    // Reallocates on size change (contents undefined afterwards)
+    void resize(int w, int h)
+    {
+        if (w == view.width && h == view.height) return;
+        pixels.assign((size_t)w * h, 0);
+        view = Surface32::wrap(pixels.data(), w, h);
+    }
+
+    const Surface32& surface() const { return view; }
+    Surface32& surface() { return view; }
+
+    void resolve(const Surface& dst) const { convertToRGB24(view, dst); }
+
+    void resolve(const Surface& dst, const DirtyRects& rects) const
+    {
+        for (int i = 0; i < rects.count(); ++i) {
+            const DirtyRects::Rect& r = rects[i];
+            for (int y = r.y0; y < r.y1; ++y)
+                packRowRGBX(dst.row(y) + (size_t)r.x0 * 3, view.row(y) + r.x0, r.x1 - r.x0);
+        }
+    }
+
+private:
+    std::vector<uint32_t> pixels;
+    Surface32 view;
+};
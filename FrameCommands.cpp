@@ -0,0 +1,245 @@
+﻿#include "FrameCommands.h"
+#include "gfx_utils.h"
+#include "blit.h"
+#include "blit32.h"
+#include "SpanSprite.h"
+#include "PixelImage.h"
+#include "ScrollingBackground.h"
+#include <cstdio>
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+/* Recording -------------------------------------------------------------------*/
+FrameCommands::Cmd& FrameCommands::push(Kind k, int x0, int y0, int x1, int y1)
+{
+    cmds.emplace_back();
+    Cmd& c = cmds.back();
+    memset(&c, 0, sizeof(c));
+    c.kind = k;
+    c.x0 = x0; c.y0 = y0; c.x1 = x1; c.y1 = y1;
+    return c;
+}
+
+void FrameCommands::fillRect(int x, int y, int w, int h, unsigned char r, unsigned char g, unsigned char b)
+{
+    if (w <= 0 || h <= 0) return;
+    Cmd& c = push(Fill, x, y, x + w, y + h);
+    c.x = x; c.y = y; c.w = w; c.h = h;
+    c.r = r; c.g = g; c.b = b;
+}
+
+void FrameCommands::fillRectStipple(int x, int y, int w, int h, unsigned char r, unsigned char g, unsigned char b, int pattern)
+{
+    if (w <= 0 || h <= 0) return;
+    Cmd& c = push(Stipple, x, y, x + w, y + h);
+    c.x = x; c.y = y; c.w = w; c.h = h;
+    c.r = r; c.g = g; c.b = b;
+    c.param = pattern;
+}
+
+void FrameCommands::blit(const Image& img, int dstX, int dstY)
+{
+    blitSub(img, 0, 0, (int)img.width, (int)img.height, dstX, dstY);
+}
+
+void FrameCommands::blitSub(const Image& img, int srcX, int srcY, int subW, int subH, int dstX, int dstY)
+{
+    if (!img.data || subW <= 0 || subH <= 0) return;
+    Cmd& c = push(Blit, dstX, dstY, dstX + subW, dstY + subH);
+    c.x = dstX; c.y = dstY; c.w = subW; c.h = subH;
+    c.sx = srcX; c.sy = srcY;
+    c.ref = &img;
+}
+
+void FrameCommands::blit(const PixelImage& img, int dstX, int dstY)
+{
+    if (!img.valid()) return;
+    Cmd& c = push(Pixels, dstX, dstY, dstX + img.getWidth(), dstY + img.getHeight());
+    c.x = dstX; c.y = dstY; c.w = img.getWidth(); c.h = img.getHeight();
+    c.sx = 0; c.sy = 0;
+    c.ref = &img;
+}
+
+void FrameCommands::sprite(const SpanSprite& spr, int dstX, int dstY)
+{
+    if (!spr.valid()) return;
+    Cmd& c = push(Sprite, dstX, dstY, dstX + spr.getWidth(), dstY + spr.getHeight());
+    c.x = dstX; c.y = dstY;
+    c.ref = &spr;
+}
+
+void FrameCommands::text(int x, int y, const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    const int len = (int)strlen(s);
+    if (len == 0) return;
+    const int offset = (int)arena.size();
+    arena.insert(arena.end(), s, s + len + 1);
+
+    Cmd& c = push(Text, x, y, x + len * (5 * scale + spacing), y + 7 * scale);
+    c.x = x; c.y = y;
+    c.r = r; c.g = g; c.b = b;
+    c.param = scale; c.param2 = spacing;
+    c.sx = offset;
+}
+
+// Same glyph advance as drawNumber() (5 * scale + 1)
+void FrameCommands::number(int x, int y, int v, unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", v);
+    text(x, y, buf, r, g, b, scale, 1);
+}
+
+void FrameCommands::background(const ScrollingBackground& bg, const DirtyRects* only)
+{
+    Cmd& c = push(Background, 0, 0, 0x7FFFFFFF, 0x7FFFFFFF);
+    c.ref = &bg;
+    c.only = only;
+}
+
+/* Band workers ----------------------------------------------------------------
+ * Workers sleep on `wake` until the generation counter moves, render their
+ * band, and the last one to finish signals `done`. A worker starts from the
+ * current generation, so one spawned after earlier run()s waits for the
+ * next job instead of rendering a stale (null) one.
+ * ---------------------------------------------------------------------------*/
+void BandRasterizer::setThreads(int n)
+{
+    if (n <= 0) n = (int)std::thread::hardware_concurrency();
+    if (n < 1) n = 1;
+    if (n > kMaxThreads) n = kMaxThreads;
+    if (n == threads && (int)workers.size() == n - 1) return;
+
+    stopWorkers();
+    threads = n;
+    quit = false;
+    for (int band = 1; band < n; ++band)
+        workers.emplace_back(&BandRasterizer::workerLoop, this, band, generation);
+}
+
+void BandRasterizer::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m);
+        quit = true;
+    }
+    wake.notify_all();
+    for (std::thread& t : workers) t.join();
+    workers.clear();
+}
+
+void BandRasterizer::workerLoop(int band, unsigned long long seen)
+{
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m);
+            wake.wait(lock, [&] { return quit || generation != seen; });
+            if (quit) return;
+            seen = generation;
+        }
+        rasterBand(band);
+        {
+            std::lock_guard<std::mutex> lock(m);
+            if (--pending == 0) done.notify_one();
+        }
+    }
+}
+
+void BandRasterizer::run(const FrameCommands& cmds, const Surface& dst)
+{
+    target = dst;
+    wide = false;
+    runT(cmds, dst);
+}
+
+void BandRasterizer::run(const FrameCommands& cmds, const Surface32& dst)
+{
+    target32 = dst;
+    wide = true;
+    runT(cmds, dst);
+}
+
+template <class S>
+void BandRasterizer::runT(const FrameCommands& cmds, const S& dst)
+{
+    job = &cmds;
+    if (threads > 1) {
+        {
+            std::lock_guard<std::mutex> lock(m);
+            pending = threads - 1;
+            ++generation;
+        }
+        wake.notify_all();
+    }
+    rasterBand(0);
+    if (threads > 1) {
+        std::unique_lock<std::mutex> lock(m);
+        done.wait(lock, [&] { return pending == 0; });
+    }
+
+    // Bands drew through untracked views; report the whole frame's writes once
+    if (dst.dirty) {
+        for (int i = 0; i < cmds.size(); ++i) {
+            const FrameCommands::Cmd& c = cmds[i];
+            if (c.kind == FrameCommands::Background) {
+                if (!c.only) dst.markDirty(0, 0, dst.width, dst.height);
+            }
+            else dst.markDirty(c.x0, c.y0, c.x1 - c.x0, c.y1 - c.y0);
+        }
+    }
+    job = nullptr;
+}
+
+/* Band rendering --------------------------------------------------------------
+ * Band rows are [y0, y1); commands are replayed into a view of those rows
+ * with their y shifted by -y0, so the primitives' own clipping does the rest.
+ * ---------------------------------------------------------------------------*/
+void BandRasterizer::rasterBand(int band) const
+{
+    if (wide) rasterInto(target32, band);
+    else      rasterInto(target, band);
+}
+
+template <class S>
+void BandRasterizer::rasterInto(const S& dst, int band) const
+{
+    const int rowsPer = ((dst.height + threads - 1) / threads + 1) & ~1;
+    const int y0 = band * rowsPer;
+    int y1 = y0 + rowsPer;
+    if (y1 > dst.height) y1 = dst.height;
+    if (y0 >= y1) return;
+
+    const S view = dst.sub(0, y0, dst.width, y1 - y0);
+    const FrameCommands& list = *job;
+    for (int i = 0; i < list.size(); ++i) {
+        const FrameCommands::Cmd& c = list[i];
+        if (c.y1 <= y0 || c.y0 >= y1) continue;
+        const int y = c.y - y0;
+        switch (c.kind) {
+        case FrameCommands::Fill:
+            ::fillRect(view, c.x, y, c.w, c.h, c.r, c.g, c.b);
+            break;
+        case FrameCommands::Stipple:
+            ::fillRectStipple(view, c.x, y, c.w, c.h, c.r, c.g, c.b, c.param);
+            break;
+        case FrameCommands::Blit:
+            blitSubImage(view, *(const Image*)c.ref, c.sx, c.sy, c.w, c.h, c.x, y);
+            break;
+        case FrameCommands::Pixels:
+            blitSubImage(view, *(const PixelImage*)c.ref, c.sx, c.sy, c.w, c.h, c.x, y);
+            break;
+        case FrameCommands::Sprite:
+            ((const SpanSprite*)c.ref)->draw(view, c.x, y);
+            break;
+        case FrameCommands::Text:
+            drawText5x7(view, c.x, y, list.textOf(c), c.r, c.g, c.b, c.param, c.param2);
+            break;
+        case FrameCommands::Background: {
+            const ScrollingBackground* bg = (const ScrollingBackground*)c.ref;
+            if (c.only) bg->compositeRows(dst, *c.only, y0, y1);
+            else        bg->compositeRows(dst, y0, y1);
+            break;
+        }
+        }
+    }
+}
@@ -0,0 +1,110 @@
+﻿#pragma once
+#include "GamesEngineeringBase.h"
+#include "Surface.h"
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+class SpanSprite;
+class PixelImage;
+class ScrollingBackground;
+
+/*****************************  FrameCommands  *********************************
+ * Recorded draw operations for one frame, in painter's order.
+ *   - Each command keeps its screen-space bounding box so a band can skip it
+ *     without decoding; text is copied into an arena owned by the list.
+ *   - Referenced images, sprites and backgrounds are not copied and must stay
+ *     alive and unchanged until the list has been rasterized.
+ *   - Recording is single-threaded; rasterizing only reads the list.
+ *******************************************************************************/
+class FrameCommands
+{
+public:
+    enum Kind : unsigned char { Fill, Stipple, Blit, Pixels, Sprite, Text, Background };
+
+    struct Cmd
+    {
+        Kind kind;
+        unsigned char r, g, b;
+        int x, y;                   // Destination (top-left) in screen pixels
+        int w, h;                   // Fill/stipple size, blit source size
+        int sx, sy;                 // Blit source origin (text: sx = arena offset)
+        int param;                  // Stipple pattern / text scale
+        int param2;                 // Text spacing
+        const void* ref;            // Image*, PixelImage*, SpanSprite*, ScrollingBackground*
+        const DirtyRects* only;     // Background: restore just these rects
+        int x0, y0, x1, y1;         // Bounding box (unclipped)
+    };
+
+    void clear() { cmds.clear(); arena.clear(); }
+    int  size() const { return (int)cmds.size(); }
+    const Cmd& operator[](int i) const { return cmds[i]; }
+    const char* textOf(const Cmd& c) const { return arena.data() + c.sx; }
+
+    void fillRect(int x, int y, int w, int h, unsigned char r, unsigned char g, unsigned char b);
+    void fillRectStipple(int x, int y, int w, int h, unsigned char r, unsigned char g, unsigned char b, int pattern);
+    void blit(const GamesEngineeringBase::Image& img, int dstX, int dstY);
+    void blitSub(const GamesEngineeringBase::Image& img, int srcX, int srcY, int subW, int subH, int dstX, int dstY);
+    void blit(const PixelImage& img, int dstX, int dstY);
+    void sprite(const SpanSprite& spr, int dstX, int dstY);
+    void text(int x, int y, const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing = 1);
+    void number(int x, int y, int v, unsigned char r, unsigned char g, unsigned char b, int scale);
+
+    // Copies the scrolling background in; with `only`, restores just those rects
+    void background(const ScrollingBackground& bg, const DirtyRects* only = nullptr);
+
+private:
+    std::vector<Cmd> cmds;
+    std::vector<char> arena;
+
+    Cmd& push(Kind k, int x0, int y0, int x1, int y1);
+};
+
+/*****************************  BandRasterizer  ********************************
+ * Plays a FrameCommands list into a surface with N threads.
+ *   - The screen is split into N horizontal bands (even row counts, so the
+ *     stipple pattern stays aligned); the calling thread renders band 0 and
+ *     persistent workers render the rest. Each band draws through a view of
+ *     its own rows, so every primitive clips to the band and no two threads
+ *     ever write the same pixel: no locks on the back buffer.
+ *   - run() returns after all bands finish, then records the command bounds
+ *     on dst's dirty tracker (band views are untracked).
+ *******************************************************************************/
+class BandRasterizer
+{
+public:
+    explicit BandRasterizer(int threads = 1) { setThreads(threads); }
+    ~BandRasterizer() { stopWorkers(); }
+    BandRasterizer(const BandRasterizer&) = delete;
+    BandRasterizer& operator=(const BandRasterizer&) = delete;
+
+    // 0 = one per hardware thread (clamped to kMaxThreads)
+    void setThreads(int n);
+    int  getThreads() const { return threads; }
+
+    void run(const FrameCommands& cmds, const Surface& dst);
+    void run(const FrameCommands& cmds, const Surface32& dst);   // RGBX8888 frame
+
+    static const int kMaxThreads = 16;
+
+private:
+    int threads = 1;
+    std::vector<std::thread> workers;
+    std::mutex m;
+    std::condition_variable wake, done;
+    unsigned long long generation = 0;
+    int pending = 0;
+    bool quit = false;
+
+    const FrameCommands* job = nullptr;
+    Surface target;
+    Surface32 target32;
+    bool wide = false;                 // Rendering into target32
+
+    void stopWorkers();
+    void workerLoop(int band, unsigned long long seen);
+    void rasterBand(int band) const;
+    template <class S> void runT(const FrameCommands& cmds, const S& dst);
+    template <class S> void rasterInto(const S& dst, int band) const;
+};
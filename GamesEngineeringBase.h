@@ -24,6 +24,11 @@ SOFTWARE.
 
 #pragma once
 
+#if !defined(_WIN32)
+// Headless build (Linux, CI): Image plus a window-less stand-in
+#include "HeadlessBase.h"
+#else
+
 // Include necessary Windows and DirectX headers
 #include <Windows.h>
 #include <string>
@@ -46,6 +51,9 @@ SOFTWARE.
 // Stop warnings about possible NULL values for buffer and backbuffer. This should work on any modern hardware.
 #pragma warning( disable : 6387)
 
+// Image lives in its own header so pixel-only code builds without Windows
+#include "Image.h"
+
 // Define the namespace to encapsulate the library's classes
 namespace GamesEngineeringBase
 {
@@ -75,7 +83,7 @@ namespace GamesEngineeringBase
 		IDXGISwapChain* sc;                      // Swap chain for double buffering
 		ID3D11RenderTargetView* rtv;             // Render target view
 		D3D11_VIEWPORT vp;                       // Viewport configuration
-		ID3D11Buffer* buffer;                    // Buffer for pixel data
+		ID3D11Texture2D* buffer;                 // Pixel data: (width * 3) x height R8 texels
 		ID3D11ShaderResourceView* srv;           // Shader resource view
 		ID3D11PixelShader* ps;                   // Pixel shader
 		ID3D11VertexShader* vs;                  // Vertex shader
@@ -350,21 +358,25 @@ namespace GamesEngineeringBase
 			unsigned int dataSize = width * height * 3;
 			paddedDataSize = ((dataSize + 3) / 4) * 4;
 
-			// Create buffer to hold the back buffer image
-			D3D11_BUFFER_DESC bufferDesc = {};
-			bufferDesc.Usage = D3D11_USAGE_DEFAULT;
-			bufferDesc.ByteWidth = paddedDataSize * sizeof(unsigned char);
-			bufferDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-			bufferDesc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_ALLOW_RAW_VIEWS;
-			dev->CreateBuffer(&bufferDesc, nullptr, &buffer);
+			// Create a texture to hold the back buffer image. One R8 texel per
+			// byte keeps the RGB24 layout, and being 2-D lets present() upload
+			// a rectangle with one call.
+			D3D11_TEXTURE2D_DESC texDesc = {};
+			texDesc.Width = width * 3;
+			texDesc.Height = height;
+			texDesc.MipLevels = 1;
+			texDesc.ArraySize = 1;
+			texDesc.Format = DXGI_FORMAT_R8_UINT;
+			texDesc.SampleDesc.Count = 1;
+			texDesc.Usage = D3D11_USAGE_DEFAULT;
+			texDesc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+			dev->CreateTexture2D(&texDesc, nullptr, &buffer);
 
 			//Create shader resource view
 			D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
-			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFEREX;
-			srvDesc.BufferEx.FirstElement = 0;
-			srvDesc.BufferEx.NumElements = paddedDataSize / 4;
-			srvDesc.BufferEx.Flags = D3D11_BUFFEREX_SRV_FLAG_RAW;
-			srvDesc.Format = DXGI_FORMAT_R32_TYPELESS;
+			srvDesc.ViewDimension = D3D11_SRV_DIMENSION_TEXTURE2D;
+			srvDesc.Texture2D.MipLevels = 1;
+			srvDesc.Format = DXGI_FORMAT_R8_UINT;
 			dev->CreateShaderResourceView(buffer, &srvDesc, &srv);
 
 			// Set the default states
@@ -387,36 +399,21 @@ namespace GamesEngineeringBase
                 return output;\
             }";
 
-			// Width is fixed so we can write it into the shader code at compile time
-			std::string pixelShader = "ByteAddressBuffer buf : register(t0);\
+			// Each pixel is three consecutive R8 texels of its row
+			std::string pixelShader = "Texture2D<uint> buf : register(t0);\
             struct VSOut\
             {\
                 float4 pos : SV_Position;\
             };\
             float4 PS(VSOut psInput) : SV_Target0\
             {\
-				uint pixelIndex = (int(psInput.pos.y) * WIDTH) + int(psInput.pos.x); \
-				uint offset = pixelIndex * 3;\
-				uint inner = offset & 3;\
-				uint baseAddress = offset & ~3;\
-				uint data = 1;\
-				if (inner == 0)\
-				{\
-					data = buf.Load(baseAddress) & 0xFFFFFF;\
-				} else\
-				{\
-					data = ((buf.Load(baseAddress) >> (inner * 8)) | (buf.Load(baseAddress + 4) << ((4 - inner) * 8))) & 0xFFFFFF;\
-				}\
-				float r = (data & 0xFF) / 255.0;\
-				float g = ((data >> 8) & 0xFF) / 255.0; \
-				float b = ((data >> 16) & 0xFF) / 255.0; \
+				int x = int(psInput.pos.x) * 3;\
+				int y = int(psInput.pos.y);\
+				float r = buf.Load(int3(x, y, 0)) / 255.0;\
+				float g = buf.Load(int3(x + 1, y, 0)) / 255.0; \
+				float b = buf.Load(int3(x + 2, y, 0)) / 255.0; \
                 return float4(r, g, b, 1.0f);\
             }";
-			unsigned int startPos = 0;
-			std::string widthStr = std::to_string(width);
-			std::string widthConst = "WIDTH";
-			startPos = static_cast<unsigned int>(pixelShader.find(widthConst, startPos));
-			pixelShader.replace(startPos, widthConst.length(), widthStr);
 
 			// Compile the shaders
 			ID3DBlob* vshader;
@@ -520,7 +517,7 @@ namespace GamesEngineeringBase
 		void present()
 		{
 			// Update the texture data
-			devcontext->UpdateSubresource(buffer, 0, nullptr, image, paddedDataSize, 0);
+			devcontext->UpdateSubresource(buffer, 0, nullptr, image, width * 3, 0);
 
 			// Clear the render target view
 			float ClearColor[4] = { 0.0f, 0.0f, 1.0f, 1.0f }; // RGBA
@@ -536,6 +533,27 @@ namespace GamesEngineeringBase
 			pumpLoop();
 		}
 
+		// Presents the back buffer, uploading only the listed rectangles.
+		// rects holds rectCount x0, y0, x1, y1 quads in pixels (half-open,
+		// inside the window); the texture keeps its previous contents
+		// everywhere else. One upload call per rectangle.
+		void present(const int* rects, int rectCount)
+		{
+			const unsigned int pitch = width * 3;
+			for (int i = 0; i < rectCount; ++i)
+			{
+				const int* q = rects + 4 * i;
+				D3D11_BOX box = { (UINT)q[0] * 3, (UINT)q[1], 0, (UINT)q[2] * 3, (UINT)q[3], 1 };
+				devcontext->UpdateSubresource(buffer, 0, &box, image + q[1] * pitch + q[0] * 3, pitch, 0);
+			}
+
+			float ClearColor[4] = { 0.0f, 0.0f, 1.0f, 1.0f }; // RGBA
+			devcontext->ClearRenderTargetView(rtv, ClearColor);
+			devcontext->Draw(3, 0);
+			sc->Present(0, 0);
+			pumpLoop();
+		}
+
 		// Returns the window's width
 		unsigned int getWidth() const
 		{
@@ -926,177 +944,6 @@ namespace GamesEngineeringBase
 		}
 	};
 
-	// The Image class handles loading and manipulating images
-	// This class is a bit of an exception in that the members are public. The reason for this is users may want to create procedural images.
-	class Image
-	{
-	public:
-		unsigned int width;       // Image width
-		unsigned int height;      // Image height
-		unsigned int channels;    // Number of color channels
-		unsigned char* data;      // Pointer to image data
-
-		// Default constructor
-		Image()
-		{
-			width = 0;
-			height = 0;
-			channels = 0;
-			data = nullptr;
-		}
-		Image(const Image&) = delete; // No copy constructor
-		Image& operator=(const Image&) = delete;
-		Image(Image&&) noexcept = default;  // Default move
-		Image& operator=(Image&&) noexcept = default;
-
-		// Loads an image from a file using WIC
-		bool load(std::string filename)
-		{
-			Microsoft::WRL::ComPtr<IWICImagingFactory> factory;
-			HRESULT hr = ::CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
-			if (FAILED(hr))
-			{
-				return false;
-			}
-
-			Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
-			IWICStream* stream = NULL;
-			factory->CreateStream(&stream);
-
-			std::wstring wFilename = std::wstring(filename.begin(), filename.end());
-			stream->InitializeFromFilename(wFilename.c_str(), GENERIC_READ);
-			factory->CreateDecoderFromStream(stream, 0, WICDecodeMetadataCacheOnDemand, &decoder);
-
-			Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
-			decoder->GetFrame(0, &frame);
-
-			frame->GetSize(&width, &height);
-			WICPixelFormatGUID pixelFormat = { 0 };
-			frame->GetPixelFormat(&pixelFormat);
-
-			channels = 0;
-			int isRGB = 0;
-			// Determine the number of channels based on the pixel format
-			if (pixelFormat == GUID_WICPixelFormat24bppBGR)
-			{
-				channels = 3;
-			}
-			if (pixelFormat == GUID_WICPixelFormat32bppBGRA)
-			{
-				channels = 4;
-			}
-			if (pixelFormat == GUID_WICPixelFormat24bppRGB)
-			{
-				channels = 3;
-				isRGB = 1;
-			}
-			if (pixelFormat == GUID_WICPixelFormat32bppRGBA)
-			{
-				channels = 4;
-				isRGB = 1;
-			}
-			if (channels == 0)
-			{
-				return false;
-			}
-
-			data = new unsigned char[width * height * channels];
-			unsigned int stride = (width * channels + 3) & ~3; // Align stride to 4 bytes
-
-			if (stride == (width * channels))
-			{
-				// Copy pixels directly if stride matches
-				frame->CopyPixels(0, stride, width * height * channels, data);
-			} else
-			{
-				// Handle images with padded stride
-				unsigned char* strideData = new unsigned char[stride * height];
-				frame->CopyPixels(0, stride, width * height * channels, strideData);
-				for (unsigned int i = 0; i < height; i++)
-				{
-					memcpy(&data[i * width * channels], &strideData[i * stride], width * channels * sizeof(unsigned char));
-				}
-				delete[] strideData;
-			}
-
-			if (isRGB == 0)
-			{
-				// Swap red and blue channels for BGR formats
-				for (unsigned int i = 0; i < width * height; i++)
-				{
-					unsigned char p = data[i * channels];
-					data[i * channels] = data[(i * channels) + 2];
-					data[(i * channels) + 2] = p;
-				}
-			}
-			return true;
-		}
-
-		// Returns a pointer to the pixel data at (x, y)
-		// Note, the bounds are handled via clamping
-		unsigned char* at(const unsigned int x, const unsigned int y) const
-		{
-			return &data[((min(y, height - 1) * width) + min(x, width  - 1)) * channels];
-		}
-
-		// Returns the alpha value of the pixel at (x, y)
-		// Note, the bounds are handled via clamping
-		unsigned char alphaAt(const unsigned int x, const unsigned int y) const
-		{
-			if (channels == 4)
-			{
-				return data[((min(y, height - 1) * width) + min(x, width - 1)) * channels + 3];
-			}
-			return 255;
-		}
-
-		// Returns a the colour specified by index at (x, y)
-		// Note, the image bounds are handled via clamping, but the index is not checked
-		unsigned char at(const unsigned int x, const unsigned int y, const unsigned int index) const
-		{
-			return data[(((min(y, height - 1) * width) + min(x, width - 1)) * channels) + index];
-		}
-
-		// Returns a pointer to the pixel data at (x, y)
-		// Note, no checks performed on x and y coordinates
-		unsigned char* atUnchecked(const unsigned int x, const unsigned int y) const
-		{
-			return &data[((y * width) + x) * channels];
-		}
-
-		// Returns the alpha value of the pixel at (x, y)
-		// Note, no checks performed on x and y coordinates
-		unsigned char alphaAtUnchecked(const unsigned int x, const unsigned int y) const
-		{
-			if (channels == 4)
-			{
-				return data[(((y * width) + x) * channels) + 3];
-			}
-			return 255;
-		}
-
-		// Checks if the image has an alpha channel
-		bool hasAlpha() const
-		{
-			return channels == 4;
-		}
-
-		// Frees the allocated image data
-		void free()
-		{
-			if (data != NULL)
-			{
-				delete[] data;
-				data = NULL;
-			}
-		}
-
-		// Destructor to free resources
-		~Image()
-		{
-			free();
-		}
-	};
 
 	// The XBoxController class represents a single Xbox controller
 	class XBoxController
@@ -1273,4 +1120,6 @@ namespace GamesEngineeringBase
 		}
 	};
 
-}
\ No newline at end of file
+}
+
+#endif // _WIN32
@@ -0,0 +1,117 @@
+﻿#include "GlyphCache.h"
+#include "gfx_utils.h"
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+GlyphCache& glyphCache()
+{
+    static GlyphCache cache;
+    return cache;
+}
+
+/* Rendering -------------------------------------------------------------------
+ * Same placement as the original per-pixel loop: glyph i starts at
+ * i * (5 * scale + spacing), each lit bit becomes a scale x scale block.
+ * Cached sprites are rasterized into a transparent image, so the encoded
+ * spans cover lit pixels only.
+ * ---------------------------------------------------------------------------*/
+int GlyphCache::rasterize(const char* s, int n, int scale, int spacing,
+    unsigned char r, unsigned char g, unsigned char b,
+    unsigned char* rgba, int w, int h, int x, int y)
+{
+    const int adv = 5 * scale + spacing;
+    for (int i = 0; i < n; ++i) {
+        const Glyph5x7* gph = getGlyph5x7(s[i]);
+        if (!gph) continue;
+        const int gx = x + i * adv;
+        for (int ry = 0; ry < 7; ++ry)
+            for (int rx = 0; rx < 5; ++rx) {
+                if (!(gph->row[ry] & (1 << (4 - rx)))) continue;
+                for (int yy = 0; yy < scale; ++yy) {
+                    const int py = y + ry * scale + yy;
+                    if ((unsigned)py >= (unsigned)h) continue;
+                    for (int xx = 0; xx < scale; ++xx) {
+                        const int px = gx + rx * scale + xx;
+                        if ((unsigned)px >= (unsigned)w) continue;
+                        unsigned char* p = rgba + ((size_t)py * w + px) * 4;
+                        p[0] = r; p[1] = g; p[2] = b; p[3] = 255;
+                    }
+                }
+            }
+    }
+    return n * adv;
+}
+
+bool GlyphCache::render(const char* s, int n, int scale, int spacing,
+    unsigned char r, unsigned char g, unsigned char b, SpanSprite& out)
+{
+    if (n <= 0 || scale < 1) return false;
+    const int w = (n - 1) * (5 * scale + spacing) + 5 * scale, h = 7 * scale;
+    if (w <= 0) return false;
+
+    Image img;
+    img.width = (unsigned int)w; img.height = (unsigned int)h; img.channels = 4;
+    img.data = new unsigned char[(size_t)w * h * 4];
+    memset(img.data, 0, (size_t)w * h * 4);
+    rasterize(s, n, scale, spacing, r, g, b, img.data, w, h, 0, 0);
+
+    bool lit = false;
+    for (size_t i = 3; i < (size_t)w * h * 4 && !lit; i += 4) lit = img.data[i] != 0;
+    return lit && out.encode(img);
+}
+
+/* Lookup ----------------------------------------------------------------------*/
+const SpanSprite* GlyphCache::glyphLocked(char c, int scale, unsigned char r, unsigned char g, unsigned char b)
+{
+    if (scale < 1 || scale > 255) return nullptr;
+    const unsigned long long key = (unsigned long long)(unsigned char)c
+        | ((unsigned long long)scale << 8)
+        | ((unsigned long long)r << 16) | ((unsigned long long)g << 24) | ((unsigned long long)b << 32);
+
+    auto it = glyphMap.find(key);
+    if (it == glyphMap.end()) {
+        SpanSprite spr;
+        if (!render(&c, 1, scale, 0, r, g, b, spr)) spr = SpanSprite();
+        it = glyphMap.emplace(key, std::move(spr)).first;   // blanks cached too
+    }
+    return it->second.valid() ? &it->second : nullptr;
+}
+
+const SpanSprite* GlyphCache::glyph(char c, int scale, unsigned char r, unsigned char g, unsigned char b)
+{
+    std::lock_guard<std::mutex> lock(m);
+    return glyphLocked(c, scale, r, g, b);
+}
+
+void GlyphCache::glyphs(const char* s, int n, int scale, unsigned char r, unsigned char g, unsigned char b,
+    const SpanSprite** out)
+{
+    std::lock_guard<std::mutex> lock(m);
+    for (int i = 0; i < n; ++i) out[i] = glyphLocked(s[i], scale, r, g, b);
+}
+
+const SpanSprite* GlyphCache::run(const char* s, int scale, int spacing, unsigned char r, unsigned char g, unsigned char b)
+{
+    if (!s || !s[0] || scale < 1 || scale > 255) return nullptr;
+    std::string key(s);
+    key.push_back('\0');
+    const unsigned char style[6] = { (unsigned char)scale, (unsigned char)(spacing & 0xFF),
+        (unsigned char)((spacing >> 8) & 0xFF), r, g, b };
+    key.append((const char*)style, sizeof(style));
+
+    std::lock_guard<std::mutex> lock(m);
+    auto it = runs.find(key);
+    if (it == runs.end()) {
+        SpanSprite spr;
+        if (!render(s, (int)strlen(s), scale, spacing, r, g, b, spr)) spr = SpanSprite();
+        it = runs.emplace(std::move(key), std::move(spr)).first;
+    }
+    return it->second.valid() ? &it->second : nullptr;
+}
+
+void GlyphCache::clear()
+{
+    std::lock_guard<std::mutex> lock(m);
+    glyphMap.clear();
+    runs.clear();
+}
@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "SpanSprite.h"
+#include <string>
+#include <unordered_map>
+#include <mutex>
+
+/*******************************  GlyphCache  **********************************
+ * Pre-rendered 5x7 text, stored as SpanSprites so drawing is a few clipped
+ * span copies instead of one bounds-checked putPix per scaled sub-pixel.
+ *   - glyph(c, scale, rgb): one character, keyed by (char, scale, color).
+ *   - run(s, ...): a whole static string (HUD labels) in a single sprite;
+ *     keyed by the string and its style, so only use it for text that does
+ *     not change from frame to frame.
+ * Entries are built on first use and live until clear(); their addresses
+ * stay valid until then. Lookups lock a mutex so the banded renderer's
+ * workers can share the process-wide cache; glyphs() resolves a whole
+ * string under one lock, so text pays one lock per run, not per character.
+ * rasterize() is the one 5x7 rasterizer; the cache and HudLayer both use it.
+ *******************************************************************************/
+class GlyphCache
+{
+public:
+    // nullptr for characters without lit pixels (space, unknown) or scale < 1
+    const SpanSprite* glyph(char c, int scale, unsigned char r, unsigned char g, unsigned char b);
+    // glyph() for s[0 .. n) into out[0 .. n), under a single lock
+    void glyphs(const char* s, int n, int scale, unsigned char r, unsigned char g, unsigned char b,
+        const SpanSprite** out);
+    const SpanSprite* run(const char* s, int scale, int spacing, unsigned char r, unsigned char g, unsigned char b);
+
+    void clear();
+    int  glyphCount() const { return (int)glyphMap.size(); }
+    int  runCount()   const { return (int)runs.size(); }
+
+    // Writes the lit pixels of s[0 .. n) as (r, g, b, 255) into a w x h RGBA
+    // buffer, first glyph's top-left at (x, y), clipped per pixel; other
+    // pixels are left as they are. Glyph i starts at i * (5 * scale + spacing).
+    // Returns that advance times n.
+    static int rasterize(const char* s, int n, int scale, int spacing,
+        unsigned char r, unsigned char g, unsigned char b,
+        unsigned char* rgba, int w, int h, int x, int y);
+
+private:
+    std::mutex m;
+    std::unordered_map<unsigned long long, SpanSprite> glyphMap;
+    std::unordered_map<std::string, SpanSprite> runs;
+
+    const SpanSprite* glyphLocked(char c, int scale, unsigned char r, unsigned char g, unsigned char b);
+
+    // Renders n characters at the 5x7 advance into `out`; false if nothing is lit
+    static bool render(const char* s, int n, int scale, int spacing,
+        unsigned char r, unsigned char g, unsigned char b, SpanSprite& out);
+};
+
+// Shared by drawChar5x7 / drawText5x7 / drawLabel5x7
+GlyphCache& glyphCache();
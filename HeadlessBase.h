@@ -0,0 +1,112 @@
+﻿#pragma once
+#include "Image.h"
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <math.h>
+#include <string>
+#include <thread>
+
+/*******************************  HeadlessBase  ********************************
+ * What GamesEngineeringBase.h provides when _WIN32 is not defined: the
+ * portable Image (Image.h) plus a Window that renders into its back buffer
+ * and never shows it, a steady_clock Timer, the few Win32 names the game
+ * uses and the same standard headers. Enough to run the offline tools
+ * (--pack-assets, --compile-map) and every --bench on Linux; there is no
+ * sound or controller support.
+ *
+ * Build from the repository root:
+ *   g++ -std=c++20 -O2 -pthread *.cpp -o game
+ *   ./game --bench [names]    (all when none; or --pack-assets, --compile-map)
+ * Add -fsanitize=address,undefined -g for a checked build.
+ *******************************************************************************/
+#define VK_RETURN 0x0D
+#define VK_ESCAPE 0x1B
+#define VK_F5     0x74
+#define VK_F9     0x78
+
+inline void Sleep(unsigned int ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+
+namespace GamesEngineeringBase
+{
+    enum MouseButton
+    {
+        MouseLeft = 0,
+        MouseMiddle = 1,
+        MouseRight = 2
+    };
+
+    // Same interface as the D3D Window; no input ever arrives
+    class Window
+    {
+    public:
+        Window() = default;
+        Window(const Window&) = delete;
+        Window& operator=(const Window&) = delete;
+        ~Window() { delete[] image; }
+
+        void create(unsigned int window_width, unsigned int window_height, const std::string window_name,
+            bool window_fullscreen = false, int window_x = 0, int window_y = 0)
+        {
+            (void)window_name; (void)window_fullscreen; (void)window_x; (void)window_y;
+            delete[] image;
+            width = window_width;
+            height = window_height;
+            image = new unsigned char[(size_t)width * height * 3]();
+        }
+
+        void checkInput() {}
+        unsigned char* backBuffer() const { return image; }
+
+        void draw(int x, int y, unsigned char r, unsigned char g, unsigned char b)
+        {
+            draw((y * (int)width) + x, r, g, b);
+        }
+        void draw(int pixelIndex, unsigned char r, unsigned char g, unsigned char b)
+        {
+            unsigned char* p = image + (size_t)pixelIndex * 3;
+            p[0] = r; p[1] = g; p[2] = b;
+        }
+        void draw(int x, int y, unsigned char* pixel) { draw(x, y, pixel[0], pixel[1], pixel[2]); }
+
+        void clear() { memset(image, 0, (size_t)width * height * 3); }
+        void present() {}
+        void present(const int* rects, int rectCount) { (void)rects; (void)rectCount; }
+
+        unsigned int getWidth() const { return width; }
+        unsigned int getHeight() const { return height; }
+        unsigned char* getBackBuffer() const { return image; }
+
+        bool keyPressed(int key) const { (void)key; return false; }
+        bool mouseButtonPressed(MouseButton button) const { (void)button; return false; }
+        int getMouseX() const { return 0; }
+        int getMouseY() const { return 0; }
+        int getMouseWheel() const { return 0; }
+        int getMouseInWindowX() const { return 0; }
+        int getMouseInWindowY() const { return 0; }
+        void clipMouseToWindow() const {}
+
+    private:
+        unsigned char* image = nullptr;
+        unsigned int width = 0, height = 0;
+    };
+
+    class Timer
+    {
+    public:
+        Timer() { reset(); }
+        void reset() { start = std::chrono::steady_clock::now(); }
+
+        // Seconds since the last reset()/dt(), then resets
+        float dt()
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const float value = std::chrono::duration<float>(now - start).count();
+            start = now;
+            return value;
+        }
+
+    private:
+        std::chrono::steady_clock::time_point start;
+    };
+}
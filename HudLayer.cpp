@@ -0,0 +1,101 @@
+﻿#include "HudLayer.h"
+#include "gfx_utils.h"
+#include "GlyphCache.h"
+#include "blit.h"
+#include "blit32.h"
+#include "FrameCommands.h"
+#include <cstdio>
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+void HudLayer::create(int x, int y, int w, int h, Base b,
+    unsigned char r, unsigned char g, unsigned char bl, int pat)
+{
+    ox = x; oy = y;
+    base = b; baseR = r; baseG = g; baseB = bl; pattern = pat;
+    fields.clear();
+    redraws = 0;
+
+    layer.free();
+    layer.width = (unsigned int)(w > 0 ? w : 0);
+    layer.height = (unsigned int)(h > 0 ? h : 0);
+    layer.channels = 4;
+    if (w <= 0 || h <= 0) return;
+    layer.data = new unsigned char[(size_t)w * h * 4];
+    paintBase(0, 0, w, h);
+}
+
+/* Layer painting --------------------------------------------------------------
+ * Same pixels fillRectStipple()/fillRect() and drawText5x7() would put on
+ * screen at (ox + x, oy + y); everything else gets alpha 0.
+ * ---------------------------------------------------------------------------*/
+void HudLayer::paintBase(int x0, int y0, int x1, int y1)
+{
+    const int W = (int)layer.width, H = (int)layer.height;
+    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
+    if (x1 > W) x1 = W; if (y1 > H) y1 = H;
+    for (int y = y0; y < y1; ++y) {
+        unsigned char* p = layer.data + ((size_t)y * W + x0) * 4;
+        const int sy = oy + y;
+        for (int x = x0; x < x1; ++x, p += 4) {
+            const int sx = ox + x;
+            bool paint = true;
+            if (base == Stipple)
+                paint = (pattern == 0) ? (((sx ^ sy) & 1) == 0) : (((sx & 1) == 0) && ((sy & 1) == 0));
+            p[0] = baseR; p[1] = baseG; p[2] = baseB; p[3] = paint ? 255 : 0;
+        }
+    }
+}
+
+int HudLayer::stamp(int x, int y, const char* s,
+    unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    return GlyphCache::rasterize(s, (int)strlen(s), scale, spacing, r, g, b,
+        layer.data, (int)layer.width, (int)layer.height, x, y);
+}
+
+/* Widgets ---------------------------------------------------------------------*/
+void HudLayer::addLabel(int x, int y, const char* s,
+    unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    if (layer.data && s) stamp(x, y, s, r, g, b, scale, spacing);
+}
+
+int HudLayer::addNumber(int x, int y, unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    Field f = { x, y, scale, r, g, b, 0, false, 0 };
+    fields.push_back(f);
+    return (int)fields.size() - 1;
+}
+
+// Same text and advance as drawNumber() (5 * scale + 1 per digit)
+void HudLayer::setValue(int field, int v)
+{
+    if (!layer.data || field < 0 || field >= (int)fields.size()) return;
+    Field& f = fields[field];
+    if (f.valid && f.value == v) return;
+
+    paintBase(f.x, f.y, f.x + f.drawnW, f.y + 7 * f.scale);
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d", v);
+    f.drawnW = stamp(f.x, f.y, buf, f.r, f.g, f.b, f.scale, 1);
+    f.value = v;
+    f.valid = true;
+    ++redraws;
+}
+
+/* Compositing -----------------------------------------------------------------*/
+void HudLayer::draw(const Surface& dst) const
+{
+    if (layer.data) blitImage(dst, layer, ox, oy);
+}
+
+void HudLayer::draw(const Surface32& dst) const
+{
+    if (layer.data) blitImage(dst, layer, ox, oy);
+}
+
+void HudLayer::record(FrameCommands& out) const
+{
+    if (layer.data) out.blit(layer, ox, oy);
+}
@@ -0,0 +1,60 @@
+﻿#pragma once
+#include "GamesEngineeringBase.h"
+#include "Surface.h"
+#include <vector>
+
+class FrameCommands;
+
+/********************************  HudLayer  ***********************************
+ * Retained HUD panel: the panel background and its labels are rendered once
+ * into an RGBA image; number fields re-render only their own region, and only
+ * when setValue() sees a new value. Compositing is a single alpha-tested blit
+ * (stipple holes and unlit pixels are transparent), so a frame whose values
+ * did not change costs one blitImage() and no text drawing at all.
+ *
+ * Coordinates passed to addLabel/addNumber are local to the panel. Fields
+ * must not overlap labels: a field restores plain panel background over the
+ * box it drew last time before drawing the new value.
+ *******************************************************************************/
+class HudLayer
+{
+public:
+    enum Base { Stipple, Solid };
+
+    // (x, y) is the screen position; the stipple phase follows screen
+    // coordinates so the panel lines up with fillRectStipple()
+    void create(int x, int y, int w, int h, Base base,
+        unsigned char r, unsigned char g, unsigned char b, int pattern = 0);
+
+    void addLabel(int x, int y, const char* s,
+        unsigned char r, unsigned char g, unsigned char b, int scale, int spacing = 1);
+
+    // Returns the field id for setValue(); the field starts empty
+    int  addNumber(int x, int y, unsigned char r, unsigned char g, unsigned char b, int scale);
+    void setValue(int field, int v);
+
+    void draw(const Surface& dst) const;
+    void draw(const Surface32& dst) const;
+    void record(FrameCommands& out) const;
+
+    const GamesEngineeringBase::Image& image() const { return layer; }
+    int  getX() const { return ox; }
+    int  getY() const { return oy; }
+    int  fieldRedraws() const { return redraws; }   // Field re-renders since create()
+
+private:
+    struct Field { int x, y, scale; unsigned char r, g, b; int value; bool valid; int drawnW; };
+
+    GamesEngineeringBase::Image layer;   // RGBA, alpha 0 = show what is underneath
+    int ox = 0, oy = 0;
+    Base base = Solid;
+    unsigned char baseR = 0, baseG = 0, baseB = 0;
+    int pattern = 0;
+    std::vector<Field> fields;
+    int redraws = 0;
+
+    void paintBase(int x0, int y0, int x1, int y1);
+    // Text goes through GlyphCache::rasterize, the renderer behind drawText5x7
+    int  stamp(int x, int y, const char* s,
+        unsigned char r, unsigned char g, unsigned char b, int scale, int spacing);
+};
@@ -0,0 +1,213 @@
+﻿#pragma once
+#include "PngDecoder.h"
+#include <cstring>
+#include <string>
+#if defined(_WIN32)
+#include <Windows.h>
+#include <wincodec.h>
+#include <wrl/client.h>
+#pragma comment(lib, "WindowsCodecs.lib")
+#endif
+
+/***********************************  Image  ***********************************
+ * GamesEngineeringBase::Image, moved out of GamesEngineeringBase.h (which
+ * includes it) so code that only handles pixels builds without Windows or
+ * D3D. load() decodes PNGs with decodePNGFile (PngDecoder.h); other formats
+ * go through WIC on Windows and fail elsewhere.
+ *******************************************************************************/
+namespace GamesEngineeringBase
+{
+	// The Image class handles loading and manipulating images
+	// This class is a bit of an exception in that the members are public. The reason for this is users may want to create procedural images.
+	class Image
+	{
+	public:
+		unsigned int width;       // Image width
+		unsigned int height;      // Image height
+		unsigned int channels;    // Number of color channels
+		unsigned char* data;      // Pointer to image data
+
+		// Default constructor
+		Image()
+		{
+			width = 0;
+			height = 0;
+			channels = 0;
+			data = nullptr;
+		}
+		Image(const Image&) = delete; // No copy constructor
+		Image& operator=(const Image&) = delete;
+		Image(Image&&) noexcept = default;  // Default move
+		Image& operator=(Image&&) noexcept = default;
+
+		// Loads an image from a file: PNGs through decodePNGFile, anything else using WIC
+		bool load(std::string filename)
+		{
+			unsigned int pngW, pngH, pngC;
+			unsigned char* pngData;
+			if (decodePNGFile(filename, pngW, pngH, pngC, pngData))
+			{
+				free();
+				width = pngW;
+				height = pngH;
+				channels = pngC;
+				data = pngData;
+				return true;
+			}
+
+#if defined(_WIN32)
+			Microsoft::WRL::ComPtr<IWICImagingFactory> factory;
+			HRESULT hr = ::CoCreateInstance(CLSID_WICImagingFactory, NULL, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&factory));
+			if (FAILED(hr))
+			{
+				return false;
+			}
+
+			Microsoft::WRL::ComPtr<IWICBitmapDecoder> decoder;
+			IWICStream* stream = NULL;
+			factory->CreateStream(&stream);
+
+			std::wstring wFilename = std::wstring(filename.begin(), filename.end());
+			stream->InitializeFromFilename(wFilename.c_str(), GENERIC_READ);
+			factory->CreateDecoderFromStream(stream, 0, WICDecodeMetadataCacheOnDemand, &decoder);
+
+			Microsoft::WRL::ComPtr<IWICBitmapFrameDecode> frame;
+			decoder->GetFrame(0, &frame);
+
+			frame->GetSize(&width, &height);
+			WICPixelFormatGUID pixelFormat = { 0 };
+			frame->GetPixelFormat(&pixelFormat);
+
+			channels = 0;
+			int isRGB = 0;
+			// Determine the number of channels based on the pixel format
+			if (pixelFormat == GUID_WICPixelFormat24bppBGR)
+			{
+				channels = 3;
+			}
+			if (pixelFormat == GUID_WICPixelFormat32bppBGRA)
+			{
+				channels = 4;
+			}
+			if (pixelFormat == GUID_WICPixelFormat24bppRGB)
+			{
+				channels = 3;
+				isRGB = 1;
+			}
+			if (pixelFormat == GUID_WICPixelFormat32bppRGBA)
+			{
+				channels = 4;
+				isRGB = 1;
+			}
+			if (channels == 0)
+			{
+				return false;
+			}
+
+			data = new unsigned char[width * height * channels];
+			unsigned int stride = (width * channels + 3) & ~3; // Align stride to 4 bytes
+
+			if (stride == (width * channels))
+			{
+				// Copy pixels directly if stride matches
+				frame->CopyPixels(0, stride, width * height * channels, data);
+			} else
+			{
+				// Handle images with padded stride
+				unsigned char* strideData = new unsigned char[stride * height];
+				frame->CopyPixels(0, stride, width * height * channels, strideData);
+				for (unsigned int i = 0; i < height; i++)
+				{
+					memcpy(&data[i * width * channels], &strideData[i * stride], width * channels * sizeof(unsigned char));
+				}
+				delete[] strideData;
+			}
+
+			if (isRGB == 0)
+			{
+				// Swap red and blue channels for BGR formats
+				for (unsigned int i = 0; i < width * height; i++)
+				{
+					unsigned char p = data[i * channels];
+					data[i * channels] = data[(i * channels) + 2];
+					data[(i * channels) + 2] = p;
+				}
+			}
+			return true;
+#else
+			return false;   // headless builds only decode PNGs
+#endif
+		}
+
+		// Returns a pointer to the pixel data at (x, y)
+		// Note, the bounds are handled via clamping
+		unsigned char* at(const unsigned int x, const unsigned int y) const
+		{
+			return &data[((clampIndex(y, height) * width) + clampIndex(x, width)) * channels];
+		}
+
+		// Returns the alpha value of the pixel at (x, y)
+		// Note, the bounds are handled via clamping
+		unsigned char alphaAt(const unsigned int x, const unsigned int y) const
+		{
+			if (channels == 4)
+			{
+				return data[((clampIndex(y, height) * width) + clampIndex(x, width)) * channels + 3];
+			}
+			return 255;
+		}
+
+		// Returns a the colour specified by index at (x, y)
+		// Note, the image bounds are handled via clamping, but the index is not checked
+		unsigned char at(const unsigned int x, const unsigned int y, const unsigned int index) const
+		{
+			return data[(((clampIndex(y, height) * width) + clampIndex(x, width)) * channels) + index];
+		}
+
+		// Returns a pointer to the pixel data at (x, y)
+		// Note, no checks performed on x and y coordinates
+		unsigned char* atUnchecked(const unsigned int x, const unsigned int y) const
+		{
+			return &data[((y * width) + x) * channels];
+		}
+
+		// Returns the alpha value of the pixel at (x, y)
+		// Note, no checks performed on x and y coordinates
+		unsigned char alphaAtUnchecked(const unsigned int x, const unsigned int y) const
+		{
+			if (channels == 4)
+			{
+				return data[(((y * width) + x) * channels) + 3];
+			}
+			return 255;
+		}
+
+		// Checks if the image has an alpha channel
+		bool hasAlpha() const
+		{
+			return channels == 4;
+		}
+
+		// Frees the allocated image data
+		void free()
+		{
+			if (data != NULL)
+			{
+				delete[] data;
+				data = NULL;
+			}
+		}
+
+		// Destructor to free resources
+		~Image()
+		{
+			free();
+		}
+
+	private:
+		static unsigned int clampIndex(unsigned int v, unsigned int n)
+		{
+			return v < n ? v : n - 1;
+		}
+	};
+}
@@ -0,0 +1,173 @@
+﻿#include "IntListParser.h"
+#include <climits>
+#include <cstdint>
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PARSE_X86 1
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+// SSE2 is baseline on x86-64; only 32-bit GCC/Clang builds need the target
+// attribute (which would also stop the helpers below from inlining)
+#if defined(PARSE_X86) && !defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define PARSE_TARGET(isa) __attribute__((target(isa)))
+#else
+#define PARSE_TARGET(isa)
+#endif
+
+static inline bool isDigit(unsigned char c) { return (unsigned)(c - '0') < 10u; }
+static inline bool isSeparator(unsigned char c) { return c == ',' || c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+static inline bool isTokenChar(unsigned char c) { return isDigit(c) || c == '-'; }
+
+static inline int lowestBit(unsigned int m)
+{
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward(&i, m);
+    return (int)i;
+#else
+    return __builtin_ctz(m);
+#endif
+}
+
+/* Errors ----------------------------------------------------------------------
+ * Line and column are recovered by counting newlines up to the bad byte, so
+ * the hot loops never track them.
+ * ---------------------------------------------------------------------------*/
+bool IntListParser::fail(size_t at, const char* msg)
+{
+    int line = 1;
+    size_t lineStart = 0;
+    for (size_t i = 0; i < at; ++i)
+        if (base[i] == '\n') { ++line; lineStart = i + 1; }
+    errLine = line;
+    errColumn = (int)(at - lineStart) + 1;
+    errorMsg = msg;
+    pos = end;
+    return false;
+}
+
+// Converts the token base[at, at + len) (digits and '-' only)
+bool IntListParser::token(size_t at, size_t len, int& value)
+{
+    const unsigned char* s = base + at;
+    size_t i = 0;
+    const bool neg = s[0] == '-';
+    if (neg) ++i;
+    if (i == len) return fail(at, "'-' without digits");
+    long long v = 0;
+    for (; i < len; ++i) {
+        if (!isDigit(s[i])) return fail(at + i, "misplaced '-'");
+        v = v * 10 + (s[i] - '0');
+        if (v > (long long)INT_MAX + 1) return fail(at, "number out of range");
+    }
+    if (neg) v = -v;
+    if (v > INT_MAX) return fail(at, "number out of range");
+    value = (int)v;
+    return true;
+}
+
+// Value of the `len` (1..8) ASCII digits at s, without branches: the digits
+// are shifted to the top of an 8-byte word (zeros = leading zeros below),
+// then combined pairwise (SWAR). Reads 8 bytes.
+static inline unsigned int digits8(const unsigned char* s, int len)
+{
+    uint64_t w;
+    memcpy(&w, s, 8);
+    w = (w - 0x3030303030303030ull) << (8 * (8 - len));
+    w = (w * 10) + (w >> 8);
+    w = (((w & 0x000000FF000000FFull) * (100 + (1000000ull << 32))) +
+         (((w >> 16) & 0x000000FF000000FFull) * (1 + (10000ull << 32)))) >> 32;
+    return (unsigned int)w;
+}
+
+int IntListParser::nextScalar(int* dst, int max)
+{
+    int count = 0;
+    while (count < max && pos < end) {
+        const unsigned char c = base[pos];
+        if (isSeparator(c)) { ++pos; continue; }
+        if (!isTokenChar(c)) { fail(pos, "unexpected character"); return count; }
+        size_t e = pos + 1;
+        while (e < end && isTokenChar(base[e])) ++e;
+        if (!token(pos, e - pos, dst[count])) return count;
+        ++count;
+        pos = e;
+        if (pos < end && !isSeparator(base[pos])) { fail(pos, "unexpected character"); return count; }
+    }
+    return count;
+}
+
+/* Bulk path -------------------------------------------------------------------
+ * Per 16-byte block: digit / '-' / separator masks, anything else ends the
+ * block's valid prefix. Token starts are token bits whose left neighbour is
+ * not a token; a token that touches the block end is finished scalar and the
+ * next block is loaded right after it (unaligned loads).
+ * ---------------------------------------------------------------------------*/
+#if defined(PARSE_X86)
+PARSE_TARGET("sse2")
+int IntListParser::next(int* dst, int max)
+{
+    if (failed()) return 0;
+    int count = 0;
+    const __m128i zero = _mm_set1_epi8('0'), nine = _mm_set1_epi8(9);
+    const __m128i comma = _mm_set1_epi8(','), space = _mm_set1_epi8(' '), tab = _mm_set1_epi8('\t');
+    const __m128i cr = _mm_set1_epi8('\r'), lf = _mm_set1_epi8('\n'), minus = _mm_set1_epi8('-');
+
+    while (count < max && pos + 16 <= end) {
+        const __m128i v = _mm_loadu_si128((const __m128i*)(base + pos));
+        const __m128i d = _mm_sub_epi8(v, zero);
+        const __m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(d, nine), d);
+        const __m128i sep = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, comma), _mm_cmpeq_epi8(v, space)),
+            _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, tab), _mm_cmpeq_epi8(v, cr)), _mm_cmpeq_epi8(v, lf)));
+        const unsigned int neg = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, minus));
+        const unsigned int tok = (unsigned int)_mm_movemask_epi8(digit) | neg;
+        const unsigned int bad = ~(tok | (unsigned int)_mm_movemask_epi8(sep)) & 0xFFFFu;
+
+        // Only bytes before the first bad one are parsed in this block
+        const int valid = bad ? lowestBit(bad) : 16;
+        unsigned int starts = tok & ~(tok << 1) & ((1u << valid) - 1);
+        size_t next = pos + valid;
+        while (starts) {
+            const int b = lowestBit(starts);
+            starts &= starts - 1;
+            if (count == max) { next = pos + b; break; }
+            const unsigned int run = ~(tok >> b);
+            const int len = run ? lowestBit(run) : 16 - b;
+            if (b + len >= 16) {
+                // Token may continue into the next block
+                size_t e = pos + b + len;
+                while (e < end && isTokenChar(base[e])) ++e;
+                if (!token(pos + b, e - pos - b, dst[count])) return count;
+                ++count;
+                next = e;
+                break;
+            }
+            if (len <= 8 && !((neg >> b) & ((1u << len) - 1)) && pos + b + 8 <= end) {
+                // Plain digits: cannot overflow, nothing to validate
+                dst[count++] = (int)digits8(base + pos + b, len);
+                continue;
+            }
+            if (!token(pos + b, (size_t)len, dst[count])) return count;
+            ++count;
+        }
+        if (bad && next == pos + valid) {
+            if (count == max) { pos = next; return count; }
+            fail(next, "unexpected character");
+            return count;
+        }
+        pos = next;   // a bad byte right after a split token is caught by the next block
+    }
+    return count + nextScalar(dst + count, max - count);
+}
+#else
+int IntListParser::next(int* dst, int max)
+{
+    if (failed()) return 0;
+    return nextScalar(dst, max);
+}
+#endif
@@ -0,0 +1,43 @@
+﻿#pragma once
+#include <cstddef>
+
+/*****************************  IntListParser  *********************************
+ * Bulk parser for separator-delimited integer lists (tiles.txt layer data).
+ *   - Works on one in-memory buffer (a mapped file), 16 bytes at a time:
+ *     SSE2 classifies digits, '-' and separators (',' ' ' '\t' '\r' '\n')
+ *     for the whole block, rejects anything else, and number boundaries come
+ *     from the digit bitmask; only the digits themselves are read scalar.
+ *   - Strict: stray characters, a lone or misplaced '-' and numbers beyond
+ *     int range are errors. The error carries the 1-based line and column
+ *     (counted from `text`, so pass the start of the file), computed only
+ *     when an error happens.
+ *   - next() fills a caller buffer and can be called until it returns 0;
+ *     bytes past the last requested value are never looked at.
+ *******************************************************************************/
+class IntListParser
+{
+public:
+    // Parses text[begin, len); `text` is the start of the whole file
+    IntListParser(const char* text, size_t len, size_t begin = 0)
+        : base((const unsigned char*)text), end(len), pos(begin) {}
+
+    // Writes up to `max` values to dst; returns how many (0 at end of input
+    // or after an error)
+    int next(int* dst, int max);
+
+    bool        failed()      const { return errorMsg != nullptr; }
+    const char* error()       const { return errorMsg; }
+    int         errorLine()   const { return errLine; }
+    int         errorColumn() const { return errColumn; }
+    size_t      offset()      const { return pos; }
+
+private:
+    const unsigned char* base;
+    size_t end, pos;
+    const char* errorMsg = nullptr;
+    int errLine = 0, errColumn = 0;
+
+    bool fail(size_t at, const char* msg);
+    bool token(size_t at, size_t len, int& value);
+    int  nextScalar(int* dst, int max);
+};
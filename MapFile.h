@@ -0,0 +1,33 @@
+﻿#pragma once
+#include <cstdint>
+
+/********************************  MapFile  ************************************
+ * Compiled binary tile map ("GEMP", version 1), written by
+ * TileMap::saveBinary (game: --compile-map) and memory-mapped by
+ * TileMap::load without parsing.
+ *
+ * File layout (little-endian):
+ *   MapFileHeader | padding to cellOffset | cells
+ * Cells are uint16 tile IDs stored chunk by chunk: the map is cut into
+ * kMapChunkTiles x kMapChunkTiles blocks (chunksX * chunksY, row-major),
+ * each block row-major inside. Edge blocks are padded to full size with
+ * kMapEmptyCell, so a cell's index is pure shifts and masks.
+ *******************************************************************************/
+static const uint32_t kMapFileVersion = 1;
+static const int      kMapChunkShift = 4;
+static const int      kMapChunkTiles = 1 << kMapChunkShift;
+static const int      kMapChunkCells = kMapChunkTiles * kMapChunkTiles;
+static const uint16_t kMapEmptyCell = 0xFFFF;      // No tile (get() returns -1)
+
+struct MapFileHeader
+{
+    char     magic[4];                 // "GEMP"
+    uint32_t version;
+    uint32_t width, height;            // In tiles
+    uint32_t tileW, tileH;             // In pixels
+    uint32_t chunkTiles;               // kMapChunkTiles
+    uint32_t chunksX, chunksY;
+    uint32_t reserved;
+    uint64_t cellOffset;               // Bytes from file start, 64-byte aligned
+    uint64_t fileBytes;                // Whole file, for truncation checks
+};
@@ -0,0 +1,55 @@
+﻿#include "MappedFile.h"
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+bool MappedFile::open(const char* path, bool copyOnWrite)
+{
+    close();
+#ifdef _WIN32
+    HANDLE f = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (f == INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER len;
+    if (!GetFileSizeEx(f, &len) || len.QuadPart <= 0) { CloseHandle(f); return false; }
+    HANDLE m = CreateFileMappingA(f, NULL, copyOnWrite ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, NULL);
+    if (!m) { CloseHandle(f); return false; }
+    void* p = MapViewOfFile(m, copyOnWrite ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0);
+    if (!p) { CloseHandle(m); CloseHandle(f); return false; }
+    fileHandle = f; mapHandle = m;
+    base = (unsigned char*)p;
+    length = (size_t)len.QuadPart;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+    const int prot = copyOnWrite ? (PROT_READ | PROT_WRITE) : PROT_READ;
+    void* p = mmap(nullptr, (size_t)st.st_size, prot, MAP_PRIVATE, fd, 0);
+    ::close(fd);                                   // the mapping keeps the file alive
+    if (p == MAP_FAILED) return false;
+    base = (unsigned char*)p;
+    length = (size_t)st.st_size;
+#endif
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle((HANDLE)mapHandle);
+    CloseHandle((HANDLE)fileHandle);
+    mapHandle = fileHandle = nullptr;
+#else
+    munmap(base, length);
+#endif
+    base = nullptr;
+    length = 0;
+}
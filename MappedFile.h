@@ -0,0 +1,48 @@
+﻿#pragma once
+#include <cstddef>
+#include <utility>
+
+/*******************************  MappedFile  **********************************
+ * Whole-file memory mapping (mmap / MapViewOfFile), closed on destruction.
+ *   - Read-only by default. With `copyOnWrite` the pages are writable but
+ *     private: writes go to this process only and never reach the file.
+ *   - Pages are faulted in on first touch, so opening is O(1) in file size.
+ *   - Empty files cannot be mapped (open fails).
+ *******************************************************************************/
+class MappedFile
+{
+public:
+    MappedFile() = default;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    ~MappedFile() { close(); }
+
+    // Moving hands the mapping over; the source is left closed
+    MappedFile(MappedFile&& o) noexcept { *this = std::move(o); }
+    MappedFile& operator=(MappedFile&& o) noexcept
+    {
+        if (this == &o) return *this;
+        close();
+        base = o.base; length = o.length; o.base = nullptr; o.length = 0;
+#ifdef _WIN32
+        fileHandle = o.fileHandle; mapHandle = o.mapHandle;
+        o.fileHandle = o.mapHandle = nullptr;
+#endif
+        return *this;
+    }
+
+    bool open(const char* path, bool copyOnWrite = false);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    unsigned char* data() const { return base; }   // Writable only with copyOnWrite
+    size_t size() const { return length; }
+
+private:
+    unsigned char* base = nullptr;
+    size_t length = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mapHandle = nullptr;
+#endif
+};
@@ -1,5 +1,7 @@
 ﻿#pragma once
 #include "GamesEngineeringBase.h"
+#include "DirtyRects.h"
+#include "FrameCommands.h"
 using namespace GamesEngineeringBase;
 
 
@@ -24,6 +26,8 @@ namespace SaveLoad {
 /************************************  NPC  ************************************
  * Single enemy unit. Owns its state, update, and draw; lifetime and pooling are
  * handled externally by EnemyManager (no STL usage here). Rectangle hitbox (w,h).
+ * EnemyManager keeps its NPCs column-wise in an NPCStore and converts slots
+ * to and from this record; update() is the scalar reference for its kernels.
  *******************************************************************************/
 class NPC
 {
@@ -64,6 +68,7 @@ private:
 
 public:
     friend class EnemyManager;
+    friend class NPCStore;
 
     // ---- Lifetime control ----
     void kill() { alive = false; }
@@ -81,6 +86,15 @@ public:
     // For non-turret types, steer smoothly toward target and move.
     // Clamps position inside [0, worldW-w] × [0, worldH-h].
     void update(float dt, float targetX, float targetY, int worldW, int worldH)
+    {
+        float ux, uy;
+        unitVector(targetX - x, targetY - y, ux, uy);
+        steer(dt, ux, uy, worldW, worldH);
+    }
+
+    // Same as update() with the wanted heading given as a unit vector
+    // (e.g. sampled from a FlowField) instead of a target point
+    void steer(float dt, float ux, float uy, int worldW, int worldH)
     {
         if (!alive) return;
 
@@ -90,9 +104,6 @@ public:
             float steer = (type == 2 ? 0.35f : (type == 3 ? 0.15f : 0.20f));
             float inertia = 1.0f - steer;
 
-            float ux, uy;
-            unitVector(targetX - x, targetY - y, ux, uy);
-
             // Exponential smoothing toward target direction, then renormalize
             vx = inertia * vx + steer * ux;
             vy = inertia * vy + steer * uy;
@@ -112,17 +123,9 @@ public:
     }
 
     // ---- Rendering (camera top-left to screen space) ----
-    void draw(Window& win, float camX, float camY)
+    // Color per type for quick visual identification
+    void typeColor(unsigned char& r, unsigned char& g, unsigned char& b) const
     {
-        if (!alive) return;
-        const int W = (int)win.getWidth(), H = (int)win.getHeight();
-
-        int sx = (int)(x - camX);
-        int sy = (int)(y - camY);
-        if (sx + w < 0 || sy + h < 0 || sx >= W || sy >= H) return;
-
-        // Color per type for quick visual identification
-        unsigned char r = 255, g = 0, b = 0;
         switch (type)
         {
         case 0: r = 255; g = 60;  b = 60;  break; // chaser
@@ -131,6 +134,29 @@ public:
         case 3: r = 255; g = 150; b = 40;  break; // heavy
         default: r = 255; g = 0;  b = 0;   break;
         }
+    }
+
+    // Same as draw(), recorded for the banded renderer
+    void record(FrameCommands& out, float camX, float camY) const
+    {
+        if (!alive) return;
+        unsigned char r, g, b;
+        typeColor(r, g, b);
+        out.fillRect((int)(x - camX), (int)(y - camY), w, h, r, g, b);
+    }
+
+    void draw(Window& win, float camX, float camY)
+    {
+        if (!alive) return;
+        const int W = (int)win.getWidth(), H = (int)win.getHeight();
+
+        int sx = (int)(x - camX);
+        int sy = (int)(y - camY);
+        if (sx + w < 0 || sy + h < 0 || sx >= W || sy >= H) return;
+
+        unsigned char r, g, b;
+        typeColor(r, g, b);
+        markDirty(win, sx, sy, w, h);
 
         for (int yy = 0; yy < h; ++yy) {
             int py = sy + yy; if (py < 0 || py >= H) continue;
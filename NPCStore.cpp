@@ -0,0 +1,223 @@
+﻿#include "NPCStore.h"
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define NPC_X86 1
+#include <immintrin.h>
+#endif
+
+// See blit.cpp: GCC/Clang need the target attribute for non-baseline intrinsics
+#if defined(NPC_X86) && (defined(__GNUC__) || defined(__clang__))
+#define NPC_TARGET(isa) __attribute__((target(isa)))
+#else
+#define NPC_TARGET(isa)
+#endif
+
+const float NPCStore::kTurnByType[4] = { 0.20f, 0.0f, 0.35f, 0.15f };
+
+void NPCStore::resize(int capacity)
+{
+    const size_t n = capacity > 0 ? (size_t)capacity : 0;
+    x.assign(n, 0.f);  y.assign(n, 0.f);
+    vx.assign(n, 0.f); vy.assign(n, 0.f);
+    speed.assign(n, 0.f); turn.assign(n, 0.f);
+    wantX.assign(n, 0.f); wantY.assign(n, 0.f);
+    hp.assign(n, 0); w.assign(n, 24); h.assign(n, 24);
+    fireCD.assign(n, 0.f);
+    type.assign(n, 0); alive.assign(n, 0);
+    slots.reset((int)n);
+}
+
+int NPCStore::spawn(const NPC& n)
+{
+    const int i = slots.acquire();
+    if (i < 0) return -1;
+    alive[i] = 1;
+    put(i, n);
+    return i;
+}
+
+void NPCStore::kill(int i)
+{
+    if (!alive[i]) return;
+    alive[i] = 0;
+    turn[i] = 0.f;
+    slots.release(i);
+}
+
+void NPCStore::clear()
+{
+    while (slots.liveCount() > 0) kill(slots.liveAt(slots.liveCount() - 1));
+}
+
+NPC NPCStore::get(int i) const
+{
+    NPC n;
+    n.x = x[i];   n.y = y[i];
+    n.vx = vx[i]; n.vy = vy[i];
+    n.speed = speed[i];
+    n.w = w[i];   n.h = h[i];
+    n.hp = hp[i];
+    n.fireCD = fireCD[i];
+    n.type = type[i];
+    n.alive = alive[i] != 0;
+    return n;
+}
+
+void NPCStore::put(int i, const NPC& n)
+{
+    x[i] = n.x;   y[i] = n.y;
+    vx[i] = n.vx; vy[i] = n.vy;
+    speed[i] = n.speed;
+    w[i] = n.w;   h[i] = n.h;
+    hp[i] = n.hp;
+    fireCD[i] = n.fireCD;
+    type[i] = n.type;
+    turn[i] = alive[i] ? turnFor(n.type) : 0.f;
+}
+
+/* Steering kernels ------------------------------------------------------------
+ * Per NPC, as NPC::update: u = normalize(want); v = normalize((1 - t) v + t u);
+ * p += v * speed * dt; clamp. Zero-length vectors normalize to zero (the
+ * scalar unitVector rule), done in SIMD by masking the rsqrt result. Lanes
+ * with t == 0 (turrets, dead slots) keep their velocity and position but are
+ * still clamped, as NPC::update clamps turrets.
+ * ---------------------------------------------------------------------------*/
+static void steerScalar(NPCStore& s, int begin, int end, float dt, int worldW, int worldH)
+{
+    for (int i = begin; i < end; ++i) {
+        if (s.turn[i] > 0.f) {
+            const float t = s.turn[i];
+            float ux = s.wantX[i], uy = s.wantY[i];
+            float len2 = ux * ux + uy * uy;
+            if (len2 <= 1e-6f) { ux = 0.f; uy = 0.f; }
+            else { const float inv = 1.0f / std::sqrt(len2); ux *= inv; uy *= inv; }
+
+            float vx = (1.0f - t) * s.vx[i] + t * ux;
+            float vy = (1.0f - t) * s.vy[i] + t * uy;
+            len2 = vx * vx + vy * vy;
+            if (len2 <= 1e-6f) { vx = 0.f; vy = 0.f; }
+            else { const float inv = 1.0f / std::sqrt(len2); vx *= inv; vy *= inv; }
+            s.vx[i] = vx; s.vy[i] = vy;
+            s.x[i] += vx * s.speed[i] * dt;
+            s.y[i] += vy * s.speed[i] * dt;
+        }
+        float px = s.x[i], py = s.y[i];
+        if (px < 0) px = 0; if (py < 0) py = 0;
+        if (px > worldW - s.w[i]) px = (float)(worldW - s.w[i]);
+        if (py > worldH - s.h[i]) py = (float)(worldH - s.h[i]);
+        s.x[i] = px; s.y[i] = py;
+    }
+}
+
+#if defined(NPC_X86)
+
+// 1 / |v| with one Newton step, 0 where |v|^2 <= 1e-6
+NPC_TARGET("sse2")
+static inline __m128 invLength4(__m128 len2)
+{
+    const __m128 r = _mm_rsqrt_ps(len2);
+    const __m128 nr = _mm_mul_ps(r, _mm_sub_ps(_mm_set1_ps(1.5f),
+        _mm_mul_ps(_mm_mul_ps(_mm_set1_ps(0.5f), len2), _mm_mul_ps(r, r))));
+    return _mm_and_ps(nr, _mm_cmpgt_ps(len2, _mm_set1_ps(1e-6f)));
+}
+
+NPC_TARGET("sse2")
+static int steerSSE(NPCStore& s, int n, float dt, int worldW, int worldH)
+{
+    const __m128 one = _mm_set1_ps(1.f), zero = _mm_setzero_ps(), vdt = _mm_set1_ps(dt);
+    const __m128i ww = _mm_set1_epi32(worldW), wh = _mm_set1_epi32(worldH);
+    int i = 0;
+    for (; i + 4 <= n; i += 4) {
+        const __m128 t = _mm_loadu_ps(&s.turn[i]);
+        const __m128 moving = _mm_cmpgt_ps(t, zero);
+        __m128 px = _mm_loadu_ps(&s.x[i]), py = _mm_loadu_ps(&s.y[i]);
+
+        if (_mm_movemask_ps(moving)) {
+            __m128 ux = _mm_loadu_ps(&s.wantX[i]), uy = _mm_loadu_ps(&s.wantY[i]);
+            __m128 inv = invLength4(_mm_add_ps(_mm_mul_ps(ux, ux), _mm_mul_ps(uy, uy)));
+            ux = _mm_mul_ps(ux, inv); uy = _mm_mul_ps(uy, inv);
+
+            const __m128 ovx = _mm_loadu_ps(&s.vx[i]), ovy = _mm_loadu_ps(&s.vy[i]);
+            const __m128 keep = _mm_sub_ps(one, t);
+            __m128 nvx = _mm_add_ps(_mm_mul_ps(keep, ovx), _mm_mul_ps(t, ux));
+            __m128 nvy = _mm_add_ps(_mm_mul_ps(keep, ovy), _mm_mul_ps(t, uy));
+            inv = invLength4(_mm_add_ps(_mm_mul_ps(nvx, nvx), _mm_mul_ps(nvy, nvy)));
+            nvx = _mm_mul_ps(nvx, inv); nvy = _mm_mul_ps(nvy, inv);
+
+            const __m128 step = _mm_and_ps(_mm_mul_ps(_mm_loadu_ps(&s.speed[i]), vdt), moving);
+            px = _mm_add_ps(px, _mm_mul_ps(nvx, step));
+            py = _mm_add_ps(py, _mm_mul_ps(nvy, step));
+            _mm_storeu_ps(&s.vx[i], _mm_or_ps(_mm_and_ps(moving, nvx), _mm_andnot_ps(moving, ovx)));
+            _mm_storeu_ps(&s.vy[i], _mm_or_ps(_mm_and_ps(moving, nvy), _mm_andnot_ps(moving, ovy)));
+        }
+
+        const __m128 maxX = _mm_cvtepi32_ps(_mm_sub_epi32(ww, _mm_loadu_si128((const __m128i*)&s.w[i])));
+        const __m128 maxY = _mm_cvtepi32_ps(_mm_sub_epi32(wh, _mm_loadu_si128((const __m128i*)&s.h[i])));
+        _mm_storeu_ps(&s.x[i], _mm_min_ps(_mm_max_ps(px, zero), maxX));
+        _mm_storeu_ps(&s.y[i], _mm_min_ps(_mm_max_ps(py, zero), maxY));
+    }
+    return i;
+}
+
+NPC_TARGET("avx2")
+static inline __m256 invLength8(__m256 len2)
+{
+    const __m256 r = _mm256_rsqrt_ps(len2);
+    const __m256 nr = _mm256_mul_ps(r, _mm256_sub_ps(_mm256_set1_ps(1.5f),
+        _mm256_mul_ps(_mm256_mul_ps(_mm256_set1_ps(0.5f), len2), _mm256_mul_ps(r, r))));
+    return _mm256_and_ps(nr, _mm256_cmp_ps(len2, _mm256_set1_ps(1e-6f), _CMP_GT_OQ));
+}
+
+NPC_TARGET("avx2")
+static int steerAVX2(NPCStore& s, int n, float dt, int worldW, int worldH)
+{
+    const __m256 one = _mm256_set1_ps(1.f), zero = _mm256_setzero_ps(), vdt = _mm256_set1_ps(dt);
+    const __m256i ww = _mm256_set1_epi32(worldW), wh = _mm256_set1_epi32(worldH);
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 t = _mm256_loadu_ps(&s.turn[i]);
+        const __m256 moving = _mm256_cmp_ps(t, zero, _CMP_GT_OQ);
+        __m256 px = _mm256_loadu_ps(&s.x[i]), py = _mm256_loadu_ps(&s.y[i]);
+
+        if (_mm256_movemask_ps(moving)) {
+            __m256 ux = _mm256_loadu_ps(&s.wantX[i]), uy = _mm256_loadu_ps(&s.wantY[i]);
+            __m256 inv = invLength8(_mm256_add_ps(_mm256_mul_ps(ux, ux), _mm256_mul_ps(uy, uy)));
+            ux = _mm256_mul_ps(ux, inv); uy = _mm256_mul_ps(uy, inv);
+
+            const __m256 ovx = _mm256_loadu_ps(&s.vx[i]), ovy = _mm256_loadu_ps(&s.vy[i]);
+            const __m256 keep = _mm256_sub_ps(one, t);
+            __m256 nvx = _mm256_add_ps(_mm256_mul_ps(keep, ovx), _mm256_mul_ps(t, ux));
+            __m256 nvy = _mm256_add_ps(_mm256_mul_ps(keep, ovy), _mm256_mul_ps(t, uy));
+            inv = invLength8(_mm256_add_ps(_mm256_mul_ps(nvx, nvx), _mm256_mul_ps(nvy, nvy)));
+            nvx = _mm256_mul_ps(nvx, inv); nvy = _mm256_mul_ps(nvy, inv);
+
+            const __m256 step = _mm256_and_ps(_mm256_mul_ps(_mm256_loadu_ps(&s.speed[i]), vdt), moving);
+            px = _mm256_add_ps(px, _mm256_mul_ps(nvx, step));
+            py = _mm256_add_ps(py, _mm256_mul_ps(nvy, step));
+            _mm256_storeu_ps(&s.vx[i], _mm256_blendv_ps(ovx, nvx, moving));
+            _mm256_storeu_ps(&s.vy[i], _mm256_blendv_ps(ovy, nvy, moving));
+        }
+
+        const __m256 maxX = _mm256_cvtepi32_ps(_mm256_sub_epi32(ww, _mm256_loadu_si256((const __m256i*)&s.w[i])));
+        const __m256 maxY = _mm256_cvtepi32_ps(_mm256_sub_epi32(wh, _mm256_loadu_si256((const __m256i*)&s.h[i])));
+        _mm256_storeu_ps(&s.x[i], _mm256_min_ps(_mm256_max_ps(px, zero), maxX));
+        _mm256_storeu_ps(&s.y[i], _mm256_min_ps(_mm256_max_ps(py, zero), maxY));
+    }
+    return i;
+}
+
+#endif // NPC_X86
+
+void NPCStore::steerAll(float dt, int worldW, int worldH, CpuIsa isa)
+{
+    const int n = slots.highWater();
+    int done = 0;
+#if defined(NPC_X86)
+    if (isa == CpuIsa::AVX2)      done = steerAVX2(*this, n, dt, worldW, worldH);
+    else if (isa != CpuIsa::Scalar) done = steerSSE(*this, n, dt, worldW, worldH);
+#else
+    (void)isa;
+#endif
+    steerScalar(*this, done, n, dt, worldW, worldH);
+}
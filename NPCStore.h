@@ -0,0 +1,69 @@
+﻿#pragma once
+#include "NPC.h"
+#include "CpuFeatures.h"
+#include "Pool.h"
+#include <vector>
+
+/*********************************  NPCStore  **********************************
+ * Structure-of-arrays storage for EnemyManager's NPCs.
+ *   - One column per field, so the per-frame steering pass streams only the
+ *     hot columns (position, velocity, speed, turn rate, wanted heading)
+ *     while hp, fireCD, type and size stay out of the cache.
+ *   - Slots come from a SlotPool: spawn() and kill() are O(1), liveAt()
+ *     lists the live slots densely, and a full store counts drops().
+ *   - NPC remains the record type: spawn()/get()/put() convert one slot for
+ *     cold paths (spawning, save/load, drawing) and NPC::update is the
+ *     scalar reference the kernels reproduce.
+ *   - steerAll() sweeps the columns up to the pool's high-water mark in 4
+ *     (SSE) or 8 (AVX2) lanes: turn rates
+ *     come from turnFor(type), normalizes use rsqrt plus one Newton step.
+ *     Dead slots and turrets have a turn rate of 0 and do not move.
+ *******************************************************************************/
+class NPCStore
+{
+public:
+    // Steering sensitivity per NPC type (chaser, turret, light, heavy);
+    // 0 = does not move. Other types steer like chasers, as NPC::steer does.
+    static const float kTurnByType[4];
+    static float turnFor(int type) { return (type >= 0 && type < 4) ? kTurnByType[type] : kTurnByType[0]; }
+
+    // Drops every NPC and sizes the columns
+    void resize(int capacity);
+    int  capacity() const { return (int)alive.size(); }
+
+    // Stores n (made alive) in a free slot; -1 when full (counted in drops())
+    int  spawn(const NPC& n);
+    void kill(int i);
+    void clear();
+
+    bool isAlive(int i) const { return alive[i] != 0; }
+    int  liveCount() const { return slots.liveCount(); }
+    int  liveAt(int k) const { return slots.liveAt(k); }
+    const int* liveSlots() const { return slots.liveSlots(); }
+    int  livePos(int i) const { return slots.livePos(i); }
+    int  drops() const { return slots.drops(); }
+    PoolHandle handle(int i) const { return slots.handle(i); }
+    bool isValid(PoolHandle h) const { return slots.isValid(h); }
+
+    // Slot conversion for cold paths; put() overwrites every field but
+    // liveness, which only spawn()/kill() change
+    NPC  get(int i) const;
+    void put(int i, const NPC& n);
+
+    // Moves every live, mobile NPC one step toward (wantX, wantY) (any
+    // length; zero keeps the current heading decaying as in NPC::update),
+    // then clamps positions to [0, worldW - w] x [0, worldH - h]
+    void steerAll(float dt, int worldW, int worldH, CpuIsa isa);
+
+    // Hot columns
+    std::vector<float> x, y, vx, vy, speed, turn;
+    std::vector<float> wantX, wantY;         // Filled by the caller before steerAll
+
+    // Cold columns
+    std::vector<int>   hp, w, h;
+    std::vector<float> fireCD;
+    std::vector<unsigned char> type, alive;
+
+private:
+    SlotPool slots;
+};
@@ -1,6 +1,9 @@
 ﻿#include "NPCSystem.h"
 #include "Player.h"      // needs full Player definition
+#include <algorithm>
+#include <climits>
 #include <cmath>
+#include <vector>
 
 /* PlayerProjectile -----------------------------------------------------------
  * Spawn: reset to a clean straight-shot state (tint/damage/flags) and set kinematics.
@@ -40,16 +43,10 @@ void PlayerProjectile::update(float dt) {
 }
 
 /* EnemyManager internals -----------------------------------------------------
- * Slot allocation, world size cache, spawn logic, bullet allocation.
- * The manager owns raw arrays so all helpers are O(N) and branch-light.
+ * World size cache and spawn logic. NPCs and both projectile sets live in
+ * pools (Pool.h): O(1) acquire/release, live slots walked densely, and a
+ * full pool drops the spawn and counts it.
  * ---------------------------------------------------------------------------*/
-int EnemyManager::allocIndex()
-{
-    // Find first dead slot; return -1 when the pool is saturated.
-    for (int i = 0; i < MAX; ++i) if (!enemies[i].isAlive()) return i;
-    return -1;
-}
-
 void EnemyManager::mapPixelSize(int& outW, int& outH)
 {
     // Derive world size in pixels from tile grid; cache elsewhere for draw/cull.
@@ -65,9 +62,6 @@ void EnemyManager::mapPixelSize(int& outW, int& outH)
  * ---------------------------------------------------------------------------*/
 void EnemyManager::spawnOne(float camX, float camY, int viewW, int viewH, float px, float py)
 {
-    int idx = allocIndex();
-    if (idx < 0) return;
-
     int worldW, worldH;
     mapPixelSize(worldW, worldH);
     if (worldW <= 0 || worldH <= 0) return;
@@ -106,28 +100,22 @@ void EnemyManager::spawnOne(float camX, float camY, int viewW, int viewH, float
     }
 
     // Spawn looking at the player so the initial steering direction is sensible.
-    enemies[idx].initSpawn(sx, sy, type, spd, px, py);
+    NPC n;
+    n.initSpawn(sx, sy, type, spd, px, py);
 
     // Patch size/HP via friend access — serialization relies on these exact fields.
-    enemies[idx].w = w;
-    enemies[idx].h = h;
-    enemies[idx].hp = hp;
+    n.w = w;
+    n.h = h;
+    n.hp = hp;
 
     // Turrets get an immediate near-term cooldown; movers get a huge CD to disable stray shots.
     if (type == 1) {
-        enemies[idx].setFireCD(0.2f + 0.2f * frand01()); // 0.2–0.4s
+        n.setFireCD(0.2f + 0.2f * frand01()); // 0.2–0.4s
     }
     else {
-        enemies[idx].setFireCD(999.f);
+        n.setFireCD(999.f);
     }
-}
-
-int EnemyManager::allocBullet()
-{
-    // First-fit for enemy projectile slots
-    for (int i = 0; i < BULLET_MAX; ++i)
-        if (!enemyProjectiles[i].alive) return i;
-    return -1;
+    if (enemies.spawn(n) >= 0) npcGridValid = false;   // dropped (and counted) when the pool is full
 }
 
 /* Initialization --------------------------------------------------------------
@@ -140,13 +128,14 @@ void EnemyManager::init(TileMap* m)
     elapsedSeconds = 0.f;
     spawnAccumulator = 0.f;
 
-    for (int i = 0; i < MAX; ++i) enemies[i].kill();
+    enemies.resize(enemyCapacity);
+    npcGridValid = false;
 
     srand(12345); // replace or remove if a global RNG policy exists
 
     // Clear projectile pools
-    for (int i = 0; i < BULLET_MAX; ++i)               enemyProjectiles[i].alive = false;
-    for (int i = 0; i < kPlayerProjectileCapacity; ++i) playerProjectiles[i].alive = false;
+    enemyProjectiles.reset(bulletCapacity);
+    playerProjectiles.reset(heroBulletCapacity);
 
     // Cache world size for culling and clamp math
     mapPixelSize(worldWidthPx, worldHeightPx);
@@ -175,7 +164,8 @@ void EnemyManager::trySpawn(float dt, float camX, float camY, int viewW, int vie
 
 /* Update loop -----------------------------------------------------------------
  * Compute effective world bounds (disable clamping for infinite mode).
- * Step each NPC, then handle turret fire with randomized cooldown desync.
+ * Step each NPC along the flow field (straight at the player where it has no
+ * direction), then handle turret fire with randomized cooldown desync.
  * ---------------------------------------------------------------------------*/
 void EnemyManager::updateAll(float dt, float px, float py)
 {
@@ -188,44 +178,49 @@ void EnemyManager::updateAll(float dt, float px, float py)
         worldH = 1 << 29;
     }
 
-    for (int i = 0; i < MAX; ++i)
-    {
-        if (!enemies[i].isAlive()) continue;
-
-        // NPC owns its own steering/velocity integration
-        enemies[i].update(dt, px, py, worldW, worldH);
+    // Rebuilt only when the player enters another tile (or the map changes)
+    if (tileMap) {
+        const int goalTx = (int)std::floor(px / tileMap->getTileW());
+        const int goalTy = (int)std::floor(py / tileMap->getTileH());
+        flow.update(*tileMap, goalTx, goalTy);
+    }
 
-        // For finite maps, enforce post-step clamping (robust even if internal logic changes later).
-        if (!isInfiniteWorld) {
-            float x = enemies[i].getX();
-            float y = enemies[i].getY();
-            int   w = enemies[i].getW();
-            int   h = enemies[i].getH();
+    // Wanted heading per slot: the flow field's, else straight at the player
+    // from the NPC's top-left (as NPC::update aims)
+    for (int k = 0; k < enemies.liveCount(); ++k)
+    {
+        const int i = enemies.liveAt(k);
+        const float cx = enemies.x[i] + enemies.w[i] * 0.5f;
+        const float cy = enemies.y[i] + enemies.h[i] * 0.5f;
+        if (!tileMap || !flow.direction(cx, cy, enemies.wantX[i], enemies.wantY[i])) {
+            enemies.wantX[i] = px - enemies.x[i];
+            enemies.wantY[i] = py - enemies.y[i];
+        }
+    }
 
-            if (x < 0) x = 0;
-            if (y < 0) y = 0;
-            if (x > worldW - w) x = (float)(worldW - w);
-            if (y > worldH - h) y = (float)(worldH - h);
+    // Steering, integration and the bounds clamp for every slot at once
+    // (finite maps clamp to the map, infinite maps to the huge bounds above)
+    enemies.steerAll(dt, worldW, worldH, cpuDetectIsa());
+    npcGridValid = false;
 
-            enemies[i].x = x; // friend write
-            enemies[i].y = y;
-        }
-        // Infinite mode: no clamps, allow roam beyond original map.
+    for (int k = 0; k < enemies.liveCount(); ++k)
+    {
+        const int i = enemies.liveAt(k);
 
         // Turret-only firing
-        if (enemies[i].type == 1)
+        if (enemies.type[i] == 1)
         {
-            enemies[i].fireCD -= dt;
+            enemies.fireCD[i] -= dt;
 
-            if (enemies[i].fireCD <= 0.f)
+            if (enemies.fireCD[i] <= 0.f)
             {
                 // Fire from turret center toward player center
-                float cx = enemies[i].getX() + enemies[i].getHitboxW() * 0.5f;
-                float cy = enemies[i].getY() + enemies[i].getHitboxH() * 0.5f;
+                float cx = enemies.x[i] + enemies.w[i] * 0.5f;
+                float cy = enemies.y[i] + enemies.h[i] * 0.5f;
                 float dirx = px - cx;
                 float diry = py - cy;
 
-                int bi = allocBullet();
+                int bi = enemyProjectiles.acquire();
                 if (bi >= 0)
                 {
                     float sx = cx - 3.f; // center a 6×6 projectile
@@ -237,7 +232,7 @@ void EnemyManager::updateAll(float dt, float px, float py)
                 }
 
                 // Desync turrets to avoid a single global beat
-                enemies[i].fireCD = 1.0f + 0.4f * frand01();
+                enemies.fireCD[i] = 1.0f + 0.4f * frand01();
             }
         }
     }
@@ -246,14 +241,25 @@ void EnemyManager::updateAll(float dt, float px, float py)
 /* Render NPCs -----------------------------------------------------------------*/
 void EnemyManager::drawAll(Window& win, float camX, float camY)
 {
-    for (int i = 0; i < MAX; ++i)
-        if (enemies[i].isAlive())
-            enemies[i].draw(win, camX, camY);
+    for (int k = 0; k < enemies.liveCount(); ++k)
+        enemies.get(enemies.liveAt(k)).draw(win, camX, camY);
+}
+
+void EnemyManager::recordAll(FrameCommands& out, float camX, float camY) const
+{
+    for (int k = 0; k < enemies.liveCount(); ++k)
+        enemies.get(enemies.liveAt(k)).record(out, camX, camY);
 }
 
 /* Player vs NPC collision ------------------------------------------------------
  * Resolve minimal separation along the axis of least overlap to prevent tunneling.
  * Apply a short knockback impulse using the engine’s existing helper.
+ *
+ * NPCs are resolved in slot order (the fixed-array scan's order; the live
+ * list is reshuffled by every release) against the hero's current, already
+ * pushed box. Candidates come from a rect query padded by one grid cell;
+ * once the pushes add up to more than that pad, every live slot after the
+ * last one resolved is scanned instead.
  * ---------------------------------------------------------------------------*/
 void EnemyManager::checkPlayerCollision(Player& hero)
 {
@@ -267,17 +273,15 @@ void EnemyManager::checkPlayerCollision(Player& hero)
     float offX = (hero.getW() - hw) * 0.5f;
     float offY = (hero.getH() - hh) * 0.5f;
 
-    for (int i = 0; i < MAX; ++i)
+    auto resolve = [&](int i)
     {
-        if (!enemies[i].isAlive()) continue;
-
-        float nx = enemies[i].getHitboxX();
-        float ny = enemies[i].getHitboxY();
-        float nw = (float)enemies[i].getHitboxW();
-        float nh = (float)enemies[i].getHitboxH();
+        float nx = enemies.x[i];
+        float ny = enemies.y[i];
+        float nw = (float)enemies.w[i];
+        float nh = (float)enemies.h[i];
 
         if (!aabbIntersect(hx, hy, hw, hh, nx, ny, nw, nh))
-            continue;
+            return;
 
         // Minimal translation vector: compare overlap on X vs Y
         float hcX = hx + hw * 0.5f, hcY = hy + hh * 0.5f;
@@ -302,31 +306,97 @@ void EnemyManager::checkPlayerCollision(Player& hero)
 
         // Optional: hook for damage/i-frames/audio
         // hero.takeHit();
+    };
+
+    ensureNPCGrid();
+    const float pad = npcGrid.cellSize();
+    const float startX = hx, startY = hy;
+    auto insidePad = [&] { return std::fabs(hx - startX) <= pad && std::fabs(hy - startY) <= pad; };
+
+    std::vector<int>& candidates = queryScratch;
+    queryRect(hx - pad, hy - pad, hx + hw + pad, hy + hh + pad, candidates);
+    std::sort(candidates.begin(), candidates.end());
+
+    int last = -1;
+    for (const int i : candidates) {
+        if (!insidePad()) break;
+        resolve(i);
+        last = i;
     }
+    if (insidePad()) return;
+
+    // Pushed past the pad: the query no longer covers every NPC in reach
+    npcSlots.assign(enemies.liveSlots(), enemies.liveSlots() + enemies.liveCount());
+    std::sort(npcSlots.begin(), npcSlots.end());
+    for (const int i : npcSlots)
+        if (i > last) resolve(i);
 }
 
-/* Nearest target query --------------------------------------------------------
- * Linear scan is fine for ≤128 NPCs; returns center of the closest alive NPC.
- * Useful for homing, aim assist, or AOE targeting.
+/* Spatial queries --------------------------------------------------------------
+ * npcGrid buckets live NPCs by top-left corner; queries take candidates from
+ * it and apply the exact test, skipping NPCs killed since the build.
  * ---------------------------------------------------------------------------*/
-bool EnemyManager::findNearestAlive(float px, float py, float& tx, float& ty) const
+void EnemyManager::ensureNPCGrid() const
 {
-    float bestD2 = 1e30f;
-    bool found = false;
+    if (npcGridValid) return;
+    const int live = enemies.liveCount();
+    int largest = 1;
+    for (int k = 0; k < live; ++k) {
+        const int i = enemies.liveAt(k);
+        largest = std::max(largest, std::max(enemies.w[i], enemies.h[i]));
+    }
+    npcGrid.build(enemies.x.data(), enemies.y.data(), enemies.liveSlots(), live, (float)largest);
+    npcGridValid = true;
+}
 
-    for (int i = 0; i < MAX; ++i) {
-        const NPC& n = enemies[i];
-        if (!n.alive) continue;
+int EnemyManager::queryNearest(float px, float py, int k, std::vector<int>& out) const
+{
+    ensureNPCGrid();
+    return npcGrid.nearest(px, py, k, [&](int i) {
+        if (!enemies.isAlive(i)) return -1.f;
+        const float dx = enemies.x[i] + enemies.w[i] * 0.5f - px;
+        const float dy = enemies.y[i] + enemies.h[i] * 0.5f - py;
+        return dx * dx + dy * dy;
+    }, out);
+}
 
-        float cx = n.getHitboxX() + n.getHitboxW() * 0.5f;
-        float cy = n.getHitboxY() + n.getHitboxH() * 0.5f;
+int EnemyManager::queryRadius(float cx, float cy, float r, std::vector<int>& out) const
+{
+    out.clear();
+    ensureNPCGrid();
+    const float r2 = r * r;
+    npcGrid.forEachNear(cx - r, cy - r, cx + r, cy + r, [&](int i) {
+        if (!enemies.isAlive(i)) return;
+        const float dx = enemies.x[i] + enemies.w[i] * 0.5f - cx;
+        const float dy = enemies.y[i] + enemies.h[i] * 0.5f - cy;
+        if (dx * dx + dy * dy <= r2) out.push_back(i);
+    });
+    return (int)out.size();
+}
 
-        float dx = cx - px, dy = cy - py;
-        float d2 = dx * dx + dy * dy;
+int EnemyManager::queryRect(float x0, float y0, float x1, float y1, std::vector<int>& out) const
+{
+    out.clear();
+    ensureNPCGrid();
+    npcGrid.forEachNear(x0, y0, x1, y1, [&](int i) {
+        if (enemies.isAlive(i) && aabbIntersect(x0, y0, x1 - x0, y1 - y0,
+                enemies.x[i], enemies.y[i], (float)enemies.w[i], (float)enemies.h[i]))
+            out.push_back(i);
+    });
+    return (int)out.size();
+}
 
-        if (d2 < bestD2) { bestD2 = d2; tx = cx; ty = cy; found = true; }
-    }
-    return found;
+/* Nearest target query --------------------------------------------------------
+ * Returns center of the closest alive NPC via the grid's ring search.
+ * Useful for homing, aim assist, or AOE targeting.
+ * ---------------------------------------------------------------------------*/
+bool EnemyManager::findNearestAlive(float px, float py, float& tx, float& ty) const
+{
+    if (queryNearest(px, py, 1, queryScratch) == 0) return false;
+    const int i = queryScratch[0];
+    tx = enemies.x[i] + enemies.w[i] * 0.5f;
+    ty = enemies.y[i] + enemies.h[i] * 0.5f;
+    return true;
 }
 
 /* Enemy bullets ---------------------------------------------------------------
@@ -335,9 +405,10 @@ bool EnemyManager::findNearestAlive(float px, float py, float& tx, float& ty) co
  * ---------------------------------------------------------------------------*/
 void EnemyManager::updateBullets(float dt)
 {
-    for (int i = 0; i < BULLET_MAX; ++i)
+    // Backwards: releasing moves the last live slot into position k
+    for (int k = enemyProjectiles.liveCount() - 1; k >= 0; --k)
     {
-        if (!enemyProjectiles[i].alive) continue;
+        const int i = enemyProjectiles.liveAt(k);
 
         enemyProjectiles[i].x += enemyProjectiles[i].vx * dt;
         enemyProjectiles[i].y += enemyProjectiles[i].vy * dt;
@@ -350,6 +421,7 @@ void EnemyManager::updateBullets(float dt)
 
         if (enemyProjectiles[i].life <= 0.f || (!isInfiniteWorld && outByWorld)) {
             enemyProjectiles[i].alive = false;
+            enemyProjectiles.release(i);
         }
     }
 }
@@ -368,9 +440,9 @@ void EnemyManager::checkHeroHit(Player& hero)
     float hcx = hx + hw * 0.5f;
     float hcy = hy + hh * 0.5f;
 
-    for (int i = 0; i < BULLET_MAX; ++i)
+    for (int k = enemyProjectiles.liveCount() - 1; k >= 0; --k)
     {
-        if (!enemyProjectiles[i].alive) continue;
+        const int i = enemyProjectiles.liveAt(k);
 
         if (aabbOverlap(enemyProjectiles[i].getHitboxX(), enemyProjectiles[i].getHitboxY(),
             enemyProjectiles[i].getHitboxW(), enemyProjectiles[i].getHitboxH(),
@@ -383,6 +455,7 @@ void EnemyManager::checkHeroHit(Player& hero)
 
             // Optional: hero.takeHit();
             enemyProjectiles[i].alive = false;
+            enemyProjectiles.release(i);
         }
     }
 }
@@ -395,9 +468,9 @@ void EnemyManager::drawBullets(Window& win, float camX, float camY)
     const int W = (int)win.getWidth();
     const int H = (int)win.getHeight();
 
-    for (int i = 0; i < BULLET_MAX; ++i)
+    for (int k = 0; k < enemyProjectiles.liveCount(); ++k)
     {
-        if (!enemyProjectiles[i].alive) continue;
+        const int i = enemyProjectiles.liveAt(k);
 
         int sx = (int)(enemyProjectiles[i].x - camX);
         int sy = (int)(enemyProjectiles[i].y - camY);
@@ -410,6 +483,7 @@ void EnemyManager::drawBullets(Window& win, float camX, float camY)
         int y0 = sy < 0 ? 0 : sy;
         int x1 = sx + bw; if (x1 > W) x1 = W;
         int y1 = sy + bh; if (y1 > H) y1 = H;
+        markDirty(win, x0, y0, x1 - x0, y1 - y0);
 
         for (int y = y0; y < y1; ++y)
             for (int x = x0; x < x1; ++x)
@@ -417,25 +491,31 @@ void EnemyManager::drawBullets(Window& win, float camX, float camY)
     }
 }
 
+void EnemyManager::recordBullets(FrameCommands& out, float camX, float camY) const
+{
+    for (int k = 0; k < enemyProjectiles.liveCount(); ++k) {
+        const EnemyProjectile& b = enemyProjectiles[enemyProjectiles.liveAt(k)];
+        out.fillRect((int)(b.x - camX), (int)(b.y - camY), b.h, b.h, 255, 40, 40);
+    }
+}
+
 /* Player projectiles ----------------------------------------------------------
- * Spawn into first free slot; drop if saturated (could upgrade to ring buffer).
+ * Pop a slot off the free list; drop (and count) if saturated.
  * ---------------------------------------------------------------------------*/
 void EnemyManager::spawnHeroBullet(float sx, float sy, float dirx, float diry, float speed, float ttl)
 {
-    for (int i = 0; i < kPlayerProjectileCapacity; ++i) {
-        if (!playerProjectiles[i].alive) {
-            playerProjectiles[i].spawn(sx, sy, dirx, diry, speed, ttl);
-            return;
-        }
-    }
-    // pool full -> drop; alternative: overwrite oldest
+    const int i = playerProjectiles.acquire();
+    if (i < 0) return;   // pool full -> drop
+    playerProjectiles[i].spawn(sx, sy, dirx, diry, speed, ttl);
 }
 
 void EnemyManager::updateHeroBullets(float dt)
 {
-    for (int i = 0; i < kPlayerProjectileCapacity; ++i)
-        if (playerProjectiles[i].alive)
-            playerProjectiles[i].update(dt);
+    for (int k = playerProjectiles.liveCount() - 1; k >= 0; --k) {
+        const int i = playerProjectiles.liveAt(k);
+        playerProjectiles[i].update(dt);
+        if (!playerProjectiles[i].alive) playerProjectiles.release(i);
+    }
 }
 
 /* Draw player bullets ---------------------------------------------------------
@@ -446,9 +526,8 @@ void EnemyManager::drawHeroBullets(Window& win, float camX, float camY)
     const int W = (int)win.getWidth();
     const int H = (int)win.getHeight();
 
-    for (int i = 0; i < kPlayerProjectileCapacity; ++i) {
-        const PlayerProjectile& b = playerProjectiles[i];
-        if (!b.alive) continue;
+    for (int k = 0; k < playerProjectiles.liveCount(); ++k) {
+        const PlayerProjectile& b = playerProjectiles[playerProjectiles.liveAt(k)];
 
         int sx = (int)(b.x - camX);
         int sy = (int)(b.y - camY);
@@ -458,6 +537,7 @@ void EnemyManager::drawHeroBullets(Window& win, float camX, float camY)
         int y0 = sy < 0 ? 0 : sy;
         int x1 = sx + b.w; if (x1 > W) x1 = W;
         int y1 = sy + b.h; if (y1 > H) y1 = H;
+        markDirty(win, x0, y0, x1 - x0, y1 - y0);
 
         for (int y = y0; y < y1; ++y)
             for (int x = x0; x < x1; ++x)
@@ -465,71 +545,154 @@ void EnemyManager::drawHeroBullets(Window& win, float camX, float camY)
     }
 }
 
+void EnemyManager::recordHeroBullets(FrameCommands& out, float camX, float camY) const
+{
+    for (int k = 0; k < playerProjectiles.liveCount(); ++k) {
+        const PlayerProjectile& b = playerProjectiles[playerProjectiles.liveAt(k)];
+        out.fillRect((int)(b.x - camX), (int)(b.y - camY), b.w, b.h, b.r, b.g, b.b);
+    }
+}
+
 /* Collision: player bullets vs NPCs ------------------------------------------
- * On hit: consume the projectile, apply its damage to the NPC, kill on <= 0.
- * Returns number of kills this frame (useful for scoring).
+ * Bullets resolve in slot order and each hits the overlapping NPC with the
+ * lowest slot (one NPC per bullet), the order the fixed-array scan used;
+ * the pools' live lists are reordered by every release, so they are sorted
+ * into hitBullets / npcSlots first. On hit: consume the projectile, apply
+ * its damage to the NPC, kill on <= 0. Returns number of kills this frame
+ * (useful for scoring).
+ *
+ * Broadphase: NPCs do not move during the pass, so npcGrid is built at most
+ * once (cells sized to the largest NPC) and each bullet only tests the NPCs
+ * bucketed near it, keeping the lowest live slot among them.
  * ---------------------------------------------------------------------------*/
 int EnemyManager::checkNPCHit()
 {
     int kills = 0;
+    const int liveNPCs = enemies.liveCount();
+    if (liveNPCs == 0) return 0;
+
+    const bool grid = useHitGrid && playerProjectiles.liveCount() * liveNPCs >= kHitGridMinPairs;
+    if (grid) ensureNPCGrid();
+    else {
+        npcSlots.assign(enemies.liveSlots(), enemies.liveSlots() + liveNPCs);
+        std::sort(npcSlots.begin(), npcSlots.end());
+    }
+    hitBullets.assign(playerProjectiles.liveSlots(), playerProjectiles.liveSlots() + playerProjectiles.liveCount());
+    std::sort(hitBullets.begin(), hitBullets.end());
 
-    for (int bi = 0; bi < kPlayerProjectileCapacity; ++bi) {
+    for (const int bi : hitBullets) {
         PlayerProjectile& b = playerProjectiles[bi];
-        if (!b.alive) continue;
 
-        for (int i = 0; i < MAX; ++i) {
-            NPC& n = enemies[i];
-            if (!n.alive) continue;
+        int target = INT_MAX;
+        if (grid) {
+            npcGrid.forEachNear(b.x, b.y, b.x + b.w, b.y + b.h, [&](int i) {
+                if (i >= target || !enemies.isAlive(i)) return;   // dead once killed this pass
+                if (aabbOverlap(b.x, b.y, b.w, b.h, enemies.x[i], enemies.y[i], enemies.w[i], enemies.h[i]))
+                    target = i;
+            });
+        }
+        else {
+            for (const int i : npcSlots) {
+                if (!enemies.isAlive(i)) continue;
+                if (aabbOverlap(b.x, b.y, b.w, b.h, enemies.x[i], enemies.y[i], enemies.w[i], enemies.h[i]))
+                    { target = i; break; }
+            }
+        }
+        if (target == INT_MAX) continue;
 
-            if (aabbOverlap(b.x, b.y, b.w, b.h, n.x, n.y, n.w, n.h)) {
-                b.alive = false;
+        b.alive = false;
+        playerProjectiles.release(bi);
 
-                if (n.hp > 0) {
-                    n.hp -= b.damage;        // honor per-projectile damage
-                    if (n.hp <= 0) { n.kill(); ++kills; }
-                }
-                else {
-                    // If HP is not configured for this level, allow forced kill
-                    n.kill(); ++kills;
-                }
-                break; // next projectile
-            }
+        int& hp = enemies.hp[target];
+        if (hp > 0) {
+            hp -= b.damage;          // honor per-projectile damage
+            if (hp <= 0) { enemies.kill(target); ++kills; }
+        }
+        else {
+            // If HP is not configured for this level, allow forced kill
+            enemies.kill(target); ++kills;
         }
     }
     return kills;
 }
 
-/* AOE selection: top-N by HP --------------------------------------------------
- * Pick the N highest-HP living targets (no repeats), then fire magenta AOE shots
- * from the hero center toward each target. Returns the number of shots emitted.
+/* Target selection ------------------------------------------------------------
+ * Score every live NPC (higher = better), keep the best n in a heap whose
+ * top is the worst kept, then sort the survivors best first. Equal scores
+ * rank by slot, so HighestHP picks what the old repeated "highest
+ * remaining HP" slot scans picked, in the same order.
+ * ---------------------------------------------------------------------------*/
+int EnemyManager::selectTargets(int n, TargetPolicy policy, float cx, float cy, std::vector<int>& out) const
+{
+    out.clear();
+    const int live = enemies.liveCount();
+    if (n <= 0 || live == 0) return 0;
+    if (n > live) n = live;
+
+    auto better = [](const Target& a, const Target& b) {
+        return a.score > b.score || (a.score == b.score && a.slot < b.slot);
+    };
+    targetHeap.clear();
+    if (policy == TargetPolicy::Densest) ensureNPCGrid();
+    const float r2 = kClusterRadius * kClusterRadius;
+    for (int k = 0; k < live; ++k) {
+        const int i = enemies.liveAt(k);
+        const float ncx = enemies.x[i] + enemies.w[i] * 0.5f;
+        const float ncy = enemies.y[i] + enemies.h[i] * 0.5f;
+        const int hp = enemies.hp[i] > 0 ? enemies.hp[i] : 1;   // fallback when hp uninitialized
+
+        float score = 0.f;
+        switch (policy) {
+        case TargetPolicy::HighestHP: score = (float)hp; break;
+        case TargetPolicy::LowestHP:  score = -(float)hp; break;
+        case TargetPolicy::Nearest:   score = -((ncx - cx) * (ncx - cx) + (ncy - cy) * (ncy - cy)); break;
+        case TargetPolicy::Densest: {
+            // Same count as queryRadius(ncx, ncy, kClusterRadius), without the list
+            int near = 0;
+            npcGrid.forEachNear(ncx - kClusterRadius, ncy - kClusterRadius, ncx + kClusterRadius, ncy + kClusterRadius, [&](int j) {
+                const float dx = enemies.x[j] + enemies.w[j] * 0.5f - ncx;
+                const float dy = enemies.y[j] + enemies.h[j] * 0.5f - ncy;
+                near += enemies.isAlive(j) && dx * dx + dy * dy <= r2;
+            });
+            score = (float)near;
+            break;
+        }
+        }
+
+        const Target t{ score, i };
+        if ((int)targetHeap.size() < n) {
+            targetHeap.push_back(t);
+            std::push_heap(targetHeap.begin(), targetHeap.end(), better);
+        }
+        else if (better(t, targetHeap.front())) {
+            std::pop_heap(targetHeap.begin(), targetHeap.end(), better);
+            targetHeap.back() = t;
+            std::push_heap(targetHeap.begin(), targetHeap.end(), better);
+        }
+    }
+
+    std::sort(targetHeap.begin(), targetHeap.end(), better);
+    for (const Target& t : targetHeap) out.push_back(t.slot);
+    return (int)out.size();
+}
+
+/* AOE strike --------------------------------------------------------------------
+ * Pick the top-N living targets under aoePolicy (no repeats), then fire
+ * magenta AOE shots from the hero center toward each target. Returns the
+ * number of shots emitted.
  * ---------------------------------------------------------------------------*/
 int EnemyManager::aoeStrikeTopN(int N, int damage, float heroCx, float heroCy)
 {
     if (N <= 0 || damage <= 0) return 0;
 
-    bool picked[MAX];           // mark targets already chosen
-    for (int i = 0; i < MAX; ++i) picked[i] = false;
+    std::vector<int>& targets = queryScratch;
+    selectTargets(N, aoePolicy, heroCx, heroCy, targets);
 
     int fired = 0;
-
-    for (int k = 0; k < N; ++k)
+    for (int i : targets)
     {
-        int bestIdx = -1;
-        int bestHP = -1;
-
-        // Highest-HP policy biases AOE to priority targets
-        for (int i = 0; i < MAX; ++i)
-        {
-            if (!enemies[i].alive || picked[i]) continue;
-            int hp = (enemies[i].hp > 0 ? enemies[i].hp : 1); // fallback when hp uninitialized
-            if (hp > bestHP) { bestHP = hp; bestIdx = i; }
-        }
-
-        if (bestIdx < 0) break;      // nothing left to target
-        picked[bestIdx] = true;
-
-        float tx = enemies[bestIdx].x + enemies[bestIdx].w * 0.5f;
-        float ty = enemies[bestIdx].y + enemies[bestIdx].h * 0.5f;
+        float tx = enemies.x[i] + enemies.w[i] * 0.5f;
+        float ty = enemies.y[i] + enemies.h[i] * 0.5f;
 
         // AOE projectiles: faster, shorter TTL, distinct tint
         spawnAoeBullet(heroCx, heroCy, tx, ty, /*speed*/520.f, /*ttl*/0.9f, damage);
@@ -545,24 +708,21 @@ int EnemyManager::aoeStrikeTopN(int N, int damage, float heroCx, float heroCy)
  * ---------------------------------------------------------------------------*/
 void EnemyManager::spawnAoeBullet(float sx, float sy, float tx, float ty, float speed, float ttl, int dmg)
 {
-    for (int i = 0; i < kPlayerProjectileCapacity; ++i) {
-        if (!playerProjectiles[i].alive) {
-            float dx = tx - sx, dy = ty - sy;
-            float len = std::sqrt(dx * dx + dy * dy);
-            if (len < 1e-6f) { dx = 1.f; dy = 0.f; len = 1.f; }
-            dx /= len; dy /= len;
-
-            playerProjectiles[i].spawn(sx, sy, dx, dy, speed, ttl);
-
-            // Visual identity for AOE rounds
-            playerProjectiles[i].r = 255;
-            playerProjectiles[i].g = 50;
-            playerProjectiles[i].b = 200;
-
-            playerProjectiles[i].damage = (dmg > 0 ? dmg : 1);
-            playerProjectiles[i].isAOE = true;
-            return;
-        }
-    }
-    // Pool saturated: skip emission
+    const int i = playerProjectiles.acquire();
+    if (i < 0) return;   // Pool saturated: skip emission
+
+    float dx = tx - sx, dy = ty - sy;
+    float len = std::sqrt(dx * dx + dy * dy);
+    if (len < 1e-6f) { dx = 1.f; dy = 0.f; len = 1.f; }
+    dx /= len; dy /= len;
+
+    playerProjectiles[i].spawn(sx, sy, dx, dy, speed, ttl);
+
+    // Visual identity for AOE rounds
+    playerProjectiles[i].r = 255;
+    playerProjectiles[i].g = 50;
+    playerProjectiles[i].b = 200;
+
+    playerProjectiles[i].damage = (dmg > 0 ? dmg : 1);
+    playerProjectiles[i].isAOE = true;
 }
@@ -2,6 +2,10 @@
 #include "GamesEngineeringBase.h"
 #include "TileMap.h"  
 #include "NPC.h"
+#include "NPCStore.h"
+#include "FlowField.h"
+#include "Pool.h"
+#include "SpatialGrid.h"
 using namespace GamesEngineeringBase;
 
 class Player;
@@ -69,43 +73,76 @@ struct PlayerProjectile
 };
 
 
+// How AOE strikes rank their targets (best first); ties go to the lower
+// NPC slot
+enum class TargetPolicy
+{
+    HighestHP,      // most HP first (default)
+    LowestHP,       // finish off weak NPCs
+    Nearest,        // closest center to the strike origin
+    Densest,        // most neighbours within EnemyManager::kClusterRadius
+};
+
+
 /**********************************  EnemyManager  **********************************
  * Owns:
- *   - NPC pool (MAX = 128)
- *   - Enemy projectile pool (BULLET_MAX)
- *   - Player projectile pool (kPlayerProjectileCapacity) for simple weapon logic
+ *   - NPC pool (NPCStore columns, MAX = 128 by default)
+ *   - Enemy projectile pool (BULLET_MAX = 256 by default)
+ *   - Player projectile pool (kPlayerProjectileCapacity = 256 by default)
+ *   All three are free-list pools (Pool.h) sized by setCapacity; spawning
+ *   into a full pool is dropped and counted (npcDrops/bulletDrops/...).
  *
  * Spawning:
  *   - frequency ramps up over time with a lower bound
  *   - in infinite worlds, positions are chosen around the camera ring
  *
  * Updates:
- *   - steering and movement for chasers
+ *   - steering and movement for chasers, along a shared FlowField around
+ *     the player so they walk around water instead of into it
  *   - turret cooldowns and firing
  *   - bullet integration and culling
  *
+ * Queries:
+ *   - nearest-k / radius / rect over live NPCs from a uniform grid
+ *     (SpatialGrid) rebuilt lazily once NPCs move; hit tests, hero
+ *     push-out and targeting share it
+ *
  * Rendering:
  *   - draws NPCs and both projectile sets, clipped to viewport
  *************************************************************************************/
 class EnemyManager
 {
 public:
-    static const int MAX = 128;
-    static const int BULLET_MAX = 256;
+    static const int MAX = 128;     // default NPC capacity
+    static const int BULLET_MAX = 256;                 // default enemy bullet capacity
+    static const int kPlayerProjectileCapacity = 256;  // default hero bullet capacity
 
     bool isInfiniteWorld = false;   // toggled by save/load and mode switches
 
 private:
-    NPC enemies[MAX];
+    NPCStore enemies;
+    int enemyCapacity = MAX;
+    int bulletCapacity = BULLET_MAX;
+    int heroBulletCapacity = kPlayerProjectileCapacity;
     TileMap* tileMap = nullptr;
+    FlowField flow;                 // paths to the player, shared by every NPC
+    mutable SpatialGrid npcGrid;    // NPC index behind the queries and hit tests
+    mutable bool npcGridValid = false;
+    mutable std::vector<int> queryScratch;
+    TargetPolicy aoePolicy = TargetPolicy::HighestHP;
+    bool useHitGrid = true;         // checkNPCHit broadphase (off = full scan)
+
+    struct Target { float score; int slot; };
+    mutable std::vector<Target> targetHeap;     // selectTargets scratch
+    std::vector<int> hitBullets;                // checkNPCHit scratch, slot order
+    std::vector<int> npcSlots;                  // Live NPC slots in ascending order (hit/collision scratch)
 
     float elapsedSeconds = 0.f;   // global clock for difficulty ramp
     float spawnAccumulator = 0.f;   // scheduler accumulator
 
     // ----------------- projectile pools -----------------
-    EnemyProjectile  enemyProjectiles[BULLET_MAX];
-    static const int kPlayerProjectileCapacity = 256;
-    PlayerProjectile playerProjectiles[kPlayerProjectileCapacity];
+    Pool<EnemyProjectile>  enemyProjectiles;
+    Pool<PlayerProjectile> playerProjectiles;
 
     // cached world size in pixels; used for clamping and spawn bounds
     int worldWidthPx = 0, worldHeightPx = 0;
@@ -119,8 +156,10 @@ private:
     static float frand01() { return (float)rand() / (float)RAND_MAX; }
     static float fclamp(float v, float a, float b) { return (v < a) ? a : ((v > b) ? b : v); }
 
-    // pool slot acquisition; -1 when full
-    int allocIndex();
+    // Rebuilds npcGrid over the live NPCs if they moved or spawned since
+    // the last build (cells sized to the largest NPC). Kills do not
+    // invalidate it: queries skip dead slots.
+    void ensureNPCGrid() const;
 
     // compute world size in pixels from tile dimensions
     void mapPixelSize(int& outW, int& outH);
@@ -128,9 +167,6 @@ private:
     // spawn a single NPC near the camera ring; px,py are player center to set facing
     void spawnOne(float camX, float camY, int viewW, int viewH, float px, float py);
 
-    // enemy projectile slot; -1 when none available
-    int allocBullet();
-
     // direction from NPC center (A) to player center (B)
     static inline void dirFromAToB(float ax, float ay, float aw, float ah,
         float bx, float by, float bw, float bh,
@@ -152,6 +188,19 @@ public:
     // Initialize with a tile map. Caches pixel dimensions and clears pools.
     void init(TileMap* m);
 
+    // Pool sizes; take effect (and clear the pools) at the next init()
+    void setCapacity(int npcs, int bullets = BULLET_MAX, int heroBullets = kPlayerProjectileCapacity)
+    {
+        enemyCapacity = npcs > 0 ? npcs : 1;
+        bulletCapacity = bullets > 0 ? bullets : 1;
+        heroBulletCapacity = heroBullets > 0 ? heroBullets : 1;
+    }
+
+    // Spawns dropped because the matching pool was full (since init)
+    int npcDrops() const { return enemies.drops(); }
+    int bulletDrops() const { return enemyProjectiles.drops(); }
+    int heroBulletDrops() const { return playerProjectiles.drops(); }
+
     // Public AABB convenience for other modules (consistent signature style)
     static inline bool aabbIntersect(float ax, float ay, float aw, float ah,
         float bx, float by, float bw, float bh)
@@ -168,14 +217,35 @@ public:
     // Draw all NPCs relative to camera
     void drawAll(Window& win, float camX, float camY);
 
+    // Record NPCs and both projectile sets for the banded renderer (same
+    // order and colors as drawAll/drawBullets/drawHeroBullets)
+    void recordAll(FrameCommands& out, float camX, float camY) const;
+    void recordBullets(FrameCommands& out, float camX, float camY) const;
+    void recordHeroBullets(FrameCommands& out, float camX, float camY) const;
+
     // Player vs all live NPCs: resolve collision with minimal separation
     void checkPlayerCollision(Player& hero);
 
-    // Optional read-only/raw access for external queries
-    const NPC* getArray() const { return enemies; }
-    NPC* getArray() { return enemies; }
-
-    // Linear nearest-neighbour: returns center of closest living NPC to (px,py)
+    // Shared path field (e.g. to change its radius or inspect distances)
+    FlowField& getFlowField() { return flow; }
+
+    // Column access for external queries (get()/put() for whole records).
+    // The mutable overload drops the query index; do not hold the
+    // reference across queries.
+    const NPCStore& getStore() const { return enemies; }
+    NPCStore& getStore() { npcGridValid = false; return enemies; }
+
+    // Spatial queries over live NPCs, answered from npcGrid (one rebuild
+    // per frame serves them all). Results are slots into getStore(); out is
+    // cleared first and the count is returned.
+    //   - queryNearest: up to k NPCs by center distance, nearest first
+    //   - queryRadius:  NPCs whose center lies within r of (cx, cy)
+    //   - queryRect:    NPCs whose box overlaps [x0, x1) x [y0, y1)
+    int queryNearest(float px, float py, int k, std::vector<int>& out) const;
+    int queryRadius(float cx, float cy, float r, std::vector<int>& out) const;
+    int queryRect(float x0, float y0, float x1, float y1, std::vector<int>& out) const;
+
+    // Nearest-neighbour: returns center of closest living NPC to (px,py)
     // (px,py) is typically the hero center; outputs (tx,ty) as NPC center
     bool findNearestAlive(float px, float py, float& tx, float& ty) const;
 
@@ -197,13 +267,28 @@ public:
     // Render player projectiles; mirror enemy bullet drawing path to keep behavior consistent
     void drawHeroBullets(Window& win, float camX, float camY);
 
-    // Collision: player projectiles vs NPCs; apply damage/kill and return kill count
+    // Collision: player projectiles vs NPCs; apply damage/kill and return kill count.
+    // Bullets go in slot order, each hitting the overlapping NPC with the
+    // lowest slot; past kHitGridMinPairs bullet x NPC pairs the candidates
+    // come from npcGrid instead of a full scan, with the same results.
+    // setHitGridEnabled(false) forces the full scan (benchmarks).
+    static const int kHitGridMinPairs = 512;
     int checkNPCHit();
+    void setHitGridEnabled(bool v) { useHitGrid = v; }
+
+    // Best n live NPCs under a policy, best first, as slots into
+    // getStore(). One pass over the live list with a bounded heap:
+    // O(M log n) for M NPCs. (cx, cy) is the origin for Nearest.
+    static constexpr float kClusterRadius = 96.f;
+    int selectTargets(int n, TargetPolicy policy, float cx, float cy, std::vector<int>& out) const;
 
     // AOE support:
-    //  - aoeStrikeTopN: damage top-N nearest targets around (heroCx, heroCy)
+    //  - aoeStrikeTopN: fire at the top-N targets under the AOE policy
+    //    (setAoePolicy, highest HP by default) from (heroCx, heroCy)
     //  - spawnAoeBullet: helper to visualize or seed homing-like arcs
     int  aoeStrikeTopN(int N, int damage, float heroCx, float heroCy);
+    void setAoePolicy(TargetPolicy p) { aoePolicy = p; }
+    TargetPolicy getAoePolicy() const { return aoePolicy; }
     void spawnAoeBullet(float sx, float sy, float tx, float ty, float speed, float ttl, int dmg);
 
     // Toggle infinite world mode; affects spawn logic and positional wrapping elsewhere
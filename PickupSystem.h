@@ -1,7 +1,12 @@
 ﻿#pragma once
 #include "GamesEngineeringBase.h"
+#include "DirtyRects.h"
+#include "FrameCommands.h"
 #include "TileMap.h"
 #include "Player.h"
+#include "Pool.h"
+#include "SpatialGrid.h"
+#include <vector>
 
 using namespace GamesEngineeringBase;
 
@@ -9,7 +14,9 @@ using namespace GamesEngineeringBase;
  * Randomly spawns collectible “buff fruits” on non-blocking tiles.
  * Player gains permanent bonuses when touching a fruit.
  *
- *  - Uses a fixed-size pool instead of STL containers.
+ *  - Uses a free-list pool (Pool.h), MAX slots unless setCapacity.
+ *  - Collection asks a SpatialGrid for the pickups near the hero,
+ *    rebuilt only after a spawn.
  *  - Respawn interval varies between 7–11 seconds.
  *  - Spawns at the center of a random non-blocking tile.
  *  - On pickup: increases fire rate and AOE count,
@@ -30,10 +37,15 @@ struct Pickup {
 
 class PickupSystem {
 public:
-    static const int MAX = 32;      // Fixed pool size
+    static const int MAX = 32;      // Default pool size
     bool infiniteWorld = false;     // Infinite map mode flag
 private:
-    Pickup items[MAX];
+    Pool<Pickup> items;
+    int capacity = MAX;
+    SpatialGrid grid;               // Live pickups by position
+    bool gridValid = false;
+    std::vector<float> gridX, gridY;
+    std::vector<int> nearHero;      // Collection scratch
     TileMap* map = nullptr;
     float spawnTimer = 0.f;         // Time accumulator for spawn logic
     float nextInterval = 8.0f;      // Time until next spawn
@@ -45,17 +57,29 @@ private:
         return !(ax + aw <= bx || bx + bw <= ax || ay + ah <= by || by + bh <= ay);
     }
 
-    // Finds an unused pickup slot
-    int allocIndex() {
-        for (int i = 0; i < MAX; ++i) if (!items[i].alive) return i;
-        return -1;
+    // Rebuilds the grid after spawns; collected pickups stay in it until
+    // then and are skipped by their alive flag
+    void ensureGrid() {
+        if (gridValid) return;
+        gridX.resize((size_t)items.capacity());
+        gridY.resize((size_t)items.capacity());
+        int largest = 1;
+        for (int k = 0; k < items.liveCount(); ++k) {
+            const Pickup& p = items[items.liveAt(k)];
+            gridX[items.liveAt(k)] = p.x;
+            gridY[items.liveAt(k)] = p.y;
+            if (p.w > largest) largest = p.w;
+            if (p.h > largest) largest = p.h;
+        }
+        grid.build(gridX.data(), gridY.data(), items.liveSlots(), items.liveCount(), (float)largest);
+        gridValid = true;
     }
 
     // Spawns one pickup at a random non-blocking tile
     void spawnOne() {
         if (!map) return;
-        int idx = allocIndex();
-        if (idx < 0) return;
+        int idx = items.acquire();
+        if (idx < 0) return;    // Pool full (counted in drops())
 
         const int mw = map->getWidth();
         const int mh = map->getHeight();
@@ -72,10 +96,12 @@ private:
                 items[idx].x = cx - items[idx].w * 0.5f;
                 items[idx].y = cy - items[idx].h * 0.5f;
                 items[idx].alive = true;
+                gridValid = false;
                 return;
             }
         }
         // No valid tile found; skip this cycle
+        items.release(idx);
     }
 
     // Resets next spawn interval between 7–11 seconds
@@ -88,11 +114,18 @@ public:
     void init(TileMap* m) {
         map = m;
         spawnTimer = 0.f;
-        for (int i = 0; i < MAX; ++i) items[i].alive = false;
+        items.reset(capacity);
+        gridValid = false;
         srand(24680);
         resetInterval();
     }
 
+    // Pool size; takes effect (and clears the pool) at the next init()
+    void setCapacity(int n) { capacity = n > 0 ? n : 1; }
+
+    // Spawns dropped because the pool was full (since init)
+    int drops() const { return items.drops(); }
+
     // Periodically spawns a pickup based on accumulated delta time
     void trySpawn(float dt, float camX, float camY) {
         spawnTimer += dt;
@@ -107,8 +140,8 @@ public:
     // Spawns near the camera position for infinite maps
     void spawnOneAroundCamera(float camX, float camY) {
         if (!map) return;
-        int idx = allocIndex();
-        if (idx < 0) return;
+        int idx = items.acquire();
+        if (idx < 0) return;    // Pool full (counted in drops())
 
         const int tw = map->getTileW();
         const int th = map->getTileH();
@@ -125,9 +158,11 @@ public:
                 items[idx].x = cx - items[idx].w * 0.5f;
                 items[idx].y = cy - items[idx].h * 0.5f;
                 items[idx].alive = true;
+                gridValid = false;
                 return;
             }
         }
+        items.release(idx);
     }
 
     // Checks for collisions between player and active pickups.
@@ -143,8 +178,11 @@ public:
         int   hw = hero.getHitboxW();
         int   hh = hero.getHitboxH();
 
-        for (int i = 0; i < MAX; ++i) {
-            if (!items[i].alive) continue;
+        ensureGrid();
+        nearHero.clear();
+        grid.forEachNear(hx, hy, hx + hw, hy + hh, [&](int i) { if (items[i].alive) nearHero.push_back(i); });
+
+        for (int i : nearHero) {
             if (aabbOverlap(items[i].getHitboxX(), items[i].getHitboxY(),
                 items[i].getHitboxW(), items[i].getHitboxH(),
                 hx, hy, hw, hh)) {
@@ -163,6 +201,7 @@ public:
                 hero.setAOEParams(n, 2, acd);
 
                 items[i].alive = false;
+                items.release(i);
 
                 printf("[BUFF] Fruit picked: shootCD=%.2fs, AOE N=%d, AOE CD=%.2fs\n",
                     shoot, n, acd);
@@ -170,13 +209,24 @@ public:
         }
     }
 
+    // Records the same rectangles and highlight pixels as draw()
+    void record(FrameCommands& out, float camX, float camY) const {
+        for (int k = 0; k < items.liveCount(); ++k) {
+            const int i = items.liveAt(k);
+            int sx = (int)(items[i].x - camX);
+            int sy = (int)(items[i].y - camY);
+            out.fillRect(sx, sy, items[i].w, items[i].h, items[i].r, items[i].g, items[i].b);
+            out.fillRect(sx + items[i].w / 2, sy + items[i].h / 2, 1, 1, 255, 255, 255);
+        }
+    }
+
     // Renders all visible pickups in the current camera view
     void draw(Window& win, float camX, float camY) {
         const int W = (int)win.getWidth();
         const int H = (int)win.getHeight();
 
-        for (int i = 0; i < MAX; ++i) {
-            if (!items[i].alive) continue;
+        for (int k = 0; k < items.liveCount(); ++k) {
+            const int i = items.liveAt(k);
 
             int sx = (int)(items[i].x - camX);
             int sy = (int)(items[i].y - camY);
@@ -189,6 +239,7 @@ public:
             int y0 = sy < 0 ? 0 : sy;
             int x1 = sx + w; if (x1 > W) x1 = W;
             int y1 = sy + h; if (y1 > H) y1 = H;
+            markDirty(win, x0, y0, x1 - x0, y1 - y0);
 
             // Draw colored rectangle
             for (int y = y0; y < y1; ++y) {
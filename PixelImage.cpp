@@ -0,0 +1,159 @@
+﻿#include "PixelImage.h"
+#include "blit.h"
+#include "blit32.h"
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+/* Normalization ---------------------------------------------------------------
+ * Converts row by row into the padded RGBA layout, classifying each row
+ * (and filling the mask) in the same pass.
+ * ---------------------------------------------------------------------------*/
+bool PixelImage::assign(const Image& img, int sx, int sy, int w, int h, bool withMask)
+{
+    clear();
+    if (!img.data || (img.channels != 3 && img.channels != 4)) return false;
+    if (sx < 0) { w += sx; sx = 0; }
+    if (sy < 0) { h += sy; sy = 0; }
+    if (sx + w > (int)img.width)  w = (int)img.width - sx;
+    if (sy + h > (int)img.height) h = (int)img.height - sy;
+    if (w <= 0 || h <= 0) return false;
+
+    width = w; height = h;
+    stride = (w * 4 + kRowAlignBytes - 1) & ~(kRowAlignBytes - 1);
+    storage.assign((size_t)stride * h + kRowAlignBytes, 0);
+    const size_t offset = (size_t)((kRowAlignBytes - (uintptr_t)storage.data() % kRowAlignBytes) % kRowAlignBytes);
+    pixels = storage.data() + offset;
+    rowCover.resize(h);
+    covers = rowCover.data();
+    if (withMask) {
+        maskWords = (w + 63) / 64;
+        mask.assign((size_t)maskWords * h, 0);
+    }
+
+    const int ch = (int)img.channels;
+    bool anySolid = false, anyClear = false;
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* s = img.data + ((size_t)(sy + y) * img.width + sx) * ch;
+        unsigned char* d = storage.data() + offset + (size_t)y * stride;
+        int solid = 0;
+        if (ch == 3) {
+            for (int x = 0; x < w; ++x, s += 3, d += 4) {
+                d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; d[3] = 255;
+            }
+            solid = w;
+            if (withMask)
+                for (int x = 0; x < w; ++x) mask[(size_t)y * maskWords + (x >> 6)] |= 1ull << (x & 63);
+        }
+        else {
+            memcpy(d, s, (size_t)w * 4);
+            for (int x = 0; x < w; ++x) {
+                if (d[x * 4 + 3] < kBlitAlphaCutoff) continue;
+                ++solid;
+                if (withMask) mask[(size_t)y * maskWords + (x >> 6)] |= 1ull << (x & 63);
+            }
+        }
+        rowCover[y] = (unsigned char)(solid == w ? Opaque : solid == 0 ? Transparent : Mixed);
+        anySolid = anySolid || solid > 0;
+        anyClear = anyClear || solid < w;
+    }
+    cover = anySolid ? (anyClear ? Mixed : Opaque) : Transparent;
+    return true;
+}
+
+bool PixelImage::view(const unsigned char* rgba, int w, int h, int rowStride, const unsigned char* rowCoverage)
+{
+    clear();
+    if (!rgba || !rowCoverage || w <= 0 || h <= 0 || rowStride < w * 4) return false;
+    bool anySolid = false, anyClear = false;
+    for (int y = 0; y < h; ++y) {
+        if (rowCoverage[y] > Mixed) return false;
+        anySolid = anySolid || rowCoverage[y] != Transparent;
+        anyClear = anyClear || rowCoverage[y] != Opaque;
+    }
+    width = w; height = h; stride = rowStride;
+    pixels = rgba;
+    covers = rowCoverage;
+    cover = anySolid ? (anyClear ? Mixed : Opaque) : Transparent;
+    return true;
+}
+
+void PixelImage::clear()
+{
+    width = height = stride = 0;
+    pixels = covers = nullptr;
+    cover = Transparent;
+    maskWords = 0;
+    storage.clear();
+    rowCover.clear();
+    mask.clear();
+}
+
+/* Blitting --------------------------------------------------------------------
+ * Clipping as blitSubImage() on an Image; then each visible row (row pointer
+ * plus first pixel, so one template serves both targets) goes to the
+ * kernel its coverage allows: plain RGBX -> RGB24 pack (or a 32-bit span
+ * copy), the alpha-tested row kernel, or nothing.
+ * ---------------------------------------------------------------------------*/
+template <class S, class CopyRow, class TestRow>
+static void blitPixelsT(const S& dst, const PixelImage& img,
+    int srcX, int srcY, int subW, int subH, int dstX, int dstY,
+    CopyRow copyRow, TestRow testRow)
+{
+    const int W = dst.width;
+    const int H = dst.height;
+    if (!img.valid() || img.coverage() == PixelImage::Transparent) return;
+
+    if (srcX < 0) { int d = -srcX; srcX = 0; subW -= d; dstX += d; }
+    if (srcY < 0) { int d = -srcY; srcY = 0; subH -= d; dstY += d; }
+    if (srcX + subW > img.getWidth())  subW = img.getWidth() - srcX;
+    if (srcY + subH > img.getHeight()) subH = img.getHeight() - srcY;
+    if (subW <= 0 || subH <= 0) return;
+
+    int x0 = dstX, y0 = dstY;
+    int x1 = dstX + subW;
+    int y1 = dstY + subH;
+    if (x0 >= W || y0 >= H || x1 <= 0 || y1 <= 0) return;
+    if (x0 < 0) { int d = -x0; x0 = 0; srcX += d; }
+    if (y0 < 0) { int d = -y0; y0 = 0; srcY += d; }
+    if (x1 > W) x1 = W;
+    if (y1 > H) y1 = H;
+
+    const int drawW = x1 - x0, drawH = y1 - y0;
+    dst.markDirty(x0, y0, drawW, drawH);
+
+    const bool opaque = img.coverage() == PixelImage::Opaque;
+    for (int y = 0; y < drawH; ++y) {
+        const int sy = srcY + y;
+        const PixelImage::Coverage c = opaque ? PixelImage::Opaque : img.rowCoverage(sy);
+        if (c == PixelImage::Transparent) continue;
+        const unsigned char* sp = img.row(sy) + (size_t)srcX * 4;
+        if (c == PixelImage::Opaque) copyRow(dst.row(y0 + y), x0, sp, drawW);
+        else                         testRow(dst.row(y0 + y), x0, sp, drawW);
+    }
+}
+
+void blitSubImage(const Surface& dst, const PixelImage& img,
+    int srcX, int srcY, int subW, int subH, int dstX, int dstY)
+{
+    blitPixelsT(dst, img, srcX, srcY, subW, subH, dstX, dstY,
+        [](unsigned char* d, int x, const unsigned char* s, int n) { packRowRGBX(d + (size_t)x * 3, (const uint32_t*)s, n); },
+        [](unsigned char* d, int x, const unsigned char* s, int n) { blitRowRGBA(d + (size_t)x * 3, s, n); });
+}
+
+void blitImage(const Surface& dst, const PixelImage& img, int dstX, int dstY)
+{
+    blitSubImage(dst, img, 0, 0, img.getWidth(), img.getHeight(), dstX, dstY);
+}
+
+void blitSubImage(const Surface32& dst, const PixelImage& img,
+    int srcX, int srcY, int subW, int subH, int dstX, int dstY)
+{
+    blitPixelsT(dst, img, srcX, srcY, subW, subH, dstX, dstY,
+        [](uint32_t* d, int x, const unsigned char* s, int n) { copySpan32(d + x, (const uint32_t*)s, n); },
+        [](uint32_t* d, int x, const unsigned char* s, int n) { blitRowRGBA32(d + x, s, n); });
+}
+
+void blitImage(const Surface32& dst, const PixelImage& img, int dstX, int dstY)
+{
+    blitSubImage(dst, img, 0, 0, img.getWidth(), img.getHeight(), dstX, dstY);
+}
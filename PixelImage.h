@@ -0,0 +1,88 @@
+﻿#pragma once
+#include "Image.h"
+#include "Surface.h"
+#include "blit.h"
+#include <cstdint>
+#include <vector>
+
+/*******************************  PixelImage  **********************************
+ * Load-time normalized copy of an Image for repeated blitting.
+ *   - One layout for every source: RGBA8888 (3-channel sources get alpha
+ *     255), rows padded to kRowAlignBytes and 64-byte aligned, so row
+ *     kernels never branch on the channel count.
+ *   - Coverage is classified once, per image and per row, with the blitters'
+ *     alpha test (alpha >= kBlitAlphaCutoff): Opaque rows copy without a
+ *     test, Transparent rows are skipped, only Mixed rows test per pixel.
+ *     Output is pixel-identical to blitSubImage() on the source Image.
+ *   - Optionally keeps a 1-bit mask of the same test (pixel-exact hit
+ *     tests without touching the RGBA data).
+ *   - view() wraps pixels already in this layout (e.g. an AssetPack
+ *     mapping) without copying; the caller keeps that memory alive.
+ * Move-only: the row pointers must not outlive their buffer.
+ *******************************************************************************/
+class PixelImage
+{
+public:
+    enum Coverage : unsigned char { Transparent, Opaque, Mixed };
+    static const int kRowAlignBytes = 64;
+
+    PixelImage() = default;
+    PixelImage(PixelImage&&) = default;
+    PixelImage& operator=(PixelImage&&) = default;
+    PixelImage(const PixelImage&) = delete;
+    PixelImage& operator=(const PixelImage&) = delete;
+
+    // Normalizes the (sx, sy, w, h) region of `img` (clamped to the image).
+    // Returns false for an empty region or unsupported channel count.
+    bool assign(const GamesEngineeringBase::Image& img, int sx, int sy, int w, int h, bool withMask = false);
+    bool assign(const GamesEngineeringBase::Image& img, bool withMask = false)
+    {
+        return assign(img, 0, 0, (int)img.width, (int)img.height, withMask);
+    }
+    // Non-owning view of RGBA8888 rows `stride` bytes apart with their
+    // per-row coverage (h bytes, Coverage values); no mask
+    bool view(const unsigned char* rgba, int w, int h, int stride, const unsigned char* rowCoverage);
+    void clear();
+
+    int    getWidth()  const { return width; }
+    int    getHeight() const { return height; }
+    int    getStride() const { return stride; }        // Bytes between rows
+    bool   valid()     const { return width > 0 && height > 0; }
+    bool   isView()    const { return valid() && storage.empty(); }
+    size_t bytes()     const { return storage.size() + rowCover.size() + mask.size() * 8; }   // owned only
+
+    const unsigned char* row(int y) const { return pixels + (size_t)y * stride; }
+
+    Coverage coverage() const { return cover; }
+    Coverage rowCoverage(int y) const { return (Coverage)covers[y]; }
+
+    // 1-bit mask (bit x of the row = pixel passes the alpha test); empty
+    // unless assign() was asked for it
+    bool hasMask() const { return !mask.empty(); }
+    const uint64_t* maskRow(int y) const { return mask.data() + (size_t)y * maskWords; }
+    bool solidAt(int x, int y) const
+    {
+        if ((unsigned)x >= (unsigned)width || (unsigned)y >= (unsigned)height) return false;
+        if (hasMask()) return (maskRow(y)[x >> 6] >> (x & 63)) & 1;
+        return row(y)[x * 4 + 3] >= kBlitAlphaCutoff;
+    }
+
+private:
+    int width = 0, height = 0, stride = 0;
+    const unsigned char* pixels = nullptr; // First row: aligned in `storage`, or viewed
+    const unsigned char* covers = nullptr; // Coverage per row: `rowCover`, or viewed
+    Coverage cover = Transparent;
+    int maskWords = 0;                     // uint64_t per mask row
+    std::vector<unsigned char> storage;
+    std::vector<unsigned char> rowCover;   // Coverage per row
+    std::vector<uint64_t> mask;
+};
+
+// Same operations as the Image blitters in blit.h / blit32.h; the path is
+// picked per row from the stored coverage.
+void blitImage(const Surface& dst, const PixelImage& img, int dstX, int dstY);
+void blitSubImage(const Surface& dst, const PixelImage& img,
+    int srcX, int srcY, int subW, int subH, int dstX, int dstY);
+void blitImage(const Surface32& dst, const PixelImage& img, int dstX, int dstY);
+void blitSubImage(const Surface32& dst, const PixelImage& img,
+    int srcX, int srcY, int subW, int subH, int dstX, int dstY);
@@ -177,24 +177,16 @@ public:
                 int tx = rightPix / tw;
                 int topRow = (int)hy / th;
                 int botRow = (int)(hy + hh - 1) / th;
-                for (int ty = topRow; ty <= botRow; ++ty) {
-                    if (map->isBlockedAt(tx, ty)) {
-                        hx = (float)(tx * tw - hw); // stop left of the blocking tile
-                        break;
-                    }
-                }
+                if (map->anyBlockedInColumn(tx, topRow, botRow))
+                    hx = (float)(tx * tw - hw); // stop left of the blocking tile
             }
             else if (dx < 0.f) {
                 int leftPix = (int)hx;
                 int tx = leftPix / tw;
                 int topRow = (int)hy / th;
                 int botRow = (int)(hy + hh - 1) / th;
-                for (int ty = topRow; ty <= botRow; ++ty) {
-                    if (map->isBlockedAt(tx, ty)) {
-                        hx = (float)((tx + 1) * tw); // stop right of the blocking tile
-                        break;
-                    }
-                }
+                if (map->anyBlockedInColumn(tx, topRow, botRow))
+                    hx = (float)((tx + 1) * tw); // stop right of the blocking tile
             }
 
             // Vertical sweep: same idea on Y axis
@@ -203,23 +195,15 @@ public:
                 int ty = bottomPix / th;
                 int leftCol = (int)hx / tw;
                 int rightCol = (int)(hx + hw - 1) / tw;
-                for (int tx = leftCol; tx <= rightCol; ++tx) {
-                    if (map->isBlockedAt(tx, ty)) {
-                        hy = (float)(ty * th - hh); // stop above the blocking tile
-                        break;
-                    }
-                }
+                if (map->anyBlockedInRow(ty, leftCol, rightCol))
+                    hy = (float)(ty * th - hh); // stop above the blocking tile
             }
             else if (dy < 0.f) {
                 int topTile = (int)hy / th;
                 int leftCol = (int)hx / tw;
                 int rightCol = (int)(hx + hw - 1) / tw;
-                for (int tx = leftCol; tx <= rightCol; ++tx) {
-                    if (map->isBlockedAt(tx, topTile)) {
-                        hy = (float)((topTile + 1) * th); // stop below the blocking tile
-                        break;
-                    }
-                }
+                if (map->anyBlockedInRow(topTile, leftCol, rightCol))
+                    hy = (float)((topTile + 1) * th); // stop below the blocking tile
             }
 
             // Convert hitbox-space back to render-space
@@ -244,6 +228,14 @@ public:
         sheet->drawFrame(w, (int)dir, anim.current(), sx, sy);
     }
 
+    // Same as draw(), recorded for the banded renderer
+    void record(FrameCommands& out, float camX, float camY) const
+    {
+        if (!sheet || !sheet->valid()) return;
+        if (const SpanSprite* f = sheet->getFrame((int)dir, anim.current()))
+            out.sprite(*f, (int)(x - camX), (int)(y - camY));
+    }
+
     // Apply a knockback impulse: (dirX,dirY) direction, power in px/s, duration in s
     void applyKnockback(float dirX, float dirY, float power, float duration)
     {
@@ -0,0 +1,465 @@
+﻿#include "PngDecoder.h"
+#include "Image.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <thread>
+using namespace GamesEngineeringBase;
+
+/* Inflate ---------------------------------------------------------------------
+ * RFC 1950/1951. Huffman codes up to kFastBits long resolve with one table
+ * lookup; longer ones fall back to canonical bit-by-bit decoding. The output
+ * size is known up front (PNG scanlines), so the window is simply the output
+ * buffer and anything that would overrun it is a corrupt stream.
+ * ---------------------------------------------------------------------------*/
+namespace
+{
+    const int kFastBits = 9;
+
+    struct Huffman
+    {
+        uint16_t fast[1 << kFastBits];    // (len << 9) | symbol, 0 = longer code
+        uint16_t count[16];               // Codes per length
+        uint16_t symbol[320];             // Symbols in canonical order
+    };
+
+    struct BitReader
+    {
+        const unsigned char* p;
+        size_t size, pos = 0;
+        uint64_t buf = 0;
+        int bits = 0;
+        size_t padded = 0;                // Zero bytes fed past the end
+
+        void refill()
+        {
+            while (bits <= 56) {
+                uint64_t byte = 0;
+                if (pos < size) byte = p[pos++];
+                else ++padded;
+                buf |= byte << bits;
+                bits += 8;
+            }
+        }
+        unsigned peek(int n) { if (bits < n) refill(); return (unsigned)(buf & ((1ull << n) - 1)); }
+        void consume(int n) { buf >>= n; bits -= n; }
+        unsigned take(int n) { unsigned v = peek(n); consume(n); return v; }
+        // True if more bits were consumed than the stream holds
+        bool overrun() const { return padded * 8 > (size_t)bits; }
+    };
+
+    bool buildHuffman(Huffman& h, const unsigned char* lengths, int n)
+    {
+        memset(h.count, 0, sizeof(h.count));
+        memset(h.fast, 0, sizeof(h.fast));
+        for (int i = 0; i < n; ++i) h.count[lengths[i]]++;
+        h.count[0] = 0;
+
+        int left = 1;                                     // Over-subscription check
+        for (int len = 1; len < 16; ++len) {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) return false;
+        }
+
+        uint16_t offs[16];
+        offs[1] = 0;
+        for (int len = 1; len < 15; ++len) offs[len + 1] = offs[len] + h.count[len];
+        for (int i = 0; i < n; ++i)
+            if (lengths[i]) h.symbol[offs[lengths[i]]++] = (uint16_t)i;
+
+        // Fast table: canonical code for each short symbol, bit-reversed
+        int code = 0, k = 0;
+        for (int len = 1; len <= kFastBits; ++len) {
+            for (int c = 0; c < h.count[len]; ++c, ++code, ++k) {
+                int rev = 0;
+                for (int b = 0; b < len; ++b) rev |= ((code >> b) & 1) << (len - 1 - b);
+                for (int j = rev; j < (1 << kFastBits); j += 1 << len)
+                    h.fast[j] = (uint16_t)((len << 9) | h.symbol[k]);
+            }
+            code <<= 1;
+        }
+        return true;
+    }
+
+    int decodeSymbol(BitReader& br, const Huffman& h)
+    {
+        const uint16_t e = h.fast[br.peek(kFastBits)];
+        if (e) { br.consume(e >> 9); return e & 511; }
+
+        // Canonical decode, one bit at a time (codes longer than kFastBits)
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len < 16; ++len) {
+            code |= (int)br.take(1);
+            const int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    const uint16_t kLenBase[29] = { 3,4,5,6,7,8,9,10,11,13,15,17,19,23,27,31,35,43,51,59,67,83,99,115,131,163,195,227,258 };
+    const uint8_t  kLenExtra[29] = { 0,0,0,0,0,0,0,0,1,1,1,1,2,2,2,2,3,3,3,3,4,4,4,4,5,5,5,5,0 };
+    const uint16_t kDistBase[30] = { 1,2,3,4,5,7,9,13,17,25,33,49,65,97,129,193,257,385,513,769,1025,1537,2049,3073,4097,6145,8193,12289,16385,24577 };
+    const uint8_t  kDistExtra[30] = { 0,0,0,0,1,1,2,2,3,3,4,4,5,5,6,6,7,7,8,8,9,9,10,10,11,11,12,12,13,13 };
+
+    bool inflateBlock(BitReader& br, const Huffman& lit, const Huffman& dist,
+        unsigned char* out, size_t outSize, size_t& o)
+    {
+        for (;;) {
+            int sym = decodeSymbol(br, lit);
+            if (sym < 0 || br.overrun()) return false;
+            if (sym < 256) {
+                if (o >= outSize) return false;
+                out[o++] = (unsigned char)sym;
+                continue;
+            }
+            if (sym == 256) return true;
+            sym -= 257;
+            if (sym >= 29) return false;
+            const size_t len = kLenBase[sym] + br.take(kLenExtra[sym]);
+            const int ds = decodeSymbol(br, dist);
+            if (ds < 0 || ds >= 30) return false;
+            const size_t d = kDistBase[ds] + br.take(kDistExtra[ds]);
+            if (d > o || len > outSize - o) return false;
+            unsigned char* dst = out + o;
+            const unsigned char* src = dst - d;
+            if (d >= len) memcpy(dst, src, len);
+            else for (size_t i = 0; i < len; ++i) dst[i] = src[i];   // overlapping run
+            o += len;
+        }
+    }
+
+    bool inflateZlib(const unsigned char* z, size_t zsize, unsigned char* out, size_t outSize)
+    {
+        if (zsize < 6) return false;
+        const unsigned cmf = z[0], flg = z[1];
+        if ((cmf & 15) != 8 || (cmf >> 4) > 7 || ((cmf << 8) | flg) % 31 != 0 || (flg & 0x20)) return false;
+
+        BitReader br{ z + 2, zsize - 2 };
+        size_t o = 0;
+        Huffman lit, dist;
+        bool last = false;
+        while (!last) {
+            last = br.take(1) != 0;
+            const unsigned type = br.take(2);
+            if (type == 0) {
+                // Stored: drop to a byte boundary, then LEN / NLEN and raw bytes
+                br.consume(br.bits & 7);
+                const unsigned len = br.take(16), nlen = br.take(16);
+                if ((len ^ 0xFFFF) != nlen || len > outSize - o) return false;
+                for (unsigned i = 0; i < len; ++i) out[o++] = (unsigned char)br.take(8);
+                if (br.overrun()) return false;
+            }
+            else if (type == 1) {
+                unsigned char l[288 + 30];
+                for (int i = 0; i < 144; ++i) l[i] = 8;
+                for (int i = 144; i < 256; ++i) l[i] = 9;
+                for (int i = 256; i < 280; ++i) l[i] = 7;
+                for (int i = 280; i < 288; ++i) l[i] = 8;
+                for (int i = 0; i < 30; ++i) l[288 + i] = 5;
+                buildHuffman(lit, l, 288);
+                buildHuffman(dist, l + 288, 30);
+                if (!inflateBlock(br, lit, dist, out, outSize, o)) return false;
+            }
+            else if (type == 2) {
+                const int hlit = (int)br.take(5) + 257, hdist = (int)br.take(5) + 1, hclen = (int)br.take(4) + 4;
+                static const uint8_t order[19] = { 16,17,18,0,8,7,9,6,10,5,11,4,12,3,13,2,14,1,15 };
+                unsigned char cl[19] = {};
+                for (int i = 0; i < hclen; ++i) cl[order[i]] = (unsigned char)br.take(3);
+                Huffman clh;
+                if (!buildHuffman(clh, cl, 19)) return false;
+
+                unsigned char l[288 + 32] = {};
+                int n = 0;
+                while (n < hlit + hdist) {
+                    const int sym = decodeSymbol(br, clh);
+                    if (sym < 0 || br.overrun()) return false;
+                    if (sym < 16) { l[n++] = (unsigned char)sym; continue; }
+                    int rep = 0; unsigned char v = 0;
+                    if (sym == 16) { if (n == 0) return false; v = l[n - 1]; rep = 3 + (int)br.take(2); }
+                    else if (sym == 17) rep = 3 + (int)br.take(3);
+                    else rep = 11 + (int)br.take(7);
+                    if (n + rep > hlit + hdist) return false;
+                    while (rep--) l[n++] = v;
+                }
+                if (!buildHuffman(lit, l, hlit) || !buildHuffman(dist, l + hlit, hdist)) return false;
+                if (!inflateBlock(br, lit, dist, out, outSize, o)) return false;
+            }
+            else return false;
+        }
+        if (o != outSize || br.overrun()) return false;
+
+        // Adler-32 trailer, big-endian, on the next byte boundary
+        br.consume(br.bits & 7);
+        uint32_t want = 0;
+        for (int i = 0; i < 4; ++i) want = (want << 8) | br.take(8);
+        if (br.overrun()) return false;
+        uint32_t a = 1, b = 0;
+        for (size_t i = 0; i < outSize; ) {
+            const size_t end = (outSize - i > 5552) ? i + 5552 : outSize;
+            for (; i < end; ++i) { a += out[i]; b += a; }
+            a %= 65521; b %= 65521;
+        }
+        return ((b << 16) | a) == want;
+    }
+
+    /* PNG --------------------------------------------------------------------*/
+    uint32_t be32(const unsigned char* p) { return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]; }
+
+    unsigned char paeth(int a, int b, int c)
+    {
+        const int p = a + b - c;
+        const int pa = p > a ? p - a : a - p, pb = p > b ? p - b : b - p, pc = p > c ? p - c : c - p;
+        return (unsigned char)((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c));
+    }
+
+    // Reverses the per-row filters of one (pass) image in place
+    bool unfilter(unsigned char* rows, size_t rowBytes, unsigned h, size_t bpp)
+    {
+        const unsigned char* prev = nullptr;
+        for (unsigned y = 0; y < h; ++y) {
+            unsigned char* row = rows + y * (rowBytes + 1);
+            const unsigned type = row[0];
+            unsigned char* x = row + 1;
+            switch (type) {
+            case 0: break;
+            case 1: for (size_t i = bpp; i < rowBytes; ++i) x[i] = (unsigned char)(x[i] + x[i - bpp]); break;
+            case 2: if (prev) for (size_t i = 0; i < rowBytes; ++i) x[i] = (unsigned char)(x[i] + prev[i]); break;
+            case 3:
+                for (size_t i = 0; i < rowBytes; ++i) {
+                    const int left = i >= bpp ? x[i - bpp] : 0, up = prev ? prev[i] : 0;
+                    x[i] = (unsigned char)(x[i] + ((left + up) >> 1));
+                }
+                break;
+            case 4:
+                for (size_t i = 0; i < rowBytes; ++i) {
+                    const int left = i >= bpp ? x[i - bpp] : 0, up = prev ? prev[i] : 0;
+                    const int ul = (prev && i >= bpp) ? prev[i - bpp] : 0;
+                    x[i] = (unsigned char)(x[i] + paeth(left, up, ul));
+                }
+                break;
+            default: return false;
+            }
+            prev = x;
+        }
+        return true;
+    }
+
+    struct Format
+    {
+        unsigned depth, type;            // IHDR bit depth / colour type
+        unsigned samples;                // Samples per pixel
+        const unsigned char* palette;    // RGB triples
+        unsigned paletteSize;
+        unsigned char trnsAlpha[256];    // Palette alpha (type 3)
+        bool hasTrns;
+        uint16_t trnsKey[3];             // Gray / RGB colour key (types 0, 2)
+    };
+
+    unsigned sampleAt(const unsigned char* row, size_t index, unsigned depth)
+    {
+        switch (depth) {
+        case 8:  return row[index];
+        case 16: return ((unsigned)row[index * 2] << 8) | row[index * 2 + 1];
+        default: {
+            const size_t bit = index * depth;
+            return (row[bit >> 3] >> (8 - depth - (bit & 7))) & ((1u << depth) - 1);
+        }
+        }
+    }
+
+    // Writes `count` pixels of an unfiltered row to out (stride in pixels)
+    void expandRow(const Format& f, const unsigned char* row, unsigned count,
+        unsigned char* out, size_t outStep, unsigned channels)
+    {
+        const unsigned maxv = (1u << f.depth) - 1;
+        for (unsigned i = 0; i < count; ++i, out += outStep) {
+            unsigned r, g, b, a = 255;
+            if (f.type == 3) {
+                const unsigned idx = sampleAt(row, i, f.depth);
+                if (idx < f.paletteSize) { r = f.palette[idx * 3]; g = f.palette[idx * 3 + 1]; b = f.palette[idx * 3 + 2]; }
+                else r = g = b = 0;
+                a = f.trnsAlpha[idx & 255];
+            }
+            else {
+                const size_t s = (size_t)i * f.samples;
+                unsigned v[4];
+                for (unsigned k = 0; k < f.samples; ++k) v[k] = sampleAt(row, s + k, f.depth);
+                auto to8 = [&](unsigned x) { return f.depth == 16 ? x >> 8 : (f.depth == 8 ? x : x * 255 / maxv); };
+                if (f.type == 0 || f.type == 4) {
+                    r = g = b = to8(v[0]);
+                    if (f.type == 4) a = to8(v[1]);
+                    else if (f.hasTrns && v[0] == f.trnsKey[0]) a = 0;
+                }
+                else {
+                    r = to8(v[0]); g = to8(v[1]); b = to8(v[2]);
+                    if (f.type == 6) a = to8(v[3]);
+                    else if (f.hasTrns && v[0] == f.trnsKey[0] && v[1] == f.trnsKey[1] && v[2] == f.trnsKey[2]) a = 0;
+                }
+            }
+            out[0] = (unsigned char)r; out[1] = (unsigned char)g; out[2] = (unsigned char)b;
+            if (channels == 4) out[3] = (unsigned char)a;
+        }
+    }
+}
+
+bool decodePNG(const unsigned char* png, size_t size,
+    unsigned int& width, unsigned int& height, unsigned int& channels, unsigned char*& data)
+{
+    static const unsigned char sig[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    if (size < 8 + 25 || memcmp(png, sig, 8) != 0) return false;
+
+    Format f;
+    memset(&f, 0, sizeof(f));
+    memset(f.trnsAlpha, 255, sizeof(f.trnsAlpha));
+    unsigned w = 0, h = 0, interlace = 0;
+    bool haveHeader = false;
+    std::vector<unsigned char> z;
+
+    for (size_t pos = 8; pos + 12 <= size; ) {
+        const uint32_t len = be32(png + pos);
+        const unsigned char* type = png + pos + 4;
+        const unsigned char* body = png + pos + 8;
+        if (len > size - pos - 12) return false;
+        if (!memcmp(type, "IHDR", 4)) {
+            if (len < 13) return false;
+            w = be32(body); h = be32(body + 4);
+            f.depth = body[8]; f.type = body[9]; interlace = body[12];
+            if (body[10] != 0 || body[11] != 0 || interlace > 1) return false;
+            haveHeader = true;
+        }
+        else if (!memcmp(type, "PLTE", 4)) { f.palette = body; f.paletteSize = len / 3; }
+        else if (!memcmp(type, "tRNS", 4)) {
+            f.hasTrns = true;
+            if (f.type == 3) for (uint32_t i = 0; i < len && i < 256; ++i) f.trnsAlpha[i] = body[i];
+            else if (f.type == 0 && len >= 2) f.trnsKey[0] = (uint16_t)((body[0] << 8) | body[1]);
+            else if (f.type == 2 && len >= 6)
+                for (int k = 0; k < 3; ++k) f.trnsKey[k] = (uint16_t)((body[k * 2] << 8) | body[k * 2 + 1]);
+            else f.hasTrns = false;
+        }
+        else if (!memcmp(type, "IDAT", 4)) z.insert(z.end(), body, body + len);
+        else if (!memcmp(type, "IEND", 4)) break;
+        pos += 12 + (size_t)len;
+    }
+    if (!haveHeader || z.empty() || w == 0 || h == 0 || w > (1u << 16) || h > (1u << 16)) return false;
+
+    switch (f.type) {
+    case 0: f.samples = 1; break;
+    case 2: f.samples = 3; break;
+    case 3: f.samples = 1; if (!f.palette || f.depth > 8) return false; break;
+    case 4: f.samples = 2; break;
+    case 6: f.samples = 4; break;
+    default: return false;
+    }
+    const unsigned d = f.depth;
+    if (d != 1 && d != 2 && d != 4 && d != 8 && d != 16) return false;
+    if ((f.type == 2 || f.type == 4 || f.type == 6) && d < 8) return false;
+
+    const unsigned bitsPerPixel = f.samples * d;
+    const size_t bpp = bitsPerPixel >= 8 ? bitsPerPixel / 8 : 1;
+    auto rowBytesFor = [&](unsigned pw) { return ((size_t)pw * bitsPerPixel + 7) / 8; };
+
+    // Adam7 pass geometry (a single full pass when not interlaced)
+    static const unsigned x0s[7] = { 0,4,0,2,0,1,0 }, y0s[7] = { 0,0,4,0,2,0,1 };
+    static const unsigned dxs[7] = { 8,8,4,4,2,2,1 }, dys[7] = { 8,8,8,4,4,2,2 };
+    const int passes = interlace ? 7 : 1;
+    unsigned pw[7], ph[7];
+    size_t total = 0;
+    for (int p = 0; p < passes; ++p) {
+        pw[p] = interlace ? (w - x0s[p] + dxs[p] - 1) / dxs[p] : w;
+        ph[p] = interlace ? (h - y0s[p] + dys[p] - 1) / dys[p] : h;
+        if (x0s[p] >= w) pw[p] = 0;
+        if (y0s[p] >= h) ph[p] = 0;
+        if (pw[p] && ph[p]) total += (rowBytesFor(pw[p]) + 1) * ph[p];
+    }
+
+    std::vector<unsigned char> raw(total);
+    if (!inflateZlib(z.data(), z.size(), raw.data(), raw.size())) return false;
+
+    const bool alpha = f.type == 4 || f.type == 6 || f.hasTrns;
+    const unsigned ch = alpha ? 4 : 3;
+    unsigned char* pixels = new unsigned char[(size_t)w * h * ch];
+
+    size_t off = 0;
+    for (int p = 0; p < passes; ++p) {
+        if (!pw[p] || !ph[p]) continue;
+        const size_t rb = rowBytesFor(pw[p]);
+        unsigned char* rows = raw.data() + off;
+        if (!unfilter(rows, rb, ph[p], bpp)) { delete[] pixels; return false; }
+        const unsigned sx = interlace ? x0s[p] : 0, sy = interlace ? y0s[p] : 0;
+        const unsigned dx = interlace ? dxs[p] : 1, dy = interlace ? dys[p] : 1;
+        for (unsigned y = 0; y < ph[p]; ++y) {
+            const unsigned char* row = rows + y * (rb + 1) + 1;
+            unsigned char* out = pixels + ((size_t)(sy + y * dy) * w + sx) * ch;
+            // Common case: 8-bit RGB/RGBA that already matches the output layout
+            if (dx == 1 && d == 8 && ((f.type == 2 && !f.hasTrns) || f.type == 6))
+                memcpy(out, row, (size_t)w * ch);
+            else
+                expandRow(f, row, pw[p], out, (size_t)dx * ch, ch);
+        }
+        off += (rb + 1) * ph[p];
+    }
+
+    width = w; height = h; channels = ch; data = pixels;
+    return true;
+}
+
+bool decodePNGFile(const std::string& filename,
+    unsigned int& width, unsigned int& height, unsigned int& channels, unsigned char*& data)
+{
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    if (!in) return false;
+    const std::streamoff len = in.tellg();
+    if (len <= 0) return false;
+    std::vector<unsigned char> file((size_t)len);
+    in.seekg(0);
+    if (!in.read((char*)file.data(), len)) return false;
+    return decodePNG(file.data(), file.size(), width, height, channels, data);
+}
+
+/* Batch loading ---------------------------------------------------------------
+ * Workers pull the next path index from a shared counter, so large and small
+ * files balance out. Only the PNG decoder runs on the workers (WIC would need
+ * COM initialised per thread); leftovers go through Image::load afterwards.
+ * ---------------------------------------------------------------------------*/
+int loadImagesParallel(const std::vector<std::string>& paths,
+    std::vector<std::unique_ptr<Image>>& out, int threads)
+{
+    const int n = (int)paths.size();
+    out.clear();
+    out.resize(n);
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads < 1) threads = 1;
+    if (threads > n) threads = n;
+
+    std::atomic<int> next(0);
+    auto work = [&] {
+        for (int i = next++; i < n; i = next++) {
+            unsigned int w, h, c;
+            unsigned char* d;
+            if (!decodePNGFile(paths[i], w, h, c, d)) continue;
+            std::unique_ptr<Image> img(new Image());
+            img->width = w; img->height = h; img->channels = c; img->data = d;
+            out[i] = std::move(img);
+        }
+    };
+    std::vector<std::thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (std::thread& t : pool) t.join();
+
+    int loaded = 0;
+    for (int i = 0; i < n; ++i) {
+        if (!out[i]) {
+            std::unique_ptr<Image> img(new Image());
+            if (img->load(paths[i])) out[i] = std::move(img);
+        }
+        if (out[i]) ++loaded;
+    }
+    return loaded;
+}
@@ -0,0 +1,30 @@
+﻿#pragma once
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+/*******************************  PngDecoder  **********************************
+ * Self-contained PNG decoder (zlib inflate + scanline filters), no WIC/COM,
+ * so images load headless and on any platform. Image::load tries it first
+ * and only falls back to WIC for other formats.
+ *   - All colour types, bit depths 1-16, PLTE/tRNS and Adam7 interlacing.
+ *   - Output matches Image::load's layout: RGB (3 channels) when the image
+ *     has no alpha, RGBA (4) when it has an alpha channel or tRNS; 16-bit
+ *     samples keep their high byte.
+ *   - `data` is allocated with new[] so it can be handed to an Image.
+ * Chunk CRCs are not checked; the zlib Adler-32 of the pixel stream is.
+ *******************************************************************************/
+namespace GamesEngineeringBase { class Image; }
+
+bool decodePNG(const unsigned char* png, size_t size,
+    unsigned int& width, unsigned int& height, unsigned int& channels, unsigned char*& data);
+bool decodePNGFile(const std::string& filename,
+    unsigned int& width, unsigned int& height, unsigned int& channels, unsigned char*& data);
+
+// Decodes `paths` on a pool of `threads` workers (0 = one per hardware
+// thread). out[i] is the image for paths[i], or nullptr if it failed; files
+// the PNG decoder rejects are retried with Image::load on the calling
+// thread. Returns the number of images loaded.
+int loadImagesParallel(const std::vector<std::string>& paths,
+    std::vector<std::unique_ptr<GamesEngineeringBase::Image>>& out, int threads = 0);
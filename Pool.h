@@ -0,0 +1,147 @@
+﻿#pragma once
+#include <cstdint>
+#include <vector>
+
+// Refers to one pool slot as long as it holds the same object: a slot that
+// is released and handed out again gets a new generation.
+struct PoolHandle
+{
+    int slot = -1;
+    uint32_t generation = 0;
+};
+
+/**********************************  SlotPool  *********************************
+ * Slot bookkeeping for pools whose data lives elsewhere (Pool<T> below,
+ * NPCStore's columns).
+ *   - Capacity is set at runtime by reset(). A full pool refuses acquire()
+ *     and counts the refusal in drops() instead of scanning for space.
+ *   - Free slots form a list threaded through their own metadata, so
+ *     acquire() and release() are O(1).
+ *   - Live slots are also kept densely (liveAt(0 .. liveCount()-1)) for
+ *     iteration. release() moves the last live slot into the gap, so walk
+ *     the list backwards when releasing during the walk.
+ *   - highWater() bounds every slot ever handed out, for kernels that
+ *     sweep whole columns.
+ *******************************************************************************/
+class SlotPool
+{
+public:
+    void reset(int capacity)
+    {
+        const int n = capacity > 0 ? capacity : 0;
+        meta.assign((size_t)n, Meta());
+        for (int i = 0; i < n; ++i) meta[i].nextFree = (i + 1 < n) ? i + 1 : -1;
+        freeHead = n > 0 ? 0 : -1;
+        dense.clear();
+        dense.reserve((size_t)n);
+        high = 0;
+        dropped = 0;
+    }
+
+    // Returns a free slot, or -1 (and one more drop) when the pool is full
+    int acquire()
+    {
+        if (freeHead < 0) { ++dropped; return -1; }
+        const int slot = freeHead;
+        Meta& m = meta[slot];
+        freeHead = m.nextFree;
+        m.nextFree = -1;
+        m.livePos = (int)dense.size();
+        dense.push_back(slot);
+        if (slot >= high) high = slot + 1;
+        return slot;
+    }
+
+    // Frees a live slot; its handles stop resolving
+    void release(int slot)
+    {
+        Meta& m = meta[slot];
+        if (m.livePos < 0) return;
+        const int last = dense.back();
+        dense[m.livePos] = last;
+        meta[last].livePos = m.livePos;
+        dense.pop_back();
+        m.livePos = -1;
+        ++m.generation;
+        m.nextFree = freeHead;
+        freeHead = slot;
+    }
+
+    // Frees every live slot
+    void releaseAll()
+    {
+        while (!dense.empty()) release(dense.back());
+    }
+
+    bool isLive(int slot) const { return slot >= 0 && slot < capacity() && meta[slot].livePos >= 0; }
+
+    PoolHandle handle(int slot) const { return PoolHandle{ slot, meta[slot].generation }; }
+    bool isValid(PoolHandle h) const { return isLive(h.slot) && meta[h.slot].generation == h.generation; }
+
+    int capacity()  const { return (int)meta.size(); }
+    int liveCount() const { return (int)dense.size(); }
+    int liveAt(int k) const { return dense[k]; }
+    const int* liveSlots() const { return dense.data(); }
+    int livePos(int slot) const { return meta[slot].livePos; }   // -1 when free
+    bool full()     const { return freeHead < 0; }
+    int highWater() const { return high; }
+    int drops()     const { return dropped; }
+
+private:
+    struct Meta
+    {
+        int nextFree = -1;                // Next free slot while free
+        int livePos = -1;                 // Index in `dense` while live, else -1
+        uint32_t generation = 0;          // Bumped on every release
+    };
+
+    std::vector<Meta> meta;
+    std::vector<int>  dense;
+    int freeHead = -1;
+    int high = 0;
+    int dropped = 0;
+};
+
+/************************************  Pool  ***********************************
+ * SlotPool plus the objects themselves. acquire() hands out a
+ * default-constructed T; the slot index stays stable until release().
+ *******************************************************************************/
+template <typename T>
+class Pool
+{
+public:
+    void reset(int capacity)
+    {
+        slots.reset(capacity);
+        items.assign((size_t)slots.capacity(), T());
+    }
+
+    // Slot of a fresh T, or -1 when the pool is full (counted in drops())
+    int acquire()
+    {
+        const int slot = slots.acquire();
+        if (slot >= 0) items[slot] = T();
+        return slot;
+    }
+
+    void release(int slot) { slots.release(slot); }
+    void releaseAll() { slots.releaseAll(); }
+
+    T&       operator[](int slot)       { return items[slot]; }
+    const T& operator[](int slot) const { return items[slot]; }
+
+    PoolHandle handle(int slot) const { return slots.handle(slot); }
+    T* get(PoolHandle h) { return slots.isValid(h) ? &items[h.slot] : nullptr; }
+    const T* get(PoolHandle h) const { return slots.isValid(h) ? &items[h.slot] : nullptr; }
+
+    int capacity()  const { return slots.capacity(); }
+    int liveCount() const { return slots.liveCount(); }
+    int liveAt(int k) const { return slots.liveAt(k); }
+    const int* liveSlots() const { return slots.liveSlots(); }
+    bool full()     const { return slots.full(); }
+    int drops()     const { return slots.drops(); }
+
+private:
+    std::vector<T> items;
+    SlotPool slots;
+};
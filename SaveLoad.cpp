@@ -84,25 +84,26 @@ namespace SaveLoad
         f.write((const char*)&kills, sizeof(kills));
 
         // I only store alive NPCs to keep the file short.
-        const NPC* arr = npcs.getArray();
-        int32_t count = 0;
-        for (int i = 0; i < EnemyManager::MAX; ++i)
-            if (arr[i].isAlive()) ++count;
+        const NPCStore& store = npcs.getStore();
+        int32_t count = (int32_t)store.liveCount();
 
         f.write((const char*)&count, sizeof(count));
 
         // Serialize each living NPC. I deliberately DO NOT save speed:
         // speed is reconstructed from type via speedFromType().
-        for (int i = 0; i < EnemyManager::MAX; ++i)
+        // Slot order, not live order: loading spawns into ascending slots,
+        // so NPCs keep their relative order across a round trip.
+        for (int i = 0; i < store.capacity(); ++i)
         {
-            if (!arr[i].isAlive()) continue;
-            int32_t type = (int32_t)arr[i].getType();
-            float x = arr[i].getX();
-            float y = arr[i].getY();
-            float fire = arr[i].getFireCD();
-            int32_t hp = arr[i].getHP();
-            int32_t w = arr[i].getW();
-            int32_t h = arr[i].getH();
+            if (!store.isAlive(i)) continue;
+            const NPC n = store.get(i);
+            int32_t type = (int32_t)n.getType();
+            float x = n.getX();
+            float y = n.getY();
+            float fire = n.getFireCD();
+            int32_t hp = n.getHP();
+            int32_t w = n.getW();
+            int32_t h = n.getH();
 
             f.write((const char*)&type, sizeof(type));
             f.write((const char*)&x, sizeof(x));
@@ -164,14 +165,14 @@ namespace SaveLoad
 
         // Step 6: NPC manager mode first, then clear current NPCs.
         npcs.setInfinite(infiniteMode);
-        NPC* arr = npcs.getArray();
-        for (int i = 0; i < EnemyManager::MAX; ++i) arr[i].kill(); // quick reset
+        NPCStore& store = npcs.getStore();
+        store.clear(); // quick reset
 
         // Step 7: read alive NPC count with bounds checks. Defensive coding here.
         int32_t count = 0;
         f.read((char*)&count, sizeof(count));
         if (count < 0) count = 0; // corrupted? clamp up
-        if (count > EnemyManager::MAX) count = EnemyManager::MAX; // clamp down
+        if (count > store.capacity()) count = store.capacity(); // clamp down
 
         // Step 8: rebuild each NPC.
         for (int i = 0; i < count; ++i)
@@ -186,11 +187,6 @@ namespace SaveLoad
             f.read((char*)&w, sizeof(w));
             f.read((char*)&h, sizeof(h));
 
-            // Find a free slot. If none left (should not happen due to clamp), stop early.
-            int slot = -1;
-            for (int k = 0; k < EnemyManager::MAX; ++k) if (!arr[k].isAlive()) { slot = k; break; }
-            if (slot < 0) break; // out of capacity  data says more than we can host
-
             // I need a facing target to finish spawn init (AI wants a reference point).
             // Using hero center makes sense; it restores typical aggro behavior.
             float faceTx = hero.getHitboxX() + hero.getHitboxW() * 0.5f;
@@ -198,11 +194,14 @@ namespace SaveLoad
             float spd = speedFromType((unsigned char)type); // reconstruct movement rule
 
             // Spawn + patch fields we persisted.
-            arr[slot].initSpawn(x, y, (unsigned char)type, spd, faceTx, faceTy);
-            arr[slot].setFireCD(fire);
-            arr[slot].w = w;    // direct size override  yes, these are public in NPC
-            arr[slot].h = h;
-            arr[slot].hp = hp;
+            NPC n;
+            n.initSpawn(x, y, (unsigned char)type, spd, faceTx, faceTy);
+            n.setFireCD(fire);
+            n.w = w;    // direct size override  yes, these are public in NPC
+            n.h = h;
+            n.hp = hp;
+            // Full store (should not happen due to clamp) -> stop early.
+            if (store.spawn(n) < 0) break;
         }
 
         // If stream is okay, we consider load successful. (Partial reads will flip badbit.)
@@ -0,0 +1,132 @@
+﻿#include "ScrollingBackground.h"
+#include "TileMap.h"
+#include "blit32.h"
+#include <cstring>
+
+static int wrapMod(int v, int m) { int r = v % m; return r < 0 ? r + m : r; }
+
+int ScrollingBackground::ringX() const { return wrapMod(camX, bg.width); }
+int ScrollingBackground::ringY() const { return wrapMod(camY, bg.height); }
+
+/* Strip redraw ----------------------------------------------------------------
+ * (x, y, w, h) is in screen space. In the ring it may straddle the buffer's
+ * right and bottom edges, so it is drawn as up to four pieces, each with the
+ * camera placed at that piece's world origin. TileMap::draw leaves off-map
+ * pixels (fixed mode) untouched and alpha-tests transparent tiles, so those
+ * cells are blacked out first, matching a cleared frame; cells covered by
+ * opaque tiles are not cleared at all.
+ * ---------------------------------------------------------------------------*/
+void ScrollingBackground::redraw(TileMap& map, int x, int y, int w, int h)
+{
+    if (w <= 0 || h <= 0) return;
+    const int W = bg.width, H = bg.height;
+    const int bx = wrapMod(ringX() + x, W), by = wrapMod(ringY() + y, H);
+    const int w0 = (bx + w <= W) ? w : W - bx;
+    const int h0 = (by + h <= H) ? h : H - by;
+
+    const int pxs[2] = { x, x + w0 }, pws[2] = { w0, w - w0 }, pbx[2] = { bx, 0 };
+    const int pys[2] = { y, y + h0 }, phs[2] = { h0, h - h0 }, pby[2] = { by, 0 };
+    for (int j = 0; j < 2; ++j) {
+        if (phs[j] <= 0) continue;
+        for (int i = 0; i < 2; ++i) {
+            if (pws[i] <= 0) continue;
+            Surface piece = bg.sub(pbx[i], pby[j], pws[i], phs[j]);
+            lastCleared += map.clearUncovered(piece, (float)(camX + pxs[i]), (float)(camY + pys[j]));
+            map.draw(piece, (float)(camX + pxs[i]), (float)(camY + pys[j]));
+        }
+    }
+    lastRedrawn += (long long)w * h;
+}
+
+void ScrollingBackground::update(TileMap& map, float fCamX, float fCamY, int viewW, int viewH)
+{
+    const int cx = (int)fCamX, cy = (int)fCamY;
+    lastRedrawn = 0;
+    lastCleared = 0;
+    lastChanged = false;
+
+    if (bg.width != viewW || bg.height != viewH) {
+        pixels.assign((size_t)viewW * viewH * 3, 0);
+        bg = Surface::wrap(pixels.data(), viewW, viewH);
+        valid = false;
+    }
+    if (viewW <= 0 || viewH <= 0) return;
+
+    const int dx = cx - camX, dy = cy - camY;
+    const int adx = dx > 0 ? dx : -dx;
+    const int ady = dy > 0 ? dy : -dy;
+    camX = cx; camY = cy;
+    lastChanged = !valid || dx != 0 || dy != 0 || map.getRevision() != mapRevision;
+
+    if (!valid || adx >= viewW || ady >= viewH || map.getRevision() != mapRevision) {
+        mapRevision = map.getRevision();
+        valid = true;
+        redraw(map, 0, 0, viewW, viewH);
+        return;
+    }
+
+    // Exposed rows span the full width; exposed columns skip those rows
+    const int rowsY = (dy > 0) ? viewH - ady : 0;
+    const int colsY = (dy > 0) ? 0 : ady;
+    redraw(map, 0, rowsY, viewW, ady);
+    redraw(map, (dx > 0) ? viewW - adx : 0, colsY, adx, viewH - ady);
+}
+
+/* Composite -------------------------------------------------------------------
+ * Unrolls the ring: each screen row is the buffer row (y + ringY) mod H, read
+ * from column ringX and wrapping once at the buffer's right edge.
+ * ---------------------------------------------------------------------------*/
+static inline void copyPixels(const Surface& dst, int x, int y, const unsigned char* src, int n)
+{
+    memcpy(dst.row(y) + (size_t)x * 3, src, (size_t)n * 3);
+}
+
+static inline void copyPixels(const Surface32& dst, int x, int y, const unsigned char* src, int n)
+{
+    blitRowRGB32(dst.row(y) + x, src, n);
+}
+
+template <class S>
+void ScrollingBackground::copyRect(const S& dst, int x0, int y0, int x1, int y1) const
+{
+    const int W = bg.width, H = bg.height;
+    const int rx = ringX(), ry = ringY();
+    const int bx = (x0 + rx) % W;
+    const int n = x1 - x0;
+    const int head = (bx + n <= W) ? n : W - bx;
+    for (int y = y0; y < y1; ++y) {
+        const unsigned char* src = bg.row(y + ry < H ? y + ry : y + ry - H);
+        copyPixels(dst, x0, y, src + (size_t)bx * 3, head);
+        if (head < n) copyPixels(dst, x0 + head, y, src, n - head);
+    }
+}
+
+void ScrollingBackground::composite(const Surface& dst) const
+{
+    if (dst.width != bg.width || dst.height != bg.height || !valid) return;
+    compositeRows(dst, 0, bg.height);
+    dst.markDirty(0, 0, bg.width, bg.height);
+}
+
+void ScrollingBackground::composite(const Surface& dst, const DirtyRects& only) const
+{
+    compositeRows(dst, only, 0, bg.height);
+}
+
+template <class S>
+void ScrollingBackground::compositeRowsT(const S& dst, const DirtyRects* only, int y0, int y1) const
+{
+    if (dst.width != bg.width || dst.height != bg.height || !valid) return;
+    if (!only) { copyRect(dst, 0, y0, bg.width, y1); return; }
+    for (int i = 0; i < only->count(); ++i) {
+        const DirtyRects::Rect& r = (*only)[i];
+        const int ry0 = r.y0 > y0 ? r.y0 : y0;
+        const int ry1 = r.y1 < y1 ? r.y1 : y1;
+        if (ry0 < ry1) copyRect(dst, r.x0, ry0, r.x1, ry1);
+    }
+}
+
+void ScrollingBackground::compositeRows(const Surface& dst, int y0, int y1) const { compositeRowsT(dst, nullptr, y0, y1); }
+void ScrollingBackground::compositeRows(const Surface& dst, const DirtyRects& only, int y0, int y1) const { compositeRowsT(dst, &only, y0, y1); }
+void ScrollingBackground::compositeRows(const Surface32& dst, int y0, int y1) const { compositeRowsT(dst, nullptr, y0, y1); }
+void ScrollingBackground::compositeRows(const Surface32& dst, const DirtyRects& only, int y0, int y1) const { compositeRowsT(dst, &only, y0, y1); }
@@ -0,0 +1,68 @@
+﻿#pragma once
+#include "Surface.h"
+#include <vector>
+
+class TileMap;
+
+/***************************  ScrollingBackground  *****************************
+ * Persistent world-only framebuffer for a following camera.
+ *   - The buffer is toroidal: world pixel (wx, wy) lives at buffer position
+ *     (wx mod W, wy mod H), so a camera move needs no pixel shifting at all.
+ *     update() only asks TileMap to draw the newly exposed row strip and
+ *     column strip. Large jumps, resizes and map changes (TileMap revision)
+ *     fall back to a full redraw.
+ *   - composite() unrolls the ring into the back buffer (two memcpys per row),
+ *     which also replaces Window::clear(); dynamic layers (NPCs, bullets,
+ *     pickups, hero, HUD) are then drawn on top of that copy as before.
+ *   - redrawnPixels() reports the tile pixels rendered by the last update(),
+ *     clearedBytes() the bytes it had to zero first (only cells not covered
+ *     by opaque tiles), both for the perf CSV.
+ *******************************************************************************/
+class ScrollingBackground
+{
+public:
+    // Brings the background up to date for the camera (camX, camY), using the
+    // same integer camera convention as TileMap::draw ((int)cam).
+    void update(TileMap& map, float camX, float camY, int viewW, int viewH);
+
+    // Copies the background into dst in screen order (sizes must match the last update)
+    void composite(const Surface& dst) const;
+
+    // Restores only the given rects (last frame's sprites) when the camera held still
+    void composite(const Surface& dst, const DirtyRects& only) const;
+
+    // Row-limited versions for banded rendering: touch only rows [y0, y1) of
+    // dst and record nothing (the caller reports the writes)
+    void compositeRows(const Surface& dst, int y0, int y1) const;
+    void compositeRows(const Surface& dst, const DirtyRects& only, int y0, int y1) const;
+
+    // Same into an RGBX8888 frame (pixels expanded while copying)
+    void compositeRows(const Surface32& dst, int y0, int y1) const;
+    void compositeRows(const Surface32& dst, const DirtyRects& only, int y0, int y1) const;
+
+    // True if the last update() moved or redrew anything, i.e. the whole
+    // screen differs from the previous frame
+    bool changed() const { return lastChanged; }
+
+    // Forces a full redraw on the next update()
+    void invalidate() { valid = false; }
+
+    long long redrawnPixels() const { return lastRedrawn; }
+    long long clearedBytes() const { return lastCleared; }
+
+private:
+    std::vector<unsigned char> pixels;
+    Surface bg;
+    bool valid = false;
+    int camX = 0, camY = 0;            // Integer camera of the current contents
+    unsigned int mapRevision = 0;
+    long long lastRedrawn = 0;
+    long long lastCleared = 0;
+    bool lastChanged = false;
+
+    int ringX() const;                 // Buffer column of screen column 0
+    int ringY() const;
+    void redraw(TileMap& map, int x, int y, int w, int h);
+    template <class S> void copyRect(const S& dst, int x0, int y0, int x1, int y1) const;
+    template <class S> void compositeRowsT(const S& dst, const DirtyRects* only, int y0, int y1) const;
+};
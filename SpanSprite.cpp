@@ -0,0 +1,122 @@
+﻿#include "SpanSprite.h"
+#include "blit.h"
+#include "blit32.h"
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+/* Encoding --------------------------------------------------------------------
+ * One pass per row: alternate between counting transparent and opaque pixels.
+ * Span fields are 16-bit, so very long runs are split (a zero-skip span simply
+ * continues the previous run, a zero-run span just carries a long skip).
+ * ---------------------------------------------------------------------------*/
+bool SpanSprite::encode(const Image& img, int sx, int sy, int w, int h)
+{
+    width = height = 0;
+    rows.clear(); spans.clear(); rgb.clear();
+
+    if (!img.data || (img.channels != 3 && img.channels != 4)) return false;
+    if (sx < 0) { w += sx; sx = 0; }
+    if (sy < 0) { h += sy; sy = 0; }
+    if (sx + w > (int)img.width)  w = (int)img.width - sx;
+    if (sy + h > (int)img.height) h = (int)img.height - sy;
+    if (w <= 0 || h <= 0) return false;
+
+    const int ch = (int)img.channels;
+    const unsigned short kMaxField = 0xFFFF;
+    rows.resize(h);
+
+    for (int y = 0; y < h; ++y)
+    {
+        const unsigned char* p = img.data + ((size_t)(sy + y) * img.width + sx) * ch;
+        Row& row = rows[y];
+        row.firstSpan = (unsigned int)spans.size();
+        row.rgbOffset = (unsigned int)rgb.size();
+
+        int x = 0;
+        while (x < w)
+        {
+            int skip = 0;
+            while (x < w && ch == 4 && p[x * 4 + 3] < kBlitAlphaCutoff && skip < kMaxField) { ++x; ++skip; }
+            int run = 0;
+            while (x < w && (ch == 3 || p[x * 4 + 3] >= kBlitAlphaCutoff) && run < kMaxField) {
+                const unsigned char* px = p + x * ch;
+                rgb.push_back(px[0]); rgb.push_back(px[1]); rgb.push_back(px[2]);
+                ++x; ++run;
+            }
+            if (run > 0 || skip == kMaxField) spans.push_back(Span{ (unsigned short)skip, (unsigned short)run });
+        }
+        row.spanCount = (unsigned int)spans.size() - row.firstSpan;
+    }
+
+    width = w; height = h;
+    return true;
+}
+
+/* Drawing ---------------------------------------------------------------------
+ * Rows are clipped vertically up front; spans are clipped horizontally as they
+ * are walked. Spans entirely left of the target are skipped without copying,
+ * and the walk stops at the first span starting past the right edge.
+ * ---------------------------------------------------------------------------*/
+static inline void copyRun(unsigned char* line, int x, const unsigned char* src, int n)
+{
+    memcpy(line + (size_t)x * 3, src, (size_t)n * 3);
+}
+
+static inline void copyRun(uint32_t* line, int x, const unsigned char* src, int n)
+{
+    blitRowRGB32(line + x, src, n);
+}
+
+void SpanSprite::draw(const Surface& dst, int dstX, int dstY) const
+{
+    drawT(dst, dstX, dstY);
+}
+
+void SpanSprite::draw(const Surface32& dst, int dstX, int dstY) const
+{
+    drawT(dst, dstX, dstY);
+}
+
+template <class S>
+void SpanSprite::drawT(const S& dst, int dstX, int dstY) const
+{
+    if (!valid()) return;
+    if (dstX >= dst.width || dstY >= dst.height) return;
+    if (dstX + width <= 0 || dstY + height <= 0) return;
+
+    int y0 = dstY < 0 ? -dstY : 0;
+    int y1 = height;
+    if (dstY + y1 > dst.height) y1 = dst.height - dstY;
+
+    const int clipR = dst.width;
+    {
+        const int bx0 = dstX < 0 ? 0 : dstX;
+        const int bx1 = dstX + width > clipR ? clipR : dstX + width;
+        dst.markDirty(bx0, dstY + y0, bx1 - bx0, y1 - y0);
+    }
+    for (int y = y0; y < y1; ++y)
+    {
+        const Row& row = rows[y];
+        const Span* s = spans.data() + row.firstSpan;
+        const Span* e = s + row.spanCount;
+        const unsigned char* src = rgb.data() + row.rgbOffset;
+        auto* line = dst.row(dstY + y);
+
+        int x = dstX;
+        for (; s != e; ++s)
+        {
+            x += s->skip;
+            if (x >= clipR) break;
+
+            int a = x, b = x + s->run;
+            const unsigned char* sp = src;
+            src += (size_t)s->run * 3;
+            x = b;
+
+            if (b <= 0) continue;
+            if (a < 0) { sp += (size_t)(-a) * 3; a = 0; }
+            if (b > clipR) b = clipR;
+            copyRun(line, a, sp, b - a);
+        }
+    }
+}
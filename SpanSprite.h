@@ -0,0 +1,55 @@
+﻿#pragma once
+#include "GamesEngineeringBase.h"
+#include "Surface.h"
+#include <vector>
+
+/*******************************  SpanSprite  **********************************
+ * Load-time run-length encoding of an alpha-tested image.
+ * Each row is a list of (skip, run) pairs: `skip` transparent pixels, then
+ * `run` opaque pixels whose RGB bytes are stored contiguously in `rgb`.
+ * "Opaque" uses the same cutoff as the blitters (alpha >= kBlitAlphaCutoff),
+ * so drawing a SpanSprite is pixel-identical to blitSubImage() on the source.
+ *
+ * Drawing clips spans against the target and memcpy's whole runs straight
+ * into the RGB24 back buffer; there is no per-pixel alpha test left.
+ * 3-channel sources encode to one run per row.
+ *******************************************************************************/
+class SpanSprite
+{
+public:
+    struct Span { unsigned short skip, run; };
+
+    // Encodes the (sx, sy, w, h) region of `img`; the region is clamped to the
+    // image. Returns false for an empty region or unsupported channel count.
+    bool encode(const GamesEngineeringBase::Image& img, int sx, int sy, int w, int h);
+    bool encode(const GamesEngineeringBase::Image& img)
+    {
+        return encode(img, 0, 0, (int)img.width, (int)img.height);
+    }
+
+    // Draws with the sprite's top-left at (dstX, dstY); clipped to the target.
+    void draw(const Surface& dst, int dstX, int dstY) const;
+    void draw(const Surface32& dst, int dstX, int dstY) const;
+    void draw(GamesEngineeringBase::Window& w, int dstX, int dstY) const
+    {
+        draw(Surface::of(w), dstX, dstY);
+    }
+
+    int  getWidth()  const { return width; }
+    int  getHeight() const { return height; }
+    bool valid()     const { return width > 0 && height > 0; }
+
+    // Encoded size stats (useful for asset budgets and benchmarks)
+    int  spanCount()   const { return (int)spans.size(); }
+    int  opaqueCount() const { return (int)(rgb.size() / 3); }
+
+private:
+    struct Row { unsigned int firstSpan, spanCount, rgbOffset; };
+
+    int width = 0, height = 0;
+    std::vector<Row>           rows;   // One entry per source row
+    std::vector<Span>          spans;  // All rows' spans, in row order
+    std::vector<unsigned char> rgb;    // Opaque pixels, packed RGB, in span order
+
+    template <class S> void drawT(const S& dst, int dstX, int dstY) const;  // RGB24 / RGBX8888
+};
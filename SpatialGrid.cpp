@@ -0,0 +1,51 @@
+﻿#include "SpatialGrid.h"
+#include <cmath>
+
+/* Build -----------------------------------------------------------------------
+ * Bounds pass, then counting sort by cell: count, prefix-sum, scatter. The
+ * scatter walks ids in input order, so each cell lists its ids in that order.
+ * ---------------------------------------------------------------------------*/
+void SpatialGrid::build(const float* x, const float* y, const int* ids, int count, float cellSize)
+{
+    items.resize(count > 0 ? (size_t)count : 0);
+    if (count <= 0) { cols = rowCount = 0; cellStart.assign(1, 0); return; }
+
+    float minX = x[ids[0]], maxX = minX, minY = y[ids[0]], maxY = minY;
+    for (int i = 1; i < count; ++i) {
+        const float px = x[ids[i]], py = y[ids[i]];
+        if (px < minX) minX = px; else if (px > maxX) maxX = px;
+        if (py < minY) minY = py; else if (py > maxY) maxY = py;
+    }
+
+    // Cap the cell count near 4 per box; sparse sets get bigger cells
+    cell = cellSize > 1.f ? cellSize : 1.f;
+    const double maxCells = 4.0 * count + 64.0;
+    for (;;) {
+        const double c = std::floor((maxX - minX) / cell) + 1.0;
+        const double r = std::floor((maxY - minY) / cell) + 1.0;
+        if (c * r <= maxCells) { cols = (int)c; rowCount = (int)r; break; }
+        cell *= (float)std::sqrt(c * r / maxCells) * 1.01f;
+    }
+    invCell = 1.f / cell;
+    originX = minX; originY = minY;
+
+    const size_t cells = (size_t)cols * rowCount;
+    cellStart.assign(cells + 1, 0);
+    cellOf.resize((size_t)count);
+    for (int i = 0; i < count; ++i) {
+        int cx = (int)((x[ids[i]] - originX) * invCell);
+        int cy = (int)((y[ids[i]] - originY) * invCell);
+        if (cx >= cols) cx = cols - 1;          // float round-up at the far edge
+        if (cy >= rowCount) cy = rowCount - 1;
+        const int c = cy * cols + cx;
+        cellOf[i] = c;
+        ++cellStart[(size_t)c + 1];
+    }
+    for (size_t c = 0; c < cells; ++c) cellStart[c + 1] += cellStart[c];
+
+    // Scatter through a running cursor per cell (cellStart[c] advances to
+    // cellStart[c + 1]), then shift the starts back into place
+    for (int i = 0; i < count; ++i) items[(size_t)cellStart[cellOf[i]]++] = ids[i];
+    for (size_t c = cells; c > 0; --c) cellStart[c] = cellStart[c - 1];
+    cellStart[0] = 0;
+}
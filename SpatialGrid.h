@@ -0,0 +1,117 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/********************************  SpatialGrid  ********************************
+ * Uniform-grid broadphase over boxes, rebuilt from scratch each frame.
+ *   - build() buckets each box by its top-left corner with one counting-sort
+ *     pass, so the grid is two flat arrays (cell starts, ids by cell) and
+ *     ids inside a cell keep the order they were given in.
+ *   - Boxes must be no larger than a cell. A box then reaches at most one
+ *     cell right and down of its own, so forEachNear() visits the cells a
+ *     query rect covers plus one cell up and left.
+ *   - The grid spans the boxes' bounding area; if that would need far more
+ *     cells than boxes (a sparse infinite world) the cells grow instead.
+ *   - Visited ids are candidates only; callers run the exact overlap test.
+ *   - nearest() walks square rings of cells outward from the query point
+ *     and stops once no unvisited cell can beat the k-th best distance. A
+ *     box in ring d >= 2 is at least (d - 2) cells away.
+ *******************************************************************************/
+class SpatialGrid
+{
+public:
+    // Buckets ids[0 .. count) at (x[id], y[id]); every box must fit in
+    // cellSize x cellSize
+    void build(const float* x, const float* y, const int* ids, int count, float cellSize);
+
+    // Calls visit(id) for each box that may overlap [x0, x1) x [y0, y1)
+    template <typename F>
+    void forEachNear(float x0, float y0, float x1, float y1, F&& visit) const
+    {
+        if (cols == 0) return;
+        const int cx0 = lowIndex((x0 - cell - originX) * invCell, cols);
+        const int cx1 = highIndex((x1 - originX) * invCell, cols);
+        const int cy0 = lowIndex((y0 - cell - originY) * invCell, rowCount);
+        const int cy1 = highIndex((y1 - originY) * invCell, rowCount);
+        if (cx0 > cx1 || cy0 > cy1) return;
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            const int* start = &cellStart[(size_t)cy * cols];
+            for (int k = start[cx0]; k < start[cx1 + 1]; ++k) visit(items[k]);
+        }
+    }
+
+    // Up to k ids with the smallest dist2(id), nearest first, ties to the
+    // lower id. dist2 must be at least the squared distance from (px, py)
+    // to the id's box (e.g. to its center); a negative value skips the id.
+    // Returns the number of ids written to out (which is cleared first).
+    template <typename D>
+    int nearest(float px, float py, int k, D&& dist2, std::vector<int>& out) const
+    {
+        out.clear();
+        if (cols == 0 || k <= 0) return 0;
+        best.clear();
+        const int qx = std::min(cols - 1, lowIndex((px - originX) * invCell, cols));
+        const int qy = std::min(rowCount - 1, lowIndex((py - originY) * invCell, rowCount));
+        const int maxRing = std::max(std::max(qx, cols - 1 - qx), std::max(qy, rowCount - 1 - qy));
+
+        auto consider = [&](int cx, int cy) {
+            const size_t c = (size_t)cy * cols + cx;
+            for (int j = cellStart[c]; j < cellStart[c + 1]; ++j) {
+                const int id = items[j];
+                const float d2 = dist2(id);
+                if (d2 < 0.f) continue;
+                const std::pair<float, int> e(d2, id);
+                if ((int)best.size() < k) { best.push_back(e); std::push_heap(best.begin(), best.end()); }
+                else if (e < best.front()) {
+                    std::pop_heap(best.begin(), best.end());
+                    best.back() = e;
+                    std::push_heap(best.begin(), best.end());
+                }
+            }
+        };
+
+        for (int d = 0; d <= maxRing; ++d) {
+            if ((int)best.size() == k && d >= 2) {
+                const float reach = (d - 2) * cell;
+                if (best.front().first < reach * reach) break;
+            }
+            const int y0 = std::max(0, qy - d), y1 = std::min(rowCount - 1, qy + d);
+            const int x0 = std::max(0, qx - d), x1 = std::min(cols - 1, qx + d);
+            for (int cy = y0; cy <= y1; ++cy) {
+                if (cy == qy - d || cy == qy + d) {
+                    for (int cx = x0; cx <= x1; ++cx) consider(cx, cy);
+                }
+                else {
+                    if (qx - d >= 0) consider(qx - d, cy);
+                    if (qx + d < cols) consider(qx + d, cy);
+                }
+            }
+        }
+
+        std::sort_heap(best.begin(), best.end());
+        for (const std::pair<float, int>& e : best) out.push_back(e.second);
+        return (int)out.size();
+    }
+
+    float cellSize()  const { return cell; }
+    int   columns()   const { return cols; }
+    int   rows()      const { return rowCount; }
+    int   itemCount() const { return (int)items.size(); }
+
+private:
+    float cell = 1.f, invCell = 1.f;
+    float originX = 0.f, originY = 0.f;
+    int   cols = 0, rowCount = 0;
+
+    std::vector<int> cellStart;         // cols * rows + 1 prefix sums
+    std::vector<int> items;             // ids sorted by cell
+    std::vector<int> cellOf;            // build scratch, one per id
+    mutable std::vector<std::pair<float, int>> best;   // nearest() max-heap
+
+    // First / last cell index a range starting / ending at cell coordinate
+    // f can touch; the pair comes out reversed when the range misses [0, n)
+    static int lowIndex(float f, int n)  { return f < 0.f ? 0 : (f >= (float)n ? n : (int)f); }
+    static int highIndex(float f, int n) { return f < 0.f ? -1 : (f >= (float)n ? n - 1 : (int)f); }
+};
@@ -1,6 +1,9 @@
 ﻿#pragma once
 #include "GamesEngineeringBase.h"
 #include "blit.h"
+#include "SpanSprite.h"
+#include "AssetPack.h"
+#include <vector>
 using namespace GamesEngineeringBase;
 
 /***************************  SpriteSheet: extract frame (row, col)  ***************************
@@ -11,25 +14,44 @@ using namespace GamesEngineeringBase;
  *
  * Designed to work with any number of rows (≥4) and a fixed 4-column layout,
  * but row/column indices are generic for future flexibility.
+ *
+ * Frames are span-encoded at load and looked up by index (row * cols + col);
+ * the sheet image is released once they are built. Frames stay out of the
+ * TextureAtlas: the spans skip transparent pixels, which an atlas blit
+ * would alpha-test one by one.
  ***********************************************************************************************/
 class SpriteSheet
 {
 private:
-    GamesEngineeringBase::Image image; // Full source sheet
     int frameW = 0, frameH = 0;        // Dimensions of a single frame
     int rows = 0, cols = 0;            // Total rows and columns (cols usually = 4)
+    std::vector<SpanSprite> frames;    // Span-encoded frames, row-major (row * cols + col)
 
 public:
     // Loads the entire sheet and stores its grid metadata.
     // fw, fh define the dimensions of each frame.
+    // With a pack, a packed copy of `filename` is used without decoding.
+    // The sheet image is only held while the frames are encoded.
     // Returns false if file loading fails or any parameter is invalid.
-    bool load(const char* filename, int fw, int fh, int _rows, int _cols)
+    bool load(const char* filename, int fw, int fh, int _rows, int _cols, const AssetPack* pack = nullptr)
     {
-        if (!image.load(std::string(filename))) return false;
+        GamesEngineeringBase::Image image;
+        const GamesEngineeringBase::Image* source = pack ? pack->find(filename) : nullptr;
+        if (!source) {
+            if (!image.load(std::string(filename))) return false;
+            source = &image;
+        }
         frameW = fw; frameH = fh; rows = _rows; cols = _cols;
         // Basic sanity checks to prevent division or overflow issues
         if (frameW <= 0 || frameH <= 0) return false;
         if (rows <= 0 || cols <= 0) return false;
+
+        // Pre-encode every frame once so drawing never re-tests alpha
+        frames.clear();
+        frames.resize((size_t)rows * cols);
+        for (int r = 0; r < rows; ++r)
+            for (int c = 0; c < cols; ++c)
+                frames[(size_t)r * cols + c].encode(*source, c * frameW, r * frameH, frameW, frameH);
         return true;
     }
 
@@ -41,18 +63,21 @@ public:
         if (row < 0 || row >= rows) return;
         if (col < 0 || col >= cols) return;
 
-        // Compute source rectangle inside the sprite sheet
-        int sx = col * frameW;
-        int sy = row * frameH;
+        // Copy the pre-encoded frame's opaque runs into the window buffer
+        frames[(size_t)row * cols + col].draw(w, dstX, dstY);
+    }
 
-        // Copy sub-image into window buffer
-        blitSubImage(w, image, sx, sy, frameW, frameH, dstX, dstY);
+    // Pre-encoded frame (row, col), or nullptr when out of range
+    const SpanSprite* getFrame(int row, int col) const
+    {
+        if (row < 0 || row >= rows || col < 0 || col >= cols) return nullptr;
+        return &frames[(size_t)row * cols + col];
     }
 
     // Accessors for frame size
     int getFrameW() const { return frameW; }
     int getFrameH() const { return frameH; }
 
-    // Checks whether the sheet has valid pixel data
-    bool valid() const { return image.data != nullptr; }
+    // Checks whether the sheet loaded
+    bool valid() const { return !frames.empty(); }
 };
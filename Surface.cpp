@@ -0,0 +1,14 @@
+﻿#include "Surface.h"
+#include "GamesEngineeringBase.h"
+using namespace GamesEngineeringBase;
+
+Surface Surface::of(Window& w)
+{
+    Surface s;
+    s.pixels = w.getBackBuffer();
+    s.width = (int)w.getWidth();
+    s.height = (int)w.getHeight();
+    s.pitch = s.width * 3;
+    s.dirty = DirtyRects::attachedTo(w);
+    return s;
+}
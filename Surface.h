@@ -0,0 +1,89 @@
+﻿#pragma once
+#include "DirtyRects.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace GamesEngineeringBase { class Window; }
+
+/*********************************  Surface  ***********************************
+ * Non-owning view of an RGB24 pixel buffer: 3 bytes per pixel, row-major,
+ * `pitch` bytes between rows. Same layout as Window's back buffer, so
+ * Surface::of(window) wraps the back buffer and offscreen buffers can be
+ * rendered with the same primitives (and without a D3D device).
+ * `dirty`, when set, collects the rects primitives write (see DirtyRects.h);
+ * Surface::of() picks up the tracker attached to the window.
+ *******************************************************************************/
+struct Surface
+{
+    unsigned char* pixels = nullptr;
+    int width = 0, height = 0;   // In pixels
+    int pitch = 0;               // Bytes per row (>= width * 3)
+    DirtyRects* dirty = nullptr; // Optional write tracker
+
+    // Wraps the window back buffer (tightly packed); in Surface.cpp so
+    // this header does not need the Windows/D3D one
+    static Surface of(GamesEngineeringBase::Window& w);
+
+    // Wraps a caller-owned buffer of width*height*3 bytes
+    static Surface wrap(unsigned char* rgb, int w, int h)
+    {
+        Surface s;
+        s.pixels = rgb; s.width = w; s.height = h; s.pitch = w * 3;
+        return s;
+    }
+
+    unsigned char* row(int y) const { return pixels + (size_t)y * pitch; }
+
+    // Records a write to (x, y, w, h); callers pass the clipped rect
+    void markDirty(int x, int y, int w, int h) const { if (dirty) dirty->add(x, y, w, h); }
+
+    // View of the (x, y, w, h) rectangle sharing this surface's memory.
+    // The rectangle must lie inside the surface. Views are untracked.
+    Surface sub(int x, int y, int w, int h) const
+    {
+        Surface s;
+        s.pixels = row(y) + (size_t)x * 3;
+        s.width = w; s.height = h; s.pitch = pitch;
+        return s;
+    }
+};
+
+/********************************  Surface32  **********************************
+ * Non-owning view of an RGBX8888 buffer: one uint32_t per pixel holding bytes
+ * R, G, B, X in memory order (little-endian: r | g << 8 | b << 16; X is
+ * don't-care), `stride` pixels between rows. Every pixel is one aligned
+ * 32-bit word, so fills and copies are whole-word or SIMD stores; the frame
+ * is converted to RGB24 once at present (see blit32.h / FrameBuffer32.h).
+ *******************************************************************************/
+struct Surface32
+{
+    uint32_t* pixels = nullptr;
+    int width = 0, height = 0;   // In pixels
+    int stride = 0;              // Pixels per row (>= width)
+    DirtyRects* dirty = nullptr; // Optional write tracker
+
+    static Surface32 wrap(uint32_t* px, int w, int h)
+    {
+        Surface32 s;
+        s.pixels = px; s.width = w; s.height = h; s.stride = w;
+        return s;
+    }
+
+    uint32_t* row(int y) const { return pixels + (size_t)y * stride; }
+
+    void markDirty(int x, int y, int w, int h) const { if (dirty) dirty->add(x, y, w, h); }
+
+    // Untracked view of the (x, y, w, h) rectangle (must lie inside)
+    Surface32 sub(int x, int y, int w, int h) const
+    {
+        Surface32 s;
+        s.pixels = row(y) + x;
+        s.width = w; s.height = h; s.stride = stride;
+        return s;
+    }
+};
+
+inline uint32_t packRGBX(unsigned char r, unsigned char g, unsigned char b)
+{
+    return (uint32_t)r | ((uint32_t)g << 8) | ((uint32_t)b << 16);
+}
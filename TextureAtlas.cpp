@@ -0,0 +1,210 @@
+﻿#include "TextureAtlas.h"
+#include "blit.h"
+#include "PixelImage.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+using namespace GamesEngineeringBase;
+
+/* Staging ---------------------------------------------------------------------
+ * Regions are staged as RGBA (3-channel sources get alpha 255); build()
+ * drops the alpha byte again for regions that land on the RGB24 page.
+ * ---------------------------------------------------------------------------*/
+int TextureAtlas::add(const Image& img, int sx, int sy, int w, int h)
+{
+    if (!img.data || (img.channels != 3 && img.channels != 4)) return -1;
+    if (sx < 0) { w += sx; sx = 0; }
+    if (sy < 0) { h += sy; sy = 0; }
+    if (sx + w > (int)img.width)  w = (int)img.width - sx;
+    if (sy + h > (int)img.height) h = (int)img.height - sy;
+    if (w <= 0 || h <= 0) return -1;
+
+    Staged st;
+    st.rgba.resize((size_t)w * h * 4);
+    bool opaque = true;
+    const int ch = (int)img.channels;
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* s = img.data + ((size_t)(sy + y) * img.width + sx) * ch;
+        unsigned char* d = st.rgba.data() + (size_t)y * w * 4;
+        for (int x = 0; x < w; ++x, s += ch, d += 4) {
+            d[0] = s[0]; d[1] = s[1]; d[2] = s[2];
+            d[3] = (ch == 4) ? s[3] : 255;
+            if (d[3] < kBlitAlphaCutoff) opaque = false;
+        }
+    }
+
+    Rect r = { 0, 0, w, h, opaque };
+    rects.push_back(r);
+    staged.push_back(std::move(st));
+    return (int)rects.size() - 1;
+}
+
+// Already RGBA and classified: rows copy straight in
+int TextureAtlas::add(const PixelImage& img)
+{
+    if (!img.valid()) return -1;
+    const int w = img.getWidth(), h = img.getHeight();
+    Staged st;
+    st.rgba.resize((size_t)w * h * 4);
+    for (int y = 0; y < h; ++y)
+        memcpy(st.rgba.data() + (size_t)y * w * 4, img.row(y), (size_t)w * 4);
+
+    Rect r = { 0, 0, w, h, img.coverage() == PixelImage::Opaque };
+    rects.push_back(r);
+    staged.push_back(std::move(st));
+    return (int)rects.size() - 1;
+}
+
+void TextureAtlas::clear()
+{
+    rects.clear();
+    staged.clear();
+    rgbPage.free();
+    rgbaPage.free();
+    isBuilt = false;
+}
+
+/* Skyline packer --------------------------------------------------------------
+ * The skyline is the top edge of everything placed so far, as a list of
+ * horizontal segments. A rect goes where its bottom lands lowest (ties: the
+ * leftmost), which fills the atlas row by row with little waste for the
+ * uniform tile/frame sizes this game uses.
+ * ---------------------------------------------------------------------------*/
+bool TextureAtlas::placeSkyline(std::vector<SkyNode>& sky, int atlasW, int w, int h, int& outX, int& outY)
+{
+    int bestI = -1, bestTop = 0x7FFFFFFF, bestX = 0, bestY = 0;
+    for (size_t i = 0; i < sky.size(); ++i) {
+        const int x = sky[i].x;
+        if (x + w > atlasW) break;
+        int y = 0;
+        for (size_t j = i; j < sky.size() && sky[j].x < x + w; ++j)
+            y = std::max(y, sky[j].y);
+        if (y + h < bestTop) { bestTop = y + h; bestI = (int)i; bestX = x; bestY = y; }
+    }
+    if (bestI < 0) return false;
+
+    // Insert the new segment and cut away what it now shadows
+    SkyNode node = { bestX, bestY + h, w };
+    sky.insert(sky.begin() + bestI, node);
+    for (size_t j = bestI + 1; j < sky.size(); ) {
+        const int end = node.x + node.w;
+        if (sky[j].x >= end) break;
+        const int shrink = end - sky[j].x;
+        if (shrink >= sky[j].w) { sky.erase(sky.begin() + j); continue; }
+        sky[j].x += shrink; sky[j].w -= shrink;
+        break;
+    }
+    // Merge neighbours at the same height
+    for (size_t j = 0; j + 1 < sky.size(); ) {
+        if (sky[j].y == sky[j + 1].y) { sky[j].w += sky[j + 1].w; sky.erase(sky.begin() + j + 1); }
+        else ++j;
+    }
+    outX = bestX; outY = bestY;
+    return true;
+}
+
+bool TextureAtlas::buildPage(bool opaque, int maxWidth, Image& out)
+{
+    out.free();
+    out.width = out.height = out.channels = 0;
+
+    std::vector<int> order;
+    long long area = 0;
+    int widest = 0;
+    for (size_t i = 0; i < rects.size(); ++i) {
+        if (rects[i].opaque != opaque) continue;
+        order.push_back((int)i);
+        area += (long long)rects[i].w * rects[i].h;
+        widest = std::max(widest, rects[i].w);
+    }
+    if (order.empty()) return true;
+
+    // Width: roughly square, at least the widest region, rows a multiple of 64 bytes
+    const int bpp = opaque ? 3 : 4;
+    const int align = opaque ? kRowAlignBytes : kRowAlignBytes / 4;   // pixels
+    auto roundUp = [align](int v) { return (v + align - 1) / align * align; };
+    int pageW = roundUp(std::max((int)std::ceil(std::sqrt((double)area)), widest));
+    if (pageW > maxWidth) pageW = std::max(maxWidth / align * align, roundUp(widest));
+
+    // Tallest first, then widest: the usual skyline order
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        if (rects[a].h != rects[b].h) return rects[a].h > rects[b].h;
+        if (rects[a].w != rects[b].w) return rects[a].w > rects[b].w;
+        return a < b;
+    });
+
+    std::vector<SkyNode> sky(1, SkyNode{ 0, 0, pageW });
+    int pageH = 0;
+    for (int i : order) {
+        Rect& r = rects[i];
+        if (!placeSkyline(sky, pageW, r.w, r.h, r.x, r.y)) return false;
+        pageH = std::max(pageH, r.y + r.h);
+    }
+
+    const size_t pitch = (size_t)pageW * bpp;
+    out.width = (unsigned int)pageW;
+    out.height = (unsigned int)pageH;
+    out.channels = (unsigned int)bpp;
+    out.data = new unsigned char[pitch * pageH];
+    memset(out.data, 0, pitch * pageH);
+
+    for (int i : order) {
+        const Rect& r = rects[i];
+        for (int y = 0; y < r.h; ++y) {
+            const unsigned char* s = staged[i].rgba.data() + (size_t)y * r.w * 4;
+            unsigned char* d = out.data + (size_t)(r.y + y) * pitch + (size_t)r.x * bpp;
+            if (!opaque) { memcpy(d, s, (size_t)r.w * 4); continue; }
+            for (int x = 0; x < r.w; ++x, s += 4, d += 3) { d[0] = s[0]; d[1] = s[1]; d[2] = s[2]; }
+        }
+    }
+    return true;
+}
+
+bool TextureAtlas::build(int maxWidth)
+{
+    isBuilt = false;
+    if (rects.empty()) return false;
+    if (!buildPage(true, maxWidth, rgbPage) || !buildPage(false, maxWidth, rgbaPage)) return false;
+    staged.clear();
+    staged.shrink_to_fit();
+    isBuilt = true;
+    return true;
+}
+
+size_t TextureAtlas::bytes() const
+{
+    return (size_t)rgbPage.width * rgbPage.height * 3 + (size_t)rgbaPage.width * rgbaPage.height * 4;
+}
+
+float TextureAtlas::occupancy() const
+{
+    const double pageArea = (double)rgbPage.width * rgbPage.height + (double)rgbaPage.width * rgbaPage.height;
+    if (!built() || pageArea <= 0.0) return 0.f;
+    long long used = 0;
+    for (const Rect& r : rects) used += (long long)r.w * r.h;
+    return (float)((double)used / pageArea);
+}
+
+/* Drawing ---------------------------------------------------------------------*/
+void TextureAtlas::draw(const Surface& dst, int handle, int x, int y) const
+{
+    if (!built() || handle < 0 || handle >= (int)rects.size()) return;
+    const Rect& r = rects[handle];
+
+    int sx = r.x, sy = r.y, w = r.w, h = r.h;
+    if (x < 0) { sx -= x; w += x; x = 0; }
+    if (y < 0) { sy -= y; h += y; y = 0; }
+    if (x + w > dst.width)  w = dst.width - x;
+    if (y + h > dst.height) h = dst.height - y;
+    if (w <= 0 || h <= 0) return;
+    dst.markDirty(x, y, w, h);
+
+    const Image& img = page(r);
+    const size_t pitch = (size_t)img.width * img.channels;
+    const unsigned char* src = img.data + (size_t)sy * pitch + (size_t)sx * img.channels;
+    for (int row = 0; row < h; ++row, src += pitch) {
+        unsigned char* out = dst.row(y + row) + (size_t)x * 3;
+        if (r.opaque) memcpy(out, src, (size_t)w * 3);
+        else          blitRowRGBA(out, src, w);
+    }
+}
@@ -0,0 +1,59 @@
+﻿#pragma once
+#include "GamesEngineeringBase.h"
+#include "Surface.h"
+#include <vector>
+
+class PixelImage;
+
+/*****************************  TextureAtlas  **********************************
+ * Packs many small images (tiles, sprite frames) into two contiguous pages:
+ *   - regions with no pixel below the alpha cutoff (flagged `opaque` at add()
+ *     time) go to an RGB24 page and draw as plain row copies;
+ *   - everything else goes to an RGBA page and draws through blitRowRGBA.
+ * add() copies a region into a staging list and returns a handle; build()
+ * packs each page with a skyline (bottom-left) packer into one allocation
+ * whose rows are a multiple of kRowAlignBytes. rect(handle) is a
+ * constant-time lookup into the rect table; page(rect) is the image it
+ * lives in.
+ *******************************************************************************/
+class TextureAtlas
+{
+public:
+    struct Rect { int x, y, w, h; bool opaque; };
+    static const int kRowAlignBytes = 64;
+
+    // Queues (a region of) img; returns its handle or -1 if the region is empty
+    int add(const GamesEngineeringBase::Image& img, int sx, int sy, int w, int h);
+    int add(const GamesEngineeringBase::Image& img) { return add(img, 0, 0, (int)img.width, (int)img.height); }
+    int add(const PixelImage& img);
+
+    // Packs every queued region; maxWidth caps the atlas width in pixels
+    bool build(int maxWidth = 1024);
+
+    // Drops the atlas and all handles
+    void clear();
+
+    bool built() const { return isBuilt; }
+    int  count() const { return (int)rects.size(); }
+    const Rect& rect(int handle) const { return rects[handle]; }
+    const GamesEngineeringBase::Image& page(const Rect& r) const { return r.opaque ? rgbPage : rgbaPage; }
+
+    // Draws region `handle` with its top-left at (x, y); alpha test as blitImage
+    void draw(const Surface& dst, int handle, int x, int y) const;
+
+    // Packing stats (both pages together)
+    size_t bytes() const;
+    float  occupancy() const;         // Packed area / page area
+
+private:
+    struct Staged { std::vector<unsigned char> rgba; };
+    struct SkyNode { int x, y, w; };
+
+    std::vector<Rect> rects;
+    std::vector<Staged> staged;       // Freed by build()
+    GamesEngineeringBase::Image rgbPage, rgbaPage;
+    bool isBuilt = false;
+
+    static bool placeSkyline(std::vector<SkyNode>& sky, int atlasW, int w, int h, int& outX, int& outY);
+    bool buildPage(bool opaque, int maxWidth, GamesEngineeringBase::Image& out);
+};
@@ -2,7 +2,22 @@
 #include "GamesEngineeringBase.h"
 #include "gfx_utils.h"
 #include "blit.h"
+#include "FrameCommands.h"
+#include "TextureAtlas.h"
+#include "AssetPack.h"
+#include "PngDecoder.h"
+#include "TileStreamer.h"
+#include "PixelImage.h"
+#include "MapFile.h"
+#include "MappedFile.h"
+#include "IntListParser.h"
+#include "ChunkedWorld.h"
 #include <string>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstring>
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 using namespace GamesEngineeringBase;
@@ -11,10 +26,22 @@ using namespace std;
 /**********************************  TileMap  **********************************
  * Basic tile map loader and renderer.
  * Responsible for:
- *   - Loading a tile layout from a text file (tiles.txt format)
- *   - Lazy-loading tile images from a folder (e.g., "./tiles/14.png")
+ *   - Loading a tile layout from a text file (tiles.txt format), or mapping
+ *     a compiled binary map (MapFile.h) straight into memory
+ *   - Storing tile IDs as uint16 in 16x16-tile chunks (see MapFile.h)
+ *   - Lazy-loading tile images from a folder (e.g., "./tiles/14.png"),
+ *     normalized once into PixelImages so drawing never re-checks size or
+ *     channel count, or viewing them in a mapped AssetPack
+ *     (attachAssetPack), which stores that layout, without a copy
  *   - Rendering tiles around the camera position
- *   - Handling wrapping (infinite map behavior)
+ *   - Handling wrapping (infinite map behavior), or surrounding the loaded
+ *     map with an unbounded generated world (attachWorld)
+ *   - Optionally drawing from a TextureAtlas packed at startup
+ *     (addTilesToAtlas + attachAtlas) instead of one image per tile
+ *   - Optionally streaming tile images on a background thread
+ *     (enableStreaming + pumpStreaming) under a memory budget
+ *   - Answering collision queries from a 1-bit-per-tile blocking bitset
+ *     (isBlockedAt, anyBlockedInRow/Column/Rect; setBlocking per tile ID)
  *
  * Each tile ID corresponds to an image file with the same name.
  * For example, tile ID 17 loads "tiles/17.png" when first used.
@@ -23,49 +50,137 @@ class TileMap {
 private:
     int width = 0, height = 0;         // Map dimensions (in tiles)
     int tileW = 32, tileH = 32;        // Tile size (in pixels)
-    int* data = nullptr;               // Tile ID array (row-major order)
+    uint16_t* cells = nullptr;         // Tile IDs, chunked (MapFile.h layout)
+    int chunksX = 0, chunksY = 0;      // Map size in storage chunks
+    std::vector<uint16_t> ownedCells;  // Backing store for text maps
+    MappedFile mapped;                 // Backing store for binary maps (copy-on-write)
 
     // --- Tile image cache ---
     static const int MAX_TILE_ID = 1024;    // Maximum number of unique tile IDs
-    GamesEngineeringBase::Image* tileImg[MAX_TILE_ID];
+    PixelImage* tilePix[MAX_TILE_ID];     // Normalized tile images (owned), tileW x tileH
+
+    // Residency of each tile image. Unloaded: not asked for yet; Pending:
+    // queued on the streamer, drawn as its idToColor placeholder; Resident:
+    // tilePix[id] is set; Failed: no usable file or the wrong size, drawn as
+    // the gray fallback.
+    enum class TileState : unsigned char { Unloaded, Pending, Resident, Failed };
+    TileState tileState[MAX_TILE_ID];
+    const AssetPack* pack = nullptr;
     char folder[260];                      // Resource folder (e.g., "./tiles/")
     bool wrap = false;                     // If true, map repeats infinitely
+    ChunkedWorld* world = nullptr;         // Answers for tiles outside the map (overrides wrap)
+
+    // --- Atlas (optional) ---
+    // tileSlot[id] is the atlas handle for tile id, -1 if it isn't packed.
+    int tileSlot[MAX_TILE_ID];
+    const TextureAtlas* atlas = nullptr;
+
+    // --- Streaming (optional, see enableStreaming) ---
+    std::unique_ptr<TileStreamer> streamer;
+    std::vector<TileStreamer::Result> arrivals;  // Scratch for pumpStreaming
+    double tileSeen[MAX_TILE_ID];                // streamClock when last drawn
+    double streamClock = 0.0;                    // Seconds, advanced by pumpStreaming
+    size_t imageBytes = 0;                       // Bytes held in tilePix[]
+    size_t imageBudget = 64u << 20;
+    double idleSeconds = 30.0;
+    int evictions = 0;
+
+    // Per-ID "drawing this tile overwrites every pixel of its cell":
+    // -1 = not known yet, 0 = no, 1 = yes (see isTileOpaque)
+    signed char tileOpacity[MAX_TILE_ID];
+
+    std::string loadError;                 // Why the last load() failed
+
+    // --- Collision ---
+    // blockingId[id] marks tile IDs that stop movement (water 14-22 by
+    // default). blockBits holds one bit per map tile, row-major with
+    // blockWords 64-bit words per row; it is rebuilt on first query after a
+    // load or a setBlocking() change and patched in place by set().
+    bool blockingId[MAX_TILE_ID];
+    mutable std::vector<uint64_t> blockBits;
+    mutable bool blockDirty = true;
+    int blockWords = 0;
+
+    // Bumped whenever drawn output may change (load, set, folder, wrap), so
+    // renderers that keep old pixels around know when to start over.
+    unsigned int revision = 0;
 
     // Initializes the image cache to a clean state
     void initCache() {
-        for (int i = 0; i < MAX_TILE_ID; ++i) tileImg[i] = nullptr;
+        for (int i = 0; i < MAX_TILE_ID; ++i) {
+            tilePix[i] = nullptr; tileState[i] = TileState::Unloaded;
+            tileSeen[i] = 0.0;
+            tileSlot[i] = -1; tileOpacity[i] = -1;
+            blockingId[i] = (i >= 14 && i <= 22);
+        }
         folder[0] = '\0';
     }
 
-    // Parses all integer values from a line (supports commas, spaces, etc.)
-    static int parseInts(const std::string& line, int* dst, int maxWrite) {
-        int written = 0;
-        int i = 0, n = (int)line.size();
-        while (i < n && written < maxWrite) {
-            while (i < n && !(line[i] == '-' || (line[i] >= '0' && line[i] <= '9'))) ++i;
-            if (i >= n) break;
-            int sign = 1;
-            if (line[i] == '-') { sign = -1; ++i; }
-            long val = 0;
-            bool hasDigit = false;
-            while (i < n && (line[i] >= '0' && line[i] <= '9')) {
-                val = val * 10 + (line[i] - '0');
-                ++i; hasDigit = true;
+    bool loadFailed(const char* path, const char* why) {
+        loadError = std::string(path) + ": " + why;
+        return false;
+    }
+
+    // Index of tile (x, y) (in range) in the chunked cell array
+    size_t cellIndex(int x, int y) const { return cellIndexIn(chunksX, x, y); }
+    static size_t cellIndexIn(int chunksAcross, int x, int y) {
+        const int cx = x >> kMapChunkShift, cy = y >> kMapChunkShift;
+        return ((size_t)cy * chunksAcross + cx) * kMapChunkCells +
+            (size_t)(((y & (kMapChunkTiles - 1)) << kMapChunkShift) | (x & (kMapChunkTiles - 1)));
+    }
+    size_t cellCount() const { return (size_t)chunksX * chunksY * kMapChunkCells; }
+
+    static uint16_t toCell(int id) { return (id < 0 || id >= kMapEmptyCell) ? kMapEmptyCell : (uint16_t)id; }
+
+    // Drops the current cells (owned or mapped) and sizes the grid
+    void resetCells(int w, int h) {
+        mapped.close();
+        std::vector<uint16_t>().swap(ownedCells);
+        cells = nullptr;
+        width = w; height = h;
+        chunksX = (w + kMapChunkTiles - 1) >> kMapChunkShift;
+        chunksY = (h + kMapChunkTiles - 1) >> kMapChunkShift;
+        blockWords = (w + 63) >> 6;
+        blockDirty = true;
+    }
+
+    void ensureBlockBits() const {
+        if (!blockDirty) return;
+        blockBits.assign((size_t)blockWords * height, 0);
+        if (cells) {
+            for (int y = 0; y < height; ++y) {
+                uint64_t* row = &blockBits[(size_t)y * blockWords];
+                for (int x = 0; x < width; ++x)
+                    if (isBlockedId(cells[cellIndex(x, y)])) row[x >> 6] |= 1ull << (x & 63);
             }
-            if (hasDigit) dst[written++] = (int)(sign * val);
-            while (i < n && (line[i] == ',' || line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
         }
-        return written;
+        blockDirty = false;
     }
 
-    // Lazy-loads the tile image for a given ID the first time it’s needed
-    // Builds filename as "<folder><id>.png"
-    Image* getTileImage(int id) {
-        if (id < 0 || id >= MAX_TILE_ID) return nullptr;
-        if (tileImg[id]) return tileImg[id];
+    // Any blocking tile in columns [x0, x1] of map row y (all in range)
+    bool rowBitsAny(int y, int x0, int x1) const {
+        const uint64_t* row = &blockBits[(size_t)y * blockWords];
+        const int a = x0 >> 6, b = x1 >> 6;
+        const uint64_t lo = ~0ull << (x0 & 63), hi = ~0ull >> (63 - (x1 & 63));
+        if (a == b) return (row[a] & lo & hi) != 0;
+        if (row[a] & lo) return true;
+        for (int k = a + 1; k < b; ++k) if (row[k]) return true;
+        return (row[b] & hi) != 0;
+    }
 
+    // Any blocking tile in rows [y0, y1] of map column x (all in range):
+    // one bit of the same word in each row, blockWords apart
+    bool columnBitsAny(int x, int y0, int y1) const {
+        const uint64_t bit = 1ull << (x & 63);
+        size_t at = (size_t)y0 * blockWords + (x >> 6);
+        for (int y = y0; y <= y1; ++y, at += blockWords)
+            if (blockBits[at] & bit) return true;
+        return false;
+    }
+
+    // Builds "<folder><id>.png" into filename (at least 320 bytes)
+    void tileFilename(int id, char* filename) const {
         // Construct filename manually to avoid dependencies like sprintf
-        char filename[320];
         int n = 0;
         for (; folder[n] && n < 259; ++n) filename[n] = folder[n];
 
@@ -80,27 +195,225 @@ private:
         // Append ".png"
         filename[n++] = '.'; filename[n++] = 'p'; filename[n++] = 'n'; filename[n++] = 'g';
         filename[n] = '\0';
+    }
+
+    // Resolves the tile image for a given ID the first time it’s needed:
+    // the attached pack first (a view, no decode or copy), else a load from the folder, done
+    // here or (streaming) queued on the background thread. Returns nullptr
+    // while the tile is pending and after it failed.
+    const PixelImage* getTileImage(int id) {
+        if (id < 0 || id >= MAX_TILE_ID) return nullptr;
+        tileSeen[id] = streamClock;
+        if (tileState[id] == TileState::Resident) return tilePix[id];
+        if (tileState[id] != TileState::Unloaded) return nullptr;
+
+        char filename[320];
+        tileFilename(id, filename);
+        PixelImage view;
+        if (pack && pack->viewPixels(filename, view)) {
+            adoptTileView(id, std::move(view));
+            return tilePix[id];
+        }
+        if (streamer) {
+            streamer->request(id, filename);
+            tileState[id] = TileState::Pending;
+            return nullptr;
+        }
 
-        // Attempt load
-        Image* img = new Image();
-        if (!img->load(string(filename))) {
-            delete img;
-            tileImg[id] = nullptr; // Remember failure to avoid repeated attempts
+        // Attempt load; a failure is remembered so it isn't retried every frame
+        Image img;
+        if (!img.load(string(filename))) {
+            tileState[id] = TileState::Failed;
             return nullptr;
         }
-        tileImg[id] = img;
-        return img;
+        adoptTileImage(id, img);
+        return tilePix[id];
+    }
+
+    // Normalizes a decoded (or packed) image for tile id; the size is checked
+    // here once, a mismatch marks the tile failed
+    void adoptTileImage(int id, const Image& img) {
+        tileOpacity[id] = -1;
+        PixelImage* pix = new PixelImage();
+        if ((int)img.width != tileW || (int)img.height != tileH || !pix->assign(img)) {
+            delete pix;
+            tileState[id] = TileState::Failed;
+            return;
+        }
+        tilePix[id] = pix;
+        tileState[id] = TileState::Resident;
+        imageBytes += pix->bytes();
+    }
+
+    // Same for a view into the attached pack: nothing is copied and the
+    // view owns no bytes, so it never counts against the image budget
+    void adoptTileView(int id, PixelImage&& view) {
+        tileOpacity[id] = -1;
+        if (view.getWidth() != tileW || view.getHeight() != tileH) {
+            tileState[id] = TileState::Failed;
+            return;
+        }
+        tilePix[id] = new PixelImage(std::move(view));
+        tileState[id] = TileState::Resident;
+    }
+
+    // Frees the image of tile id; it is loaded again on next use
+    void releaseTileImage(int id) {
+        imageBytes -= tilePix[id]->bytes();
+        delete tilePix[id];
+        tilePix[id] = nullptr;
+        tileState[id] = TileState::Unloaded;
+        tileOpacity[id] = -1;
+    }
+
+    // Frees the least recently drawn owned images that were not drawn for
+    // idleSeconds until the owned pixels fit the budget.
+    void evictIdleTiles() {
+        const double cutoff = streamClock - idleSeconds;
+        while (imageBytes > imageBudget) {
+            int victim = -1;
+            for (int id = 0; id < MAX_TILE_ID; ++id) {
+                if (!tilePix[id] || tilePix[id]->isView() || tileSeen[id] > cutoff) continue;
+                if (victim < 0 || tileSeen[id] < tileSeen[victim]) victim = id;
+            }
+            if (victim < 0) return;
+            releaseTileImage(victim);
+            ++evictions;
+        }
+    }
+
+    bool isPending(int id) const {
+        return id >= 0 && id < MAX_TILE_ID && tileState[id] == TileState::Pending;
+    }
+
+    // Collects every tile ID the loaded map references (each once, in
+    // storage order)
+    int referencedTiles(int* ids) const {
+        bool seen[MAX_TILE_ID] = {};
+        int n = 0;
+        const size_t count = cellCount();
+        for (size_t i = 0; i < count; ++i) {
+            const int id = cells[i];
+            if (id >= MAX_TILE_ID || seen[id]) continue;   // also skips kMapEmptyCell
+            seen[id] = true;
+            ids[n++] = id;
+        }
+        return n;
+    }
+
+    // Forgets every resolved image (folder or pack changed); requests still
+    // in flight are dropped
+    void resetTileViews() {
+        if (streamer) streamer->cancelAll();
+        for (int k = 0; k < MAX_TILE_ID; ++k) {
+            if (tilePix[k]) releaseTileImage(k);
+            tileState[k] = TileState::Unloaded; tileOpacity[k] = -1;
+        }
     }
 
 public:
-    // Tiles with IDs 14–22 are water and are considered blocking.
-    bool isBlockedId(int id) const { return id >= 14 && id <= 22; }
+    // Tiles with IDs 14–22 are water and are considered blocking, unless
+    // changed with setBlocking().
+    bool isBlockedId(int id) const { return id >= 0 && id < MAX_TILE_ID && blockingId[id]; }
 
-    // Checks if the tile at (tx, ty) is blocking.
-    // Out-of-bounds coordinates return false (handled by boundary logic elsewhere).
+    void setBlocking(int id, bool blocks) {
+        if (id < 0 || id >= MAX_TILE_ID || blockingId[id] == blocks) return;
+        blockingId[id] = blocks;
+        blockDirty = true;
+    }
+
+    // Checks if the tile at (tx, ty) is blocking, with get()'s wrapping and
+    // world rules. Out-of-bounds coordinates return false (handled by
+    // boundary logic elsewhere).
     bool isBlockedAt(int tx, int ty) const {
-        int id = get(tx, ty);
-        return (id >= 0) ? isBlockedId(id) : false;
+        if (!cells) return false;
+        if (tx < 0 || ty < 0 || tx >= width || ty >= height) {
+            if (world) return isBlockedId(world->get(tx, ty));
+            if (!wrap) return false;
+            tx %= width;  if (tx < 0) tx += width;
+            ty %= height; if (ty < 0) ty += height;
+        }
+        ensureBlockBits();
+        return (blockBits[(size_t)ty * blockWords + (tx >> 6)] >> (tx & 63)) & 1;
+    }
+
+    // Is any tile in columns [x0, x1] of row ty blocking? Map rows test whole
+    // 64-bit words of the bitset; tiles from an attached world are checked
+    // one by one.
+    bool anyBlockedInRow(int ty, int x0, int x1) const {
+        if (!cells || x0 > x1) return false;
+        if (world) {
+            const bool mapRow = ty >= 0 && ty < height;
+            for (int x = x0; x <= x1; ++x) {
+                if (mapRow && x >= 0 && x < width) {
+                    const int end = x1 < width - 1 ? x1 : width - 1;
+                    ensureBlockBits();
+                    if (rowBitsAny(ty, x, end)) return true;
+                    x = end;
+                }
+                else if (isBlockedId(world->get(x, ty))) return true;
+            }
+            return false;
+        }
+        if (wrap) {
+            ty %= height; if (ty < 0) ty += height;
+            ensureBlockBits();
+            if (x1 - x0 + 1 >= width) return rowBitsAny(ty, 0, width - 1);
+            int a = x0 % width; if (a < 0) a += width;
+            const int b = a + (x1 - x0);
+            if (b < width) return rowBitsAny(ty, a, b);
+            return rowBitsAny(ty, a, width - 1) || rowBitsAny(ty, 0, b - width);
+        }
+        if (ty < 0 || ty >= height) return false;
+        if (x0 < 0) x0 = 0;
+        if (x1 >= width) x1 = width - 1;
+        if (x0 > x1) return false;
+        ensureBlockBits();
+        return rowBitsAny(ty, x0, x1);
+    }
+
+    // Is any tile in rows [y0, y1] of column tx blocking? Same structure as
+    // anyBlockedInRow: the range is clipped or wrapped once, then map rows
+    // test one bit per bitset row; tiles from an attached world are checked
+    // one by one.
+    bool anyBlockedInColumn(int tx, int y0, int y1) const {
+        if (!cells || y0 > y1) return false;
+        if (world) {
+            const bool mapColumn = tx >= 0 && tx < width;
+            for (int y = y0; y <= y1; ++y) {
+                if (mapColumn && y >= 0 && y < height) {
+                    const int end = y1 < height - 1 ? y1 : height - 1;
+                    ensureBlockBits();
+                    if (columnBitsAny(tx, y, end)) return true;
+                    y = end;
+                }
+                else if (isBlockedId(world->get(tx, y))) return true;
+            }
+            return false;
+        }
+        if (wrap) {
+            if (tx < 0 || tx >= width) { tx %= width; if (tx < 0) tx += width; }
+            ensureBlockBits();
+            if (y1 - y0 + 1 >= height) return columnBitsAny(tx, 0, height - 1);
+            int a = y0;
+            if (a < 0 || a >= height) { a %= height; if (a < 0) a += height; }
+            const int b = a + (y1 - y0);
+            if (b < height) return columnBitsAny(tx, a, b);
+            return columnBitsAny(tx, a, height - 1) || columnBitsAny(tx, 0, b - height);
+        }
+        if (tx < 0 || tx >= width) return false;
+        if (y0 < 0) y0 = 0;
+        if (y1 >= height) y1 = height - 1;
+        if (y0 > y1) return false;
+        ensureBlockBits();
+        return columnBitsAny(tx, y0, y1);
+    }
+
+    // Is any tile in [x0, x1] x [y0, y1] blocking?
+    bool anyBlockedInRect(int x0, int y0, int x1, int y1) const {
+        for (int y = y0; y <= y1; ++y)
+            if (anyBlockedInRow(y, x0, x1)) return true;
+        return false;
     }
 
     // Tile size accessors
@@ -112,20 +425,26 @@ public:
     int getHeight() const { return height; }
 
     // Wrap behavior controls infinite map looping
-    void setWrap(bool v) { wrap = v; }
+    void setWrap(bool v) { if (wrap != v) ++revision; wrap = v; }
     bool isWrap() const { return wrap; }
 
+    // Tiles outside [0, width) x [0, height) come from `w` (not owned) instead
+    // of wrapping or being empty; the loaded map stays the home area at the
+    // origin. The caller keeps w->update() following the camera. nullptr
+    // detaches.
+    void attachWorld(ChunkedWorld* w) {
+        world = w;
+        ++revision;
+    }
+    ChunkedWorld* getWorld() const { return world; }
+
+    // Changes whenever the rendered map may look different
+    unsigned int getRevision() const { return revision; }
+
     // Constructor / destructor
     TileMap() { initCache(); }
     ~TileMap() {
-        delete[] data;
-        for (int i = 0; i < MAX_TILE_ID; ++i) {
-            if (tileImg[i]) {
-                tileImg[i]->~Image();
-                delete tileImg[i];
-                tileImg[i] = nullptr;
-            }
-        }
+        for (int i = 0; i < MAX_TILE_ID; ++i) delete tilePix[i];
     }
 
     // Sets the folder containing tile images. Should end with a slash for convenience.
@@ -133,63 +452,385 @@ public:
         int i = 0;
         for (; path[i] && i < 259; ++i) folder[i] = path[i];
         folder[i] = '\0';
+        for (int k = 0; k < MAX_TILE_ID; ++k) tileSlot[k] = -1; // slots describe the old folder
+        resetTileViews();
+        atlas = nullptr;
+        ++revision;
     }
 
-    // Loads map data from a "tiles.txt" file
-    // Expected format includes:
+    // Queues every tile ID the loaded map references into `into` (call
+    // before into.build()). Resident tiles are copied from their normalized
+    // image; others are loaded, copied and released here, so nothing new
+    // stays in the per-tile cache. Returns the number of tiles added.
+    int addTilesToAtlas(TextureAtlas& into) {
+        if (!cells) return 0;
+        int ids[MAX_TILE_ID];
+        const int n = referencedTiles(ids);
+        int added = 0;
+        for (int i = 0; i < n; ++i) {
+            const int id = ids[i];
+
+            if (tileState[id] == TileState::Resident) {
+                tileSlot[id] = into.add(*tilePix[id]);
+                if (tileSlot[id] >= 0) ++added;
+                continue;
+            }
+            char filename[320];
+            tileFilename(id, filename);
+            const Image* src = pack ? pack->find(filename) : nullptr;
+            Image img;
+            if (!src) {
+                if (!img.load(string(filename))) continue;
+                src = &img;
+            }
+            if ((int)src->width != tileW || (int)src->height != tileH) continue; // drawn as fallback
+            tileSlot[id] = into.add(*src);
+            if (tileSlot[id] >= 0) ++added;
+        }
+        return added;
+    }
+
+    // Decodes every referenced tile that isn't resolved yet (and isn't in the
+    // attached pack) on `threads` workers, so nothing is decoded mid-play.
+    // Returns the number of tiles loaded.
+    int preloadTiles(int threads = 0) {
+        if (!cells) return 0;
+        int ids[MAX_TILE_ID];
+        const int n = referencedTiles(ids);
+        std::vector<int> todo;
+        std::vector<std::string> paths;
+        for (int i = 0; i < n; ++i) {
+            const int id = ids[i];
+            if (tileState[id] != TileState::Unloaded) continue;   // resolved or pending
+            char filename[320];
+            tileFilename(id, filename);
+            if (pack && pack->find(filename)) continue;   // resolved on first use, no decode
+            todo.push_back(id);
+            paths.push_back(filename);
+        }
+        std::vector<std::unique_ptr<Image>> images;
+        const int loaded = loadImagesParallel(paths, images, threads);
+        for (size_t i = 0; i < todo.size(); ++i) {
+            const int id = todo[i];
+            if (images[i]) adoptTileImage(id, *images[i]);
+            else tileState[id] = TileState::Failed;
+        }
+        return loaded;
+    }
+
+    // Streaming mode: tiles seen for the first time are decoded on a
+    // background thread and drawn as their idToColor placeholder until
+    // pumpStreaming() installs them. Owned images above `budgetBytes` are
+    // evicted once they have not been drawn for `idleSecs`.
+    void enableStreaming(size_t budgetBytes = 64u << 20, double idleSecs = 30.0) {
+        imageBudget = budgetBytes;
+        idleSeconds = idleSecs;
+        if (!streamer) streamer.reset(new TileStreamer());
+    }
+
+    // Back to loading on first use; pending tiles are requested again
+    void disableStreaming() {
+        if (!streamer) return;
+        streamer.reset();
+        for (int k = 0; k < MAX_TILE_ID; ++k)
+            if (tileState[k] == TileState::Pending) tileState[k] = TileState::Unloaded;
+        ++revision;
+    }
+    bool isStreaming() const { return streamer != nullptr; }
+
+    // Call once per frame before drawing: installs finished loads (files the
+    // PNG decoder rejected get one synchronous Image::load) and applies the
+    // memory budget.
+    // Returns the number of tiles that became resident.
+    int pumpStreaming() {
+        using namespace std::chrono;
+        streamClock = duration<double>(steady_clock::now().time_since_epoch()).count();
+        if (!streamer) return 0;
+
+        arrivals.clear();
+        int arrived = 0;
+        if (streamer->collect(arrivals) > 0) {
+            for (TileStreamer::Result& r : arrivals) {
+                if (tileState[r.id] != TileState::Pending) continue;
+                if (!r.image) {
+                    r.image.reset(new Image());
+                    if (!r.image->load(r.path)) r.image.reset();
+                }
+                tileOpacity[r.id] = -1;
+                if (r.image) adoptTileImage(r.id, *r.image);
+                else tileState[r.id] = TileState::Failed;
+                if (tileState[r.id] == TileState::Resident) ++arrived;
+            }
+            ++revision;
+        }
+        evictIdleTiles();
+        return arrived;
+    }
+
+    // Streaming counters
+    int pendingTiles() const { return streamer ? streamer->inFlight() : 0; }
+    size_t residentImageBytes() const { return imageBytes; }
+    int evictedTiles() const { return evictions; }
+
+    // Draws tiles from `a` (built, filled by addTilesToAtlas) from now on.
+    // nullptr goes back to per-tile images.
+    void attachAtlas(const TextureAtlas* a) {
+        atlas = (a && a->built()) ? a : nullptr;
+        for (int k = 0; k < MAX_TILE_ID; ++k) tileOpacity[k] = -1;
+        ++revision;
+    }
+    bool hasAtlas() const { return atlas != nullptr; }
+
+    // Takes tile images from `p` (opened, must outlive the map or be detached
+    // with nullptr) instead of decoding "<folder><id>.png" on first use
+    void attachAssetPack(const AssetPack* p) {
+        pack = (p && p->isOpen()) ? p : nullptr;
+        resetTileViews();
+        ++revision;
+    }
+
+    // True if drawTile(id) writes every pixel of its cell: atlas regions
+    // flagged opaque, images with no alpha below the blit cutoff, and the
+    // gray fallback. Off-map cells (id < 0) are never covered.
+    bool isTileOpaque(int id) {
+        if (id < 0 || id >= MAX_TILE_ID) return false;
+        if (tileOpacity[id] >= 0) return tileOpacity[id] != 0;
+        bool opaque = true;
+        if (atlas && tileSlot[id] >= 0) opaque = atlas->rect(tileSlot[id]).opaque;
+        else if (const PixelImage* img = getTileImage(id))
+            opaque = img->coverage() == PixelImage::Opaque;
+        tileOpacity[id] = opaque ? 1 : 0;
+        return opaque;
+    }
+
+    // Zeroes the cells of dst (camera as in draw()) that draw() will not
+    // fully cover: off-map area in fixed mode and tiles with transparent
+    // pixels. Together with draw() this gives the same pixels as clearing
+    // dst first. Returns the bytes written.
+    long long clearUncovered(const Surface& dst, float camX, float camY) {
+        const int cx = (int)camX, cy = (int)camY;
+        const int W = dst.width, H = dst.height;
+        if (W <= 0 || H <= 0) return 0;
+        auto floorDiv = [](int a, int b) { return a >= 0 ? a / b : -((-a + b - 1) / b); };
+        const int gx0 = floorDiv(cx, tileW), gx1 = floorDiv(cx + W - 1, tileW);
+        const int gy0 = floorDiv(cy, tileH), gy1 = floorDiv(cy + H - 1, tileH);
+        long long cleared = 0;
+        for (int gy = gy0; gy <= gy1; ++gy) {
+            int y0 = gy * tileH - cy, y1 = y0 + tileH;
+            if (y0 < 0) y0 = 0; if (y1 > H) y1 = H;
+            for (int gx = gx0; gx <= gx1; ) {
+                if (isTileOpaque(get(gx, gy))) { ++gx; continue; }
+                // Merge a run of uncovered cells into one memset per row
+                int run = gx + 1;
+                while (run <= gx1 && !isTileOpaque(get(run, gy))) ++run;
+                int x0 = gx * tileW - cx, x1 = run * tileW - cx;
+                if (x0 < 0) x0 = 0; if (x1 > W) x1 = W;
+                for (int y = y0; y < y1; ++y) memset(dst.row(y) + (size_t)x0 * 3, 0, (size_t)(x1 - x0) * 3);
+                cleared += (long long)(x1 - x0) * 3 * (y1 - y0);
+                gx = run;
+            }
+        }
+        return cleared;
+    }
+
+    // Draws one tile at (x, y): atlas region, else the normalized tile image,
+    // else the idToColor placeholder while it streams in, else a gray fill
+    // (missing image or mismatched size).
+    void drawTile(const Surface& dst, int id, int x, int y) {
+        if (atlas && id >= 0 && id < MAX_TILE_ID && tileSlot[id] >= 0) {
+            atlas->draw(dst, tileSlot[id], x, y);
+            return;
+        }
+        if (const PixelImage* img = getTileImage(id))
+            blitImage(dst, *img, x, y);
+        else if (isPending(id)) {
+            unsigned char r, g, b;
+            idToColor(id, r, g, b);
+            fillRect(dst, x, y, tileW, tileH, r, g, b);
+        }
+        else
+            fillRect(dst, x, y, tileW, tileH, 40, 40, 40);
+    }
+
+    // Loads map data from a compiled binary map (see MapFile.h; detected by
+    // its magic) or from a "tiles.txt" file.
+    // Expected text format includes:
     //   tileswide, tileshigh, tilewidth, tileheight
     // followed by layer data as a grid of integers
+    // Layer data goes through IntListParser over the mapped file; malformed
+    // input fails with its line and column in getLoadError(). The file is
+    // parsed into locals, so a failed load keeps the current map.
     bool load(const char* path) {
-        std::ifstream f(path);
-        if (!f) return false;
+        loadError.clear();
+        MappedFile file;
+        if (!file.open(path)) return loadFailed(path, "cannot open file");
+        const char* text = (const char*)file.data();
+        const size_t len = file.size();
+        if (len >= 4 && memcmp(text, "GEMP", 4) == 0) {
+            file.close();
+            if (loadBinary(path)) return true;
+            return loadFailed(path, "invalid or truncated binary map");
+        }
 
-        std::string line;
+        // Header: "key value" lines up to "layer"
         bool haveW = false, haveH = false, haveTW = false, haveTH = false;
-
-        while (std::getline(f, line)) {
-            if (line.empty()) continue;
-            std::istringstream ss(line);
+        int w = 0, h = 0, tw = 0, th = 0;
+        size_t at = 0;
+        while (at < len) {
+            size_t eol = at;
+            while (eol < len && text[eol] != '\n') ++eol;
+            std::istringstream ss(std::string(text + at, eol - at));
+            at = eol < len ? eol + 1 : len;
             std::string key; ss >> key;
-            if (key == "tileswide") { ss >> width;  haveW = (width > 0); }
-            else if (key == "tileshigh") { ss >> height; haveH = (height > 0); }
-            else if (key == "tilewidth") { ss >> tileW;  haveTW = (tileW > 0); }
-            else if (key == "tileheight") { ss >> tileH; haveTH = (tileH > 0); }
+            if (key == "tileswide") { ss >> w;  haveW = (w > 0); }
+            else if (key == "tileshigh") { ss >> h; haveH = (h > 0); }
+            else if (key == "tilewidth") { ss >> tw;  haveTW = (tw > 0); }
+            else if (key == "tileheight") { ss >> th; haveTH = (th > 0); }
             else if (key == "layer") { break; }
         }
 
-        if (!(haveW && haveH && haveTW && haveTH)) return false;
+        if (!(haveW && haveH && haveTW && haveTH)) return loadFailed(path, "missing tileswide/tileshigh/tilewidth/tileheight");
+        if (w > 0x7FFF0000 / h) return loadFailed(path, "map too large");
 
-        delete[] data;
-        data = new int[width * height];
-        int idx = 0;
+        const int cw = (w + kMapChunkTiles - 1) >> kMapChunkShift;
+        const int ch = (h + kMapChunkTiles - 1) >> kMapChunkShift;
+        std::vector<uint16_t> parsed((size_t)cw * ch * kMapChunkCells, kMapEmptyCell);
+        const int total = w * h;
+        int idx = 0, x = 0, y = 0;
 
-        while (idx < width * height && std::getline(f, line)) {
-            if (line.empty()) continue;
-            idx += parseInts(line, data + idx, width * height - idx);
+        IntListParser parser(text, len, at);
+        int batch[4096];
+        while (idx < total) {
+            const int n = parser.next(batch, total - idx < 4096 ? total - idx : 4096);
+            if (n == 0) break;
+            for (int i = 0; i < n; ++i) {
+                parsed[cellIndexIn(cw, x, y)] = toCell(batch[i]);
+                if (++x == w) { x = 0; ++y; }
+            }
+            idx += n;
+        }
+        if (parser.failed()) {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "line %d, column %d: %s", parser.errorLine(), parser.errorColumn(), parser.error());
+            return loadFailed(path, msg);
+        }
+        if (idx != total) {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "layer has %d of %d tiles", idx, total);
+            return loadFailed(path, msg);
         }
-        return (idx == width * height);
+
+        resetCells(w, h);
+        tileW = tw; tileH = th;
+        ownedCells.swap(parsed);
+        cells = ownedCells.data();
+        ++revision;
+        return true;
+    }
+
+    // Why the last load() failed ("" after a success)
+    const std::string& getLoadError() const { return loadError; }
+
+    // Maps a compiled binary map (see MapFile.h). The pages are private
+    // copy-on-write, so set() works and never touches the file. On failure
+    // the current map is kept.
+    bool loadBinary(const char* path) {
+        MappedFile file;
+        if (!file.open(path, true)) return false;
+        MapFileHeader hd;
+        if (file.size() < sizeof(hd)) return false;
+        memcpy(&hd, file.data(), sizeof(hd));
+        const uint64_t cx = ((uint64_t)hd.width + kMapChunkTiles - 1) >> kMapChunkShift;
+        const uint64_t cy = ((uint64_t)hd.height + kMapChunkTiles - 1) >> kMapChunkShift;
+        const uint64_t cellBytes = cx * cy * kMapChunkCells * sizeof(uint16_t);
+        if (memcmp(hd.magic, "GEMP", 4) != 0 || hd.version != kMapFileVersion ||
+            hd.chunkTiles != (uint32_t)kMapChunkTiles || hd.fileBytes != file.size() ||
+            hd.width == 0 || hd.height == 0 || hd.width > 0x7FFF0000u / hd.height ||
+            hd.tileW == 0 || hd.tileH == 0 || hd.tileW > 4096 || hd.tileH > 4096 ||
+            hd.chunksX != cx || hd.chunksY != cy || hd.cellOffset % 64 != 0 ||
+            hd.cellOffset > file.size() || file.size() - hd.cellOffset < cellBytes)
+            return false;
+
+        resetCells((int)hd.width, (int)hd.height);
+        tileW = (int)hd.tileW; tileH = (int)hd.tileH;
+        mapped = std::move(file);
+        cells = (uint16_t*)(mapped.data() + hd.cellOffset);
+        ++revision;
+        return true;
+    }
+
+    // Writes the map in the compiled binary format (see MapFile.h)
+    bool saveBinary(const char* path) const {
+        if (!cells) return false;
+        MapFileHeader hd;
+        memset(&hd, 0, sizeof(hd));
+        memcpy(hd.magic, "GEMP", 4);
+        hd.version = kMapFileVersion;
+        hd.width = (uint32_t)width; hd.height = (uint32_t)height;
+        hd.tileW = (uint32_t)tileW; hd.tileH = (uint32_t)tileH;
+        hd.chunkTiles = (uint32_t)kMapChunkTiles;
+        hd.chunksX = (uint32_t)chunksX; hd.chunksY = (uint32_t)chunksY;
+        hd.cellOffset = 64;
+        hd.fileBytes = hd.cellOffset + cellCount() * sizeof(uint16_t);
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) return false;
+        static const char zeros[64] = {};
+        out.write((const char*)&hd, sizeof(hd));
+        out.write(zeros, (std::streamsize)(hd.cellOffset - sizeof(hd)));
+        out.write((const char*)cells, (std::streamsize)(cellCount() * sizeof(uint16_t)));
+        return (bool)out;
     }
 
     // Retrieves a tile ID at (x, y).
-    // In wrap mode, coordinates are wrapped using modular arithmetic.
+    // Outside the map, an attached world answers; otherwise in wrap mode,
+    // coordinates are wrapped using modular arithmetic.
     int get(int x, int y) const {
-        if (!data) return -1;
-        if (!wrap) {
-            if (x < 0 || y < 0 || x >= width || y >= height) return -1;
-            return data[y * width + x];
+        if (!cells) return -1;
+        if (x < 0 || y < 0 || x >= width || y >= height) {
+            if (world) return world->get(x, y);
+            if (!wrap) return -1;
+            x %= width;  if (x < 0) x += width;
+            y %= height; if (y < 0) y += height;
         }
-        else {
-            if (width <= 0 || height <= 0) return -1;
-            int wx = x % width;  if (wx < 0) wx += width;
-            int wy = y % height; if (wy < 0) wy += height;
-            return data[wy * width + wx];
+        const uint16_t c = cells[cellIndex(x, y)];
+        return c == kMapEmptyCell ? -1 : (int)c;
+    }
+
+    // Changes the tile ID at (x, y), with the same wrapping rules as get().
+    // Returns false for out-of-map coordinates in fixed mode.
+    bool set(int x, int y, int id) {
+        if (!cells || width <= 0 || height <= 0) return false;
+        if (world && (x < 0 || y < 0 || x >= width || y >= height)) {
+            if (world->set(x, y, id)) ++revision;
+            return true;
         }
+        if (wrap) {
+            x %= width;  if (x < 0) x += width;
+            y %= height; if (y < 0) y += height;
+        }
+        else if (x < 0 || y < 0 || x >= width || y >= height) return false;
+
+        uint16_t& cell = cells[cellIndex(x, y)];
+        if (cell == toCell(id)) return true;
+        cell = toCell(id);
+        if (!blockDirty) {
+            uint64_t& word = blockBits[(size_t)y * blockWords + (x >> 6)];
+            const uint64_t bit = 1ull << (x & 63);
+            word = isBlockedId(id) ? (word | bit) : (word & ~bit);
+        }
+        ++revision;
+        return true;
     }
 
     // Renders visible portion of the map relative to the camera
     void draw(Window& window, float camX, float camY) {
-        if (!data) return;
-        int W = (int)window.getWidth(), H = (int)window.getHeight();
+        draw(Surface::of(window), camX, camY);
+    }
+
+    void draw(const Surface& dst, float camX, float camY) {
+        if (!cells) return;
+        int W = dst.width, H = dst.height;
 
         int startTileX = (int)std::floor(camX / tileW) - 1;
         int startTileY = (int)std::floor(camY / tileH) - 1;
@@ -206,15 +847,46 @@ public:
                 int sx = gx * tileW - (int)camX;
                 int sy = gy * tileH - (int)camY;
 
-                Image* img = getTileImage(id);
-                if (img && (int)img->width == tileW && (int)img->height == tileH) {
-                    blitImage(window, *img, sx, sy);
+                drawTile(dst, id, sx, sy);
+            }
+        }
+    }
+
+    // Records the per-tile path of draw() (one blit or fill per visible tile)
+    // for the banded renderer. Tile images are loaded here, on the recording
+    // thread, so rasterizing never touches the lazy cache.
+    void record(FrameCommands& out, int viewW, int viewH, float camX, float camY) {
+        if (!cells) return;
+        int startTileX = (int)std::floor(camX / tileW) - 1;
+        int startTileY = (int)std::floor(camY / tileH) - 1;
+        int tilesX = viewW / tileW + 3;
+        int tilesY = viewH / tileH + 3;
+
+        for (int ty = 0; ty < tilesY; ++ty) {
+            for (int tx = 0; tx < tilesX; ++tx) {
+                int gx = startTileX + tx;
+                int gy = startTileY + ty;
+                int id = get(gx, gy);
+                if (id < 0) continue;
+
+                int sx = gx * tileW - (int)camX;
+                int sy = gy * tileH - (int)camY;
+                if (sx + tileW <= 0 || sy + tileH <= 0 || sx >= viewW || sy >= viewH) continue;
+
+                if (atlas && id < MAX_TILE_ID && tileSlot[id] >= 0) {
+                    const TextureAtlas::Rect& r = atlas->rect(tileSlot[id]);
+                    out.blitSub(atlas->page(r), r.x, r.y, r.w, r.h, sx, sy);
+                    continue;
                 }
-                else {
-                    // Fallback: fill with gray if image missing or mismatched size
-                    unsigned char r = 40, g = 40, b = 40;
-                    fillRect(window, sx, sy, tileW, tileH, r, g, b);
+                if (const PixelImage* img = getTileImage(id))
+                    out.blit(*img, sx, sy);
+                else if (isPending(id)) {
+                    unsigned char r, g, b;
+                    idToColor(id, r, g, b);
+                    out.fillRect(sx, sy, tileW, tileH, r, g, b);
                 }
+                else
+                    out.fillRect(sx, sy, tileW, tileH, 40, 40, 40);
             }
         }
     }
@@ -0,0 +1,76 @@
+﻿#include "TileStreamer.h"
+#include "PngDecoder.h"
+using namespace GamesEngineeringBase;
+
+TileStreamer::TileStreamer()
+{
+    worker = std::thread(&TileStreamer::run, this);
+}
+
+TileStreamer::~TileStreamer()
+{
+    {
+        std::lock_guard<std::mutex> g(lock);
+        quit = true;
+        queue.clear();
+    }
+    wake.notify_all();
+    worker.join();
+}
+
+void TileStreamer::request(int id, const std::string& path)
+{
+    {
+        std::lock_guard<std::mutex> g(lock);
+        queue.push_back(Job{ id, path, generation });
+    }
+    wake.notify_one();
+}
+
+int TileStreamer::collect(std::vector<Result>& out)
+{
+    std::lock_guard<std::mutex> g(lock);
+    const int n = (int)done.size();
+    for (Result& r : done) out.push_back(std::move(r));
+    done.clear();
+    return n;
+}
+
+void TileStreamer::cancelAll()
+{
+    std::lock_guard<std::mutex> g(lock);
+    ++generation;
+    queue.clear();
+    done.clear();
+}
+
+int TileStreamer::inFlight() const
+{
+    std::lock_guard<std::mutex> g(lock);
+    return (int)(queue.size() + done.size()) + busy;
+}
+
+/* Worker ----------------------------------------------------------------------
+ * Decodes one job at a time with the lock released; a result whose
+ * generation is stale by the time it finishes is thrown away.
+ * ---------------------------------------------------------------------------*/
+void TileStreamer::run()
+{
+    std::unique_lock<std::mutex> g(lock);
+    for (;;) {
+        wake.wait(g, [this] { return quit || !queue.empty(); });
+        if (quit) return;
+        Job job = std::move(queue.front());
+        queue.pop_front();
+        ++busy;
+        g.unlock();
+
+        std::unique_ptr<Image> img(new Image());
+        if (!decodePNGFile(job.path, img->width, img->height, img->channels, img->data)) img.reset();
+
+        g.lock();
+        --busy;
+        if (job.generation == generation)
+            done.push_back(Result{ job.id, std::move(job.path), std::move(img) });
+    }
+}
@@ -0,0 +1,58 @@
+﻿#pragma once
+#include "Image.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*******************************  TileStreamer  ********************************
+ * Background I/O thread for TileMap's streaming mode.
+ *   - request() queues a file; the worker decodes it (PngDecoder) off the
+ *     game thread. collect() hands finished loads back without blocking.
+ *   - A failed decode comes back with a null image; the caller decides
+ *     whether to retry (TileMap tries Image::load once, then marks it failed).
+ *   - cancelAll() drops queued work and discards anything still in flight,
+ *     e.g. when the tile folder changes.
+ *******************************************************************************/
+class TileStreamer
+{
+public:
+    struct Result
+    {
+        int id;
+        std::string path;
+        std::unique_ptr<GamesEngineeringBase::Image> image;   // nullptr = decode failed
+    };
+
+    TileStreamer();
+    ~TileStreamer();                  // joins the worker; unfinished requests are dropped
+    TileStreamer(const TileStreamer&) = delete;
+    TileStreamer& operator=(const TileStreamer&) = delete;
+
+    void request(int id, const std::string& path);
+
+    // Appends every finished load to `out`; returns how many were added
+    int collect(std::vector<Result>& out);
+
+    void cancelAll();
+
+    // Requests not collected yet (queued, decoding or finished)
+    int inFlight() const;
+
+private:
+    struct Job { int id; std::string path; unsigned int generation; };
+
+    mutable std::mutex lock;
+    std::condition_variable wake;
+    std::deque<Job> queue;
+    std::vector<Result> done;
+    unsigned int generation = 0;      // bumped by cancelAll; stale results are dropped
+    int busy = 0;                     // jobs taken by the worker, not yet in `done`
+    bool quit = false;
+    std::thread worker;
+
+    void run();
+};
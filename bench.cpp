@@ -0,0 +1,1744 @@
+﻿#include "bench.h"
+#include "GamesEngineeringBase.h"
+#include "Surface.h"
+#include "blit.h"
+#include "blit32.h"
+#include "SpanSprite.h"
+#include "TileMap.h"
+#include "ScrollingBackground.h"
+#include "DirtyRects.h"
+#include "gfx_utils.h"
+#include "FrameCommands.h"
+#include "TextureAtlas.h"
+#include "GlyphCache.h"
+#include "HudLayer.h"
+#include "AssetPack.h"
+#include "PngDecoder.h"
+#include "PixelImage.h"
+#include "IntListParser.h"
+#include "MappedFile.h"
+#include "ChunkedWorld.h"
+#include "FlowField.h"
+#include "NPCStore.h"
+#include "Pool.h"
+#include "NPCSystem.h"
+#include "Player.h"
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <algorithm>
+using namespace GamesEngineeringBase;
+
+/* Shared helpers --------------------------------------------------------------
+ * Wall-clock timing plus deterministic synthetic assets, so numbers do not
+ * depend on which PNGs happen to be on disk.
+ * ---------------------------------------------------------------------------*/
+static double nowSeconds()
+{
+    using namespace std::chrono;
+    return duration<double>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Repeats `fn` until at least `minSeconds` elapsed; returns seconds per call.
+template <typename Fn>
+static double timePerCall(Fn fn, double minSeconds = 0.25)
+{
+    fn(); // warm caches and lazy dispatch
+    int calls = 0;
+    double t0 = nowSeconds(), t1 = t0;
+    do { fn(); ++calls; t1 = nowSeconds(); } while (t1 - t0 < minSeconds);
+    return (t1 - t0) / calls;
+}
+
+static unsigned int benchRand(unsigned int& s)
+{
+    s = s * 1664525u + 1013904223u;
+    return s >> 8;
+}
+
+// 4-channel image; `opaquePercent` of pixels get alpha 255, the rest alpha 0,
+// laid out in short runs like the outline of a sprite.
+static void makeRGBA(Image& img, int w, int h, int opaquePercent, unsigned int seed)
+{
+    img.free();
+    img.width = w; img.height = h; img.channels = 4;
+    img.data = new unsigned char[(size_t)w * h * 4];
+    for (int y = 0; y < h; ++y) {
+        bool opaque = false;
+        for (int x = 0; x < w; ++x) {
+            if ((x & 3) == 0) opaque = (int)(benchRand(seed) % 100) < opaquePercent;
+            unsigned char* p = img.data + ((size_t)y * w + x) * 4;
+            p[0] = (unsigned char)benchRand(seed);
+            p[1] = (unsigned char)benchRand(seed);
+            p[2] = (unsigned char)benchRand(seed);
+            p[3] = opaque ? 255 : 0;
+        }
+    }
+}
+
+/* blit ------------------------------------------------------------------------
+ * Tiles a 960x540 surface with 32x32 sprites, comparing the original
+ * per-pixel loop (alphaAtUnchecked + atUnchecked + 3-byte write) against
+ * every row kernel this CPU supports. Reports source pixels per second.
+ * ---------------------------------------------------------------------------*/
+static void referenceBlit(const Surface& dst, const Image& img, int dstX, int dstY)
+{
+    int x0 = dstX, y0 = dstY, x1 = dstX + (int)img.width, y1 = dstY + (int)img.height;
+    if (x0 >= dst.width || y0 >= dst.height || x1 <= 0 || y1 <= 0) return;
+    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
+    if (x1 > dst.width) x1 = dst.width; if (y1 > dst.height) y1 = dst.height;
+    for (int y = y0; y < y1; ++y) {
+        int base = y * dst.width;
+        for (int x = x0; x < x1; ++x) {
+            unsigned char a = img.alphaAtUnchecked(x - dstX, y - dstY);
+            if (a < 16) continue;
+            unsigned char* p = img.atUnchecked(x - dstX, y - dstY);
+            unsigned char* d = dst.pixels + (size_t)(base + x) * 3;
+            d[0] = p[0]; d[1] = p[1]; d[2] = p[2];
+        }
+    }
+}
+
+static void benchBlit()
+{
+    const int W = 960, H = 540, T = 32;
+    std::vector<unsigned char> buf((size_t)W * H * 3, 0);
+    Surface dst = Surface::wrap(buf.data(), W, H);
+
+    struct Case { const char* name; int opaque; };
+    const Case cases[] = { { "tile (100% opaque)", 100 }, { "sprite (55% opaque)", 55 }, { "sparse (10% opaque)", 10 } };
+
+    printf("[blit] %dx%d surface, %dx%d RGBA sources, detected isa=%s\n",
+        W, H, T, T, blitIsaName(blitDetectIsa()));
+    const BlitIsa best = blitDetectIsa();
+
+    for (const Case& c : cases) {
+        Image img;
+        makeRGBA(img, T, T, c.opaque, 1234u);
+        const double pixels = (double)W * H; // the grid covers the surface exactly once
+
+        double ref = timePerCall([&] {
+            for (int y = -7; y < H; y += T)
+                for (int x = -5; x < W; x += T) referenceBlit(dst, img, x, y);
+        });
+        printf("  %-22s %-10s %8.1f Mpx/s\n", c.name, "per-pixel", pixels / ref * 1e-6);
+
+        for (int isa = 0; isa <= (int)best; ++isa) {
+            blitSelectIsa((BlitIsa)isa);
+            double t = timePerCall([&] {
+                for (int y = -7; y < H; y += T)
+                    for (int x = -5; x < W; x += T) blitImage(dst, img, x, y);
+            });
+            printf("  %-22s %-10s %8.1f Mpx/s  (x%.2f)\n", c.name, blitIsaName((BlitIsa)isa),
+                pixels / t * 1e-6, ref / t);
+        }
+        blitSelectIsa(best);
+    }
+}
+
+/* spans -----------------------------------------------------------------------
+ * Character-style sprites (elliptical silhouette, 16x32 like the hero frames)
+ * drawn over the whole surface: blitSubImage() with the best row kernel vs the
+ * pre-encoded SpanSprite path.
+ * ---------------------------------------------------------------------------*/
+static void makeSilhouette(Image& img, int w, int h, unsigned int seed)
+{
+    makeRGBA(img, w, h, 100, seed);
+    for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x) {
+            float nx = (x + 0.5f - w * 0.5f) / (w * 0.5f);
+            float ny = (y + 0.5f - h * 0.5f) / (h * 0.5f);
+            img.data[((size_t)y * w + x) * 4 + 3] = (nx * nx + ny * ny <= 1.f) ? 255 : 0;
+        }
+}
+
+static void benchSpans()
+{
+    const int W = 960, H = 540, FW = 16, FH = 32;
+    std::vector<unsigned char> buf((size_t)W * H * 3, 0);
+    Surface dst = Surface::wrap(buf.data(), W, H);
+
+    Image img;
+    makeSilhouette(img, FW, FH, 99u);
+    SpanSprite spr;
+    spr.encode(img);
+
+    printf("[spans] %dx%d silhouette: %d spans, %d opaque px (%.0f%%), %zu bytes encoded vs %d RGBA\n",
+        FW, FH, spr.spanCount(), spr.opaqueCount(), 100.0 * spr.opaqueCount() / (FW * FH),
+        (size_t)spr.opaqueCount() * 3 + (size_t)spr.spanCount() * sizeof(SpanSprite::Span), FW * FH * 4);
+
+    const double pixels = (double)W * H;
+    double tBlit = timePerCall([&] {
+        for (int y = -3; y < H; y += FH)
+            for (int x = -9; x < W; x += FW) blitImage(dst, img, x, y);
+    });
+    double tSpan = timePerCall([&] {
+        for (int y = -3; y < H; y += FH)
+            for (int x = -9; x < W; x += FW) spr.draw(dst, x, y);
+    });
+    printf("  blitSubImage (%s)  %8.1f Mpx/s\n", blitIsaName(blitActiveIsa()), pixels / tBlit * 1e-6);
+    printf("  SpanSprite          %8.1f Mpx/s  (x%.2f)\n", pixels / tSpan * 1e-6, tBlit / tSpan);
+}
+
+/* Scrolling background --------------------------------------------------------
+ * Camera pans a few pixels per frame (walking speed); full = clear + map.draw,
+ * scroll = ScrollingBackground update + composite.
+ * ---------------------------------------------------------------------------*/
+static void benchScroll()
+{
+    const int W = 960, H = 540;
+    TileMap map;
+    if (!map.load("Resources/tiles.txt")) { printf("[scroll] Resources/tiles.txt not found, skipped\n"); return; }
+    map.setImageFolder("Resources/");
+
+    std::vector<unsigned char> buf((size_t)W * H * 3, 0);
+    Surface dst = Surface::wrap(buf.data(), W, H);
+    printf("[scroll] %dx%d surface, camera pans 4px/frame diagonally\n", W, H);
+
+    for (int wrap = 0; wrap < 2; ++wrap) {
+        map.setWrap(wrap != 0);
+        const int range = wrap ? 4000 : map.getPixelWidth() - W;
+        int step = 0;
+        auto camAt = [&](int s) { int t = (s * 4) % (2 * range); return (float)(t < range ? t : 2 * range - t); };
+
+        step = 0;
+        double tFull = timePerCall([&] {
+            float cam = camAt(step++);
+            memset(buf.data(), 0, buf.size());
+            map.draw(dst, cam, cam * 0.5f);
+        });
+
+        ScrollingBackground bg;
+        long long px = 0, cleared = 0; int frames = 0;
+        step = 0;
+        double tScroll = timePerCall([&] {
+            float cam = camAt(step++);
+            bg.update(map, cam, cam * 0.5f, W, H);
+            bg.composite(dst);
+            px += bg.redrawnPixels(); cleared += bg.clearedBytes(); ++frames;
+        });
+
+        printf("  %-6s full %7.3f ms   scroll %7.3f ms  (x%.2f)  redrawn %.0f px/frame (%.1f%%), cleared %.0f B/frame\n",
+            wrap ? "wrap" : "fixed", tFull * 1e3, tScroll * 1e3, tFull / tScroll,
+            (double)px / frames, 100.0 * px / frames / ((double)W * H), (double)cleared / frames);
+
+        // Coverage clear vs a full memset, including cameras past the map edge
+        std::vector<unsigned char> ref((size_t)W * H * 3);
+        Surface refDst = Surface::wrap(ref.data(), W, H);
+        const float cams[5][2] = { { 0, 0 }, { -100, -37 }, { -60, -20 }, { (float)range + 300, 90 }, { (float)range + 280, 101 } };
+        bool same = true;
+        long long fullCleared = 0;
+        for (int i = 0; i < 5 && same; ++i) {
+            bg.update(map, cams[i][0], cams[i][1], W, H);
+            bg.composite(dst);
+            if (i == 0) { bg.invalidate(); bg.update(map, cams[i][0], cams[i][1], W, H); bg.composite(dst); fullCleared = bg.clearedBytes(); }
+            memset(ref.data(), 0, ref.size());
+            map.draw(refDst, cams[i][0], cams[i][1]);
+            same = memcmp(ref.data(), buf.data(), buf.size()) == 0;
+        }
+        printf("         full redraw clears %lld of %zu bytes; vs memset + draw: %s\n",
+            fullCleared, buf.size(), same ? "matches" : "MISMATCH");
+    }
+}
+
+/* Dirty rects -----------------------------------------------------------------
+ * Headless stand-in for the game loop: background + moving enemy squares, a
+ * hero sprite and a HUD panel, first with a still camera, then panning. A
+ * "GPU" copy only receives the DirtyFrame upload rects (one copy call per
+ * rect, as Window::present makes) and is checked against the back buffer
+ * every frame.
+ * ---------------------------------------------------------------------------*/
+static void benchDirty()
+{
+    const int W = 960, H = 540, kEnemies = 40, kFrames = 400;
+    TileMap map;
+    if (!map.load("Resources/tiles.txt")) { printf("[dirty] Resources/tiles.txt not found, skipped\n"); return; }
+    map.setImageFolder("Resources/");
+
+    std::vector<unsigned char> back((size_t)W * H * 3, 0), gpu(back.size(), 0);
+    DirtyFrame frame;
+    ScrollingBackground bg;
+    Image heroImg;
+    makeSilhouette(heroImg, 16, 32, 7u);
+    SpanSprite hero;
+    hero.encode(heroImg);
+
+    float ex[kEnemies], ey[kEnemies], evx[kEnemies], evy[kEnemies];
+    unsigned int seed = 12345u;
+    for (int i = 0; i < kEnemies; ++i) {
+        ex[i] = (float)(benchRand(seed) % W);  ey[i] = (float)(benchRand(seed) % H);
+        evx[i] = (float)(benchRand(seed) % 5) - 2.f; evy[i] = (float)(benchRand(seed) % 5) - 2.f;
+    }
+
+    printf("[dirty] %dx%d, %d enemies, hero sprite, HUD panel\n", W, H, kEnemies);
+    int mismatches = 0;
+    double sumPct[2] = { 0, 0 }, sumUpload[2] = { 0, 0 }, sumCalls[2] = { 0, 0 };
+    int n[2] = { 0, 0 };
+    for (int f = 0; f < kFrames; ++f) {
+        const int phase = (f < kFrames / 2) ? 0 : 1;          // 0 = still camera, 1 = panning
+        const float cam = phase ? (float)((f - kFrames / 2) * 3) : 0.f;
+
+        frame.begin(W, H);
+        Surface screen = Surface::wrap(back.data(), W, H);
+        screen.dirty = &frame.current();
+
+        bg.update(map, cam, cam * 0.5f, W, H);
+        if (bg.changed()) bg.composite(screen);
+        else              bg.composite(screen, frame.stale());
+
+        for (int i = 0; i < kEnemies; ++i) {
+            ex[i] += evx[i]; ey[i] += evy[i];
+            if (ex[i] < -20 || ex[i] > W) evx[i] = -evx[i];
+            if (ey[i] < -20 || ey[i] > H) evy[i] = -evy[i];
+            fillRect(screen, (int)ex[i], (int)ey[i], 20, 20, 255, 60, 60);
+        }
+        hero.draw(screen, W / 2 - 8, H / 2 - 16);
+        fillRect(screen, 10, 10, 220, 80, 18, 18, 18);
+        fillRect(screen, 18, 18, 10 + (f % 60), 14, 255, 240, 180);   // changing digits
+
+        const DirtyRects& upload = frame.endFrame();
+        for (int i = 0; i < upload.count(); ++i) {
+            const DirtyRects::Rect& r = upload[i];
+            for (int y = r.y0; y < r.y1; ++y) {
+                const size_t at = (size_t)y * W * 3 + (size_t)r.x0 * 3;
+                memcpy(gpu.data() + at, back.data() + at, (size_t)(r.x1 - r.x0) * 3);
+            }
+        }
+        if (memcmp(gpu.data(), back.data(), back.size()) != 0) ++mismatches;
+
+        const double pct = 100.0 * frame.dirtyPixels() / ((double)W * H);
+        const double up = 100.0 * frame.uploadBytes() / (double)back.size();
+        sumPct[phase] += pct;
+        sumUpload[phase] += up;
+        sumCalls[phase] += upload.count();
+        ++n[phase];
+        if (f % 50 == 0)
+            printf("  frame %3d (%s): dirty %5.1f%% of pixels, upload %5.1f%% of bytes, %d calls\n",
+                f, phase ? "panning" : "still", pct, up, upload.count());
+    }
+    for (int p = 0; p < 2; ++p)
+        printf("  %-7s avg dirty %5.1f%%  avg upload %5.1f%%  avg calls %4.1f\n",
+            p ? "panning" : "still", sumPct[p] / n[p], sumUpload[p] / n[p], sumCalls[p] / n[p]);
+    printf("  gpu copy mismatches: %d / %d frames\n", mismatches, kFrames);
+}
+
+/* Banded rasterization --------------------------------------------------------
+ * One recorded frame (per-tile blits, enemy/bullet rects, span sprites, HUD)
+ * replayed with 1/2/4/8 bands. Every band count must match the serial
+ * immediate-mode drawing byte for byte.
+ * ---------------------------------------------------------------------------*/
+static void benchBands()
+{
+    TileMap map;
+    if (!map.load("Resources/tiles.txt")) { printf("[bands] Resources/tiles.txt not found, skipped\n"); return; }
+    map.setImageFolder("Resources/");
+    map.setWrap(true);
+
+    Image heroImg;
+    makeSilhouette(heroImg, 16, 32, 7u);
+    SpanSprite hero;
+    hero.encode(heroImg);
+
+    const int sizes[2][2] = { { 960, 540 }, { 3840, 2160 } };
+    const int threadCounts[4] = { 1, 2, 4, 8 };
+    printf("[bands] %u hardware threads\n", std::thread::hardware_concurrency());
+
+    for (const auto& sz : sizes) {
+        const int W = sz[0], H = sz[1];
+        const int kRects = W * H / 1700, kSprites = W * H / 8000;   // ~300 rects, ~65 sprites at 960x540
+        std::vector<unsigned char> ref((size_t)W * H * 3, 0), out(ref.size(), 0);
+        Surface refDst = Surface::wrap(ref.data(), W, H), dst = Surface::wrap(out.data(), W, H);
+
+        // Scene: fixed random positions
+        unsigned int seed = 777u;
+        std::vector<int> rx(kRects), ry(kRects), sx(kSprites), sy(kSprites);
+        for (int i = 0; i < kRects; ++i)   { rx[i] = (int)(benchRand(seed) % (W + 20)) - 20; ry[i] = (int)(benchRand(seed) % (H + 20)) - 20; }
+        for (int i = 0; i < kSprites; ++i) { sx[i] = (int)(benchRand(seed) % W) - 8;          sy[i] = (int)(benchRand(seed) % H) - 16; }
+        const float camX = 123.f, camY = 45.f;
+
+        FrameCommands cmds;
+        double tRecord = timePerCall([&] {
+            cmds.clear();
+            map.record(cmds, W, H, camX, camY);
+            for (int i = 0; i < kRects; ++i) cmds.fillRect(rx[i], ry[i], (i & 1) ? 20 : 6, (i & 1) ? 20 : 6, 255, 60, 60);
+            for (int i = 0; i < kSprites; ++i) cmds.sprite(hero, sx[i], sy[i]);
+            recordHUD(cmds, 87, 144, 1234);
+        });
+
+        // Immediate-mode reference
+        double tSerial = timePerCall([&] {
+            map.draw(refDst, camX, camY);
+            for (int i = 0; i < kRects; ++i) fillRect(refDst, rx[i], ry[i], (i & 1) ? 20 : 6, (i & 1) ? 20 : 6, 255, 60, 60);
+            for (int i = 0; i < kSprites; ++i) hero.draw(refDst, sx[i], sy[i]);
+            drawHUD(refDst, 87, 144, 1234);
+        });
+
+        printf("  %dx%d: %d commands, record %.3f ms, immediate %.3f ms\n", W, H, cmds.size(), tRecord * 1e3, tSerial * 1e3);
+        double t1 = 0;
+        for (int threads : threadCounts) {
+            BandRasterizer raster(threads);
+            memset(out.data(), 0, out.size());
+            double t = timePerCall([&] { raster.run(cmds, dst); });
+            if (threads == 1) t1 = t;
+            const bool same = memcmp(out.data(), ref.data(), out.size()) == 0;
+            printf("    %d thread%s %8.3f ms  (x%.2f)  %s\n", threads, threads > 1 ? "s" : " ",
+                t * 1e3, t1 / t, same ? "matches" : "MISMATCH");
+        }
+
+        // Resizing the pool after it has run: new workers must wait for the next job
+        BandRasterizer resized(4);
+        resized.run(cmds, dst);
+        bool same = true;
+        for (int threads : { 2, 3, 1, 4 }) {
+            resized.setThreads(threads);
+            memset(out.data(), 0, out.size());
+            resized.run(cmds, dst);
+            same = same && memcmp(out.data(), ref.data(), out.size()) == 0;
+        }
+        printf("    setThreads after run (4 -> 2 -> 3 -> 1 -> 4): %s\n", same ? "matches" : "MISMATCH");
+    }
+}
+
+/* Pixel formats ---------------------------------------------------------------
+ * Fill rate of RGB24 vs RGBX8888 for rect fills, stipples and alpha-tested
+ * sprite blits, plus the per-frame RGBX -> RGB24 conversion that the 32-bit
+ * mode pays at present. A recorded frame rendered in both formats must match
+ * after conversion.
+ * ---------------------------------------------------------------------------*/
+static void benchFill()
+{
+    const int W = 960, H = 540;
+    std::vector<unsigned char> buf24((size_t)W * H * 3, 0), check((size_t)W * H * 3, 0);
+    std::vector<uint32_t> buf32((size_t)W * H, 0);
+    Surface s24 = Surface::wrap(buf24.data(), W, H);
+    Surface32 s32 = Surface32::wrap(buf32.data(), W, H);
+    printf("[fill] %dx%d, Mpix/s (higher is better)\n", W, H);
+
+    const int rectSizes[4] = { 8, 32, 256, 0 };   // 0 = full screen
+    for (int size : rectSizes) {
+        const int rw = size ? size : W, rh = size ? size : H;
+        const int perCall = size ? 64 : 1;
+        unsigned int seed = 5u;
+        std::vector<int> xs(perCall), ys(perCall);
+        for (int i = 0; i < perCall; ++i) {
+            xs[i] = size ? (int)(benchRand(seed) % (W - rw)) : 0;
+            ys[i] = size ? (int)(benchRand(seed) % (H - rh)) : 0;
+        }
+        double t24 = timePerCall([&] { for (int i = 0; i < perCall; ++i) fillRect(s24, xs[i], ys[i], rw, rh, 10, 200, 30); });
+        double t32 = timePerCall([&] { for (int i = 0; i < perCall; ++i) fillRect(s32, xs[i], ys[i], rw, rh, 10, 200, 30); });
+        double px = (double)rw * rh * perCall;
+        char label[32];
+        if (size) snprintf(label, sizeof(label), "fill %dx%d", size, size); else snprintf(label, sizeof(label), "fill screen");
+        printf("  %-16s rgb24 %8.0f   rgbx %8.0f  (x%.2f)\n", label, px / t24 / 1e6, px / t32 / 1e6, t24 / t32);
+    }
+
+    {
+        double t24 = timePerCall([&] { fillRectStipple(s24, 0, 0, W, H, 0, 0, 0, 0); });
+        double t32 = timePerCall([&] { fillRectStipple(s32, 0, 0, W, H, 0, 0, 0, 0); });
+        printf("  %-16s rgb24 %8.0f   rgbx %8.0f  (x%.2f)\n", "stipple screen", W * H / t24 / 1e6, W * H / t32 / 1e6, t24 / t32);
+    }
+
+    Image sprite;
+    makeSilhouette(sprite, 64, 64, 3u);
+    {
+        double t24 = timePerCall([&] { for (int y = 0; y + 64 <= H; y += 64) for (int x = 0; x + 64 <= W; x += 64) blitImage(s24, sprite, x, y); });
+        double t32 = timePerCall([&] { for (int y = 0; y + 64 <= H; y += 64) for (int x = 0; x + 64 <= W; x += 64) blitImage(s32, sprite, x, y); });
+        const double px = (double)(W / 64) * (H / 64) * 64 * 64;
+        printf("  %-16s rgb24 %8.0f   rgbx %8.0f  (x%.2f)\n", "blit rgba 64", px / t24 / 1e6, px / t32 / 1e6, t24 / t32);
+    }
+
+    double tConv = timePerCall([&] { convertToRGB24(s32, s24); });
+    printf("  rgbx -> rgb24 conversion: %.3f ms per frame (%.0f Mpix/s)\n", tConv * 1e3, W * H / tConv / 1e6);
+
+    // Same recorded frame in both formats
+    Image tile;
+    makeRGBA(tile, 32, 32, 100, 11u);
+    SpanSprite spr;
+    spr.encode(sprite);
+    FrameCommands cmds;
+    for (int y = -16; y < H; y += 32)
+        for (int x = -16; x < W; x += 32) cmds.blit(tile, x, y);
+    unsigned int seed = 9u;
+    for (int i = 0; i < 200; ++i)
+        cmds.fillRect((int)(benchRand(seed) % W) - 10, (int)(benchRand(seed) % H) - 10, 20, 20, 255, 60, 60);
+    for (int i = 0; i < 30; ++i) {
+        int x = (int)(benchRand(seed) % W) - 32, y = (int)(benchRand(seed) % H) - 32;
+        cmds.sprite(spr, x, y);
+        cmds.blit(sprite, x + 7, y + 3);
+    }
+    recordHUD(cmds, 42, 60, 7);
+    cmds.fillRectStipple(0, 0, W, H, 0, 0, 0, 1);
+
+    BandRasterizer raster(1);
+    memset(buf24.data(), 0, buf24.size());
+    std::fill(buf32.begin(), buf32.end(), 0u);
+    raster.run(cmds, s24);
+    raster.run(cmds, s32);
+    convertToRGB24(s32, Surface::wrap(check.data(), W, H));
+    printf("  recorded frame, rgb24 vs rgbx->rgb24: %s\n", memcmp(check.data(), buf24.data(), check.size()) == 0 ? "matches" : "MISMATCH");
+}
+
+/* Texture atlas ---------------------------------------------------------------
+ * Per-tile map draw from individually allocated tile images
+ * vs the same tiles packed into one atlas; output must be identical.
+ * ---------------------------------------------------------------------------*/
+static void benchAtlas()
+{
+    const int W = 960, H = 540;
+    TileMap map;
+    if (!map.load("Resources/tiles.txt")) { printf("[atlas] Resources/tiles.txt not found, skipped\n"); return; }
+    map.setImageFolder("Resources/");
+
+    TextureAtlas atlas;
+    const int tiles = map.addTilesToAtlas(atlas);
+    if (!atlas.build()) { printf("[atlas] nothing to pack, skipped\n"); return; }
+    int opaque = 0;
+    for (int i = 0; i < atlas.count(); ++i) opaque += atlas.rect(i).opaque ? 1 : 0;
+    printf("[atlas] %d tiles (%d opaque), %zu KB, %.0f%% used\n",
+        tiles, opaque, atlas.bytes() >> 10, atlas.occupancy() * 100.f);
+
+    std::vector<unsigned char> bufA((size_t)W * H * 3, 0), bufB((size_t)W * H * 3, 0);
+    Surface a = Surface::wrap(bufA.data(), W, H), b = Surface::wrap(bufB.data(), W, H);
+    const float span = (float)(map.getPixelWidth() - W);
+    int step = 0;
+    auto frame = [&](const Surface& dst, std::vector<unsigned char>& buf) {
+        float cam = (float)(step++ % 600) / 600.f * span;
+        memset(buf.data(), 0, buf.size());
+        map.draw(dst, cam, cam * 0.5f);
+    };
+
+    step = 0;
+    double tImages = timePerCall([&] { frame(a, bufA); });
+    map.attachAtlas(&atlas);
+    step = 0;
+    double tAtlas = timePerCall([&] { frame(b, bufB); });
+    printf("  per-tile images %7.3f ms   atlas %7.3f ms  (x%.2f)\n", tImages * 1e3, tAtlas * 1e3, tImages / tAtlas);
+
+    bool same = true;
+    for (int i = 0; i < 8 && same; ++i) {
+        float cam = (float)(i * 75) / 600.f * span;
+        map.attachAtlas(nullptr);
+        memset(bufA.data(), 0, bufA.size());
+        map.draw(a, cam, cam * 0.5f);
+        map.attachAtlas(&atlas);
+        memset(bufB.data(), 0, bufB.size());
+        map.draw(b, cam, cam * 0.5f);
+        same = memcmp(bufA.data(), bufB.data(), bufA.size()) == 0;
+    }
+    printf("  atlas vs images: %s\n", same ? "matches" : "MISMATCH");
+}
+
+/* HUD text --------------------------------------------------------------------
+ * drawHUD() per frame: the original bit-walking putPix loop (reference) vs
+ * glyph/label spans from the GlyphCache vs the retained HudLayer; output
+ * must be identical.
+ * ---------------------------------------------------------------------------*/
+static void referenceText(const Surface& dst, int x, int y, const char* s,
+    unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    for (int i = 0; s[i]; ++i, x += 5 * scale + 1) {
+        const Glyph5x7* gph = getGlyph5x7(s[i]);
+        if (!gph) continue;
+        for (int ry = 0; ry < 7; ++ry)
+            for (int rx = 0; rx < 5; ++rx)
+                if (gph->row[ry] & (1 << (4 - rx)))
+                    for (int yy = 0; yy < scale; ++yy)
+                        for (int xx = 0; xx < scale; ++xx)
+                            putPix(dst, x + rx * scale + xx, y + ry * scale + yy, r, g, b);
+    }
+}
+
+static void referenceHUD(const Surface& dst, int remainSec, int fpsInt, int kills)
+{
+    char num[16];
+    fillRectStipple(dst, 10, 10, 220, 80, 18, 18, 18, 0);
+    referenceText(dst, 18, 18, "TIME:", 255, 240, 180, 2);
+    snprintf(num, sizeof(num), "%d", remainSec); referenceText(dst, 102, 18, num, 255, 240, 180, 2);
+    referenceText(dst, 18, 42, "FPS:", 180, 220, 255, 2);
+    snprintf(num, sizeof(num), "%d", fpsInt);    referenceText(dst, 82, 42, num, 180, 220, 255, 2);
+    referenceText(dst, 18, 66, "KILLS:", 200, 255, 200, 2);
+    snprintf(num, sizeof(num), "%d", kills);     referenceText(dst, 106, 66, num, 200, 255, 200, 2);
+}
+
+static void benchHud()
+{
+    const int W = 960, H = 540;
+    std::vector<unsigned char> bufA((size_t)W * H * 3, 0), bufB((size_t)W * H * 3, 0);
+    Surface a = Surface::wrap(bufA.data(), W, H), b = Surface::wrap(bufB.data(), W, H);
+
+    int frame = 0;
+    double tRef = timePerCall([&] { ++frame; referenceHUD(a, 120 - frame / 60 % 120, 60, frame / 97); });
+    frame = 0;
+    double tCached = timePerCall([&] { ++frame; drawHUD(b, 120 - frame / 60 % 120, 60, frame / 97); });
+    printf("[hud] drawHUD per frame: per-pixel %7.2f us   cached spans %7.2f us  (x%.2f)  glyphs=%d runs=%d\n",
+        tRef * 1e6, tCached * 1e6, tRef / tCached, glyphCache().glyphCount(), glyphCache().runCount());
+    double tRefText = timePerCall([&] {
+        referenceText(a, 18, 18, "TIME:", 255, 240, 180, 2);  referenceText(a, 102, 18, "118", 255, 240, 180, 2);
+        referenceText(a, 18, 42, "FPS:", 180, 220, 255, 2);   referenceText(a, 82, 42, "60", 180, 220, 255, 2);
+        referenceText(a, 18, 66, "KILLS:", 200, 255, 200, 2); referenceText(a, 106, 66, "42", 200, 255, 200, 2);
+    });
+    double tCachedText = timePerCall([&] {
+        drawLabel5x7(b, 18, 18, "TIME:", 255, 240, 180, 2);   drawNumber(b, 102, 18, 118, 255, 240, 180, 2);
+        drawLabel5x7(b, 18, 42, "FPS:", 180, 220, 255, 2);    drawNumber(b, 82, 42, 60, 180, 220, 255, 2);
+        drawLabel5x7(b, 18, 66, "KILLS:", 200, 255, 200, 2);  drawNumber(b, 106, 66, 42, 200, 255, 200, 2);
+    });
+    printf("  text only: per-pixel %7.2f us   cached spans %7.2f us  (x%.2f)\n",
+        tRefText * 1e6, tCachedText * 1e6, tRefText / tCachedText);
+
+    // Every printable character, clipped on both sides, at two scales
+    char ascii[96];
+    for (int i = 0; i < 95; ++i) ascii[i] = (char)(' ' + i);
+    ascii[95] = '\0';
+    bool same = true;
+    for (int scale = 1; scale <= 3 && same; scale += 2) {
+        memset(bufA.data(), 0, bufA.size());
+        memset(bufB.data(), 0, bufB.size());
+        referenceHUD(a, -7, 144, 12345);
+        drawHUD(b, -7, 144, 12345);
+        referenceText(a, -9, H - 7 * scale + 3, ascii, 90, 200, 250, scale);
+        drawText5x7(b, -9, H - 7 * scale + 3, ascii, 90, 200, 250, scale);
+        same = memcmp(bufA.data(), bufB.data(), bufA.size()) == 0;
+    }
+    printf("  cached vs per-pixel: %s\n", same ? "matches" : "MISMATCH");
+
+    // Retained layer: values change at game rate (TIME each second, KILLS rarely)
+    HudLayer hud;
+    buildHUDLayer(hud);
+    frame = 0;
+    double tLayer = timePerCall([&] {
+        ++frame;
+        updateHUDLayer(hud, 120 - frame / 60 % 120, 60, frame / 97);
+        hud.draw(b);
+    });
+    printf("  retained layer (update + one blit) %7.2f us  (x%.2f vs per-pixel, x%.2f vs cached spans)  field redraws=%d over %d frames\n",
+        tLayer * 1e6, tRef / tLayer, tCached / tLayer, hud.fieldRedraws(), frame);
+
+    same = true;
+    const int values[4][3] = { { 120, 60, 0 }, { 99, 58, 7 }, { 9, 144, 12345 }, { 0, -3, 12 } };
+    for (int i = 0; i < 4 && same; ++i) {
+        memset(bufA.data(), 0x5A, bufA.size());
+        memset(bufB.data(), 0x5A, bufB.size());
+        drawHUD(a, values[i][0], values[i][1], values[i][2]);
+        updateHUDLayer(hud, values[i][0], values[i][1], values[i][2]);
+        hud.draw(b);
+        same = memcmp(bufA.data(), bufB.data(), bufA.size()) == 0;
+    }
+    printf("  retained layer vs drawHUD: %s\n", same ? "matches" : "MISMATCH");
+}
+
+/* Asset pack ------------------------------------------------------------------
+ * Packs the PNGs in Resources/ into a temp file, then compares a cold first frame
+ * (every visible tile decoded on first use) against the same frame drawn
+ * from views into the mapped pack; output must be identical and the pack
+ * tiles must not be copied (no owned tile bytes).
+ * ---------------------------------------------------------------------------*/
+static void benchPack()
+{
+    const int W = 960, H = 540;
+    const std::string path = (std::filesystem::temp_directory_path() / "bench_assets.pak").string();
+    double t0 = nowSeconds();
+    const int packed = writeAssetPack("Resources", path.c_str());
+    const double tWrite = nowSeconds() - t0;
+    if (packed <= 0) { printf("[pack] nothing packed from Resources/, skipped\n"); return; }
+
+    std::vector<unsigned char> bufA((size_t)W * H * 3, 0), bufB((size_t)W * H * 3, 0);
+    Surface a = Surface::wrap(bufA.data(), W, H), b = Surface::wrap(bufB.data(), W, H);
+
+    // Cold frames: a fresh map each time, so every tile is resolved again
+    const int reps = 20;
+    double tDecode = 0.0, tMapped = 0.0, tOpen = 0.0;
+    bool same = true;
+    size_t mapped = 0, copied = 0;
+    for (int r = 0; r < reps; ++r) {
+        TileMap cold;
+        if (!cold.load("Resources/tiles.txt")) { printf("[pack] Resources/tiles.txt not found, skipped\n"); return; }
+        cold.setImageFolder("Resources/");
+        t0 = nowSeconds();
+        cold.draw(a, 0.f, 0.f);
+        tDecode += nowSeconds() - t0;
+
+        TileMap warm;
+        warm.load("Resources/tiles.txt");
+        warm.setImageFolder("Resources/");
+        t0 = nowSeconds();
+        AssetPack pack;
+        if (!pack.open(path.c_str())) { printf("[pack] failed to map %s\n", path.c_str()); return; }
+        warm.attachAssetPack(&pack);
+        tOpen += nowSeconds() - t0;
+        warm.draw(b, 0.f, 0.f);
+        tMapped += nowSeconds() - t0;
+        mapped = pack.mappedBytes();
+        copied += warm.residentImageBytes();
+        same = same && memcmp(bufA.data(), bufB.data(), bufA.size()) == 0;
+    }
+    printf("[pack] %d images, %zu KB pack, written in %.1f ms\n", packed, mapped >> 10, tWrite * 1e3);
+    printf("  cold first frame: decode on demand %7.3f ms   mapped pack %7.3f ms (open %.3f ms)  (x%.2f)\n",
+        tDecode / reps * 1e3, tMapped / reps * 1e3, tOpen / reps * 1e3, tDecode / tMapped);
+    printf("  pack vs decoded: %s, %zu tile bytes copied from the pack\n", same ? "matches" : "MISMATCH", copied);
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+/* PNG decode ------------------------------------------------------------------
+ * Decodes every PNG in Resources/ serially, then through the worker pool at
+ * several thread counts; pool output must match the serial pass byte for byte.
+ * A call takes tens of ms, so the cases run interleaved for kRounds rounds
+ * and each reports its fastest call: a stretch of machine noise then slows
+ * one round of every case instead of all calls of one case.
+ * ---------------------------------------------------------------------------*/
+static void benchDecode()
+{
+    std::vector<std::string> paths;
+    std::error_code ec;
+    for (const auto& e : std::filesystem::directory_iterator("Resources", ec))
+        if (e.is_regular_file() && e.path().extension() == ".png") paths.push_back(e.path().string());
+    std::sort(paths.begin(), paths.end());
+    if (paths.empty()) { printf("[decode] no PNGs in Resources/, skipped\n"); return; }
+
+    const int kRounds = 12;
+    const int counts[] = { 1, 2, 4, 0 };                 // pool threads (0 = all)
+    const int kCases = 1 + (int)(sizeof(counts) / sizeof(counts[0]));   // serial first
+    std::vector<std::unique_ptr<Image>> results[kCases];
+    auto run = [&](int c) {
+        if (c > 0) { loadImagesParallel(paths, results[c], counts[c - 1]); return; }
+        std::vector<std::unique_ptr<Image>>& serial = results[0];
+        serial.clear();             // start empty, as loadImagesParallel does
+        serial.resize(paths.size());
+        for (size_t i = 0; i < paths.size(); ++i) {
+            std::unique_ptr<Image> img(new Image());
+            if (decodePNGFile(paths[i].c_str(), img->width, img->height, img->channels, img->data)) serial[i] = std::move(img);
+        }
+    };
+
+    double best[kCases];
+    for (int c = 0; c < kCases; ++c) { run(c); best[c] = 1e30; }   // warm up
+    for (int r = 0; r < kRounds; ++r)
+        for (int c = 0; c < kCases; ++c) {
+            const double t0 = nowSeconds();
+            run(c);
+            best[c] = std::min(best[c], nowSeconds() - t0);
+        }
+
+    const std::vector<std::unique_ptr<Image>>& serial = results[0];
+    size_t pixelBytes = 0;
+    int decoded = 0;
+    for (const auto& img : serial)
+        if (img) { ++decoded; pixelBytes += (size_t)img->width * img->height * img->channels; }
+    const double tSerial = best[0];
+    printf("[decode] %d/%zu PNGs, %.1f MB decoded, %u hardware threads, best of %d rounds\n",
+        decoded, paths.size(), pixelBytes / 1048576.0, std::thread::hardware_concurrency(), kRounds);
+    printf("  serial       %8.2f ms  %7.1f MB/s\n", tSerial * 1e3, pixelBytes / 1048576.0 / tSerial);
+
+    for (int c = 1; c < kCases; ++c) {
+        const std::vector<std::unique_ptr<Image>>& pooled = results[c];
+        bool same = true;
+        for (size_t i = 0; i < paths.size() && same; ++i) {
+            if (!serial[i]) continue;
+            const Image* a = serial[i].get();
+            const Image* b = pooled[i].get();
+            same = b && a->width == b->width && a->height == b->height && a->channels == b->channels &&
+                memcmp(a->data, b->data, (size_t)a->width * a->height * a->channels) == 0;
+        }
+        const int threads = counts[c - 1];
+        const double t = best[c];
+        char label[16];
+        if (threads) snprintf(label, sizeof(label), "%d threads", threads);
+        else snprintf(label, sizeof(label), "all threads");
+        printf("  pool %-11s %6.2f ms  %7.1f MB/s  (x%.2f)  %s\n",
+            label, t * 1e3, pixelBytes / 1048576.0 / t, tSerial / t, same ? "matches" : "MISMATCH");
+    }
+}
+
+/* Tile streaming --------------------------------------------------------------
+ * Cold first frame with synchronous decodes vs the streaming map, which
+ * draws placeholders and fills in over the next frames; the settled frame
+ * must match. Then a tiny budget evicts everything idle and the per-tile
+ * path streams it back in.
+ * ---------------------------------------------------------------------------*/
+static void benchStream()
+{
+    const int W = 960, H = 540;
+    std::vector<unsigned char> bufA((size_t)W * H * 3, 0), bufB((size_t)W * H * 3, 0);
+    Surface a = Surface::wrap(bufA.data(), W, H), b = Surface::wrap(bufB.data(), W, H);
+
+    TileMap sync;
+    if (!sync.load("Resources/tiles.txt")) { printf("[stream] Resources/tiles.txt not found, skipped\n"); return; }
+    sync.setImageFolder("Resources/");
+    double t0 = nowSeconds();
+    sync.draw(a, 0.f, 0.f);
+    const double tSync = nowSeconds() - t0;
+
+    TileMap streamed;
+    streamed.load("Resources/tiles.txt");
+    streamed.setImageFolder("Resources/");
+    streamed.enableStreaming();
+    streamed.pumpStreaming();
+    t0 = nowSeconds();
+    streamed.draw(b, 0.f, 0.f);
+    const double tFirst = nowSeconds() - t0;
+
+    // Settle: one pump + draw per "frame" until nothing is in flight
+    int frames = 0, arrived = 0;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        arrived += streamed.pumpStreaming();
+        streamed.draw(b, 0.f, 0.f);
+        ++frames;
+    } while ((streamed.pendingTiles() > 0 || arrived == 0) && frames < 5000);
+    const double tSettled = nowSeconds() - t0;
+    const bool same = memcmp(bufA.data(), bufB.data(), bufA.size()) == 0;
+
+    printf("[stream] cold first frame: sync decode %7.3f ms   streaming %7.3f ms  (x%.1f)\n",
+        tSync * 1e3, tFirst * 1e3, tSync / tFirst);
+    printf("  %d tiles arrived over %d frames (%.1f ms), %zu KB resident\n",
+        arrived, frames, tSettled * 1e3, streamed.residentImageBytes() >> 10);
+    printf("  settled frame vs sync: %s\n", same ? "matches" : "MISMATCH");
+
+    // Budget: nothing may stay idle, so the next pump frees every image
+    streamed.enableStreaming(0, 0.0);
+    streamed.pumpStreaming();
+    const int evicted = streamed.evictedTiles();
+    const size_t left = streamed.residentImageBytes();
+    streamed.enableStreaming();
+    frames = 0;
+    do {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        streamed.pumpStreaming();
+        streamed.draw(b, 0.f, 0.f);
+        ++frames;
+    } while (streamed.pendingTiles() > 0 && frames < 5000);
+    streamed.pumpStreaming();
+    streamed.draw(b, 0.f, 0.f);
+    const bool again = memcmp(bufA.data(), bufB.data(), bufA.size()) == 0;
+    printf("  zero budget: %d evicted, %zu bytes left; re-streamed in %d frames: %s\n",
+        evicted, left, frames, again ? "matches" : "MISMATCH");
+}
+
+/* Normalized images -----------------------------------------------------------
+ * The same sources blitted as Image (per-pixel alpha test / channel branch)
+ * and as PixelImage (coverage picked once per row), into RGB24 and RGBX
+ * targets; both must produce identical pixels.
+ * ---------------------------------------------------------------------------*/
+static void benchNormalize()
+{
+    const int W = 960, H = 540;
+    std::vector<unsigned char> bufA((size_t)W * H * 3), bufB((size_t)W * H * 3);
+    Surface a = Surface::wrap(bufA.data(), W, H), b = Surface::wrap(bufB.data(), W, H);
+    std::vector<uint32_t> buf32A((size_t)W * H), buf32B((size_t)W * H);
+    Surface32 a32 = Surface32::wrap(buf32A.data(), W, H), b32 = Surface32::wrap(buf32B.data(), W, H);
+
+    struct Case { const char* name; int kind; };   // 0 = RGB, 1..3 = RGBA opaque %, 4 = silhouette
+    const Case cases[] = { { "tile RGB", 0 }, { "tile RGBA opaque", 1 }, { "sprite 55%", 2 },
+                           { "sparse 10%", 3 }, { "silhouette 16x32", 4 } };
+    printf("[normalize] %dx%d surfaces, Image vs PixelImage blits\n", W, H);
+    for (const Case& c : cases) {
+        Image img;
+        if (c.kind == 0) {
+            makeRGBA(img, 32, 32, 100, 99u);
+            unsigned char* rgb = new unsigned char[32 * 32 * 3];
+            for (int i = 0; i < 32 * 32; ++i) memcpy(rgb + i * 3, img.data + i * 4, 3);
+            img.free();
+            img.width = 32; img.height = 32; img.channels = 3; img.data = rgb;
+        }
+        else if (c.kind == 4) makeSilhouette(img, 16, 32, 7u);
+        else makeRGBA(img, 32, 32, c.kind == 1 ? 100 : c.kind == 2 ? 55 : 10, 1234u);
+        PixelImage pix;
+        pix.assign(img, true);
+        const int TW = (int)img.width, TH = (int)img.height;
+        const double pixels = (double)W * H;
+
+        auto grid = [&](auto draw) {
+            for (int y = -7; y < H; y += TH)
+                for (int x = -5; x < W; x += TW) draw(x, y);
+        };
+        double tImg = timePerCall([&] { grid([&](int x, int y) { blitImage(a, img, x, y); }); });
+        double tPix = timePerCall([&] { grid([&](int x, int y) { blitImage(b, pix, x, y); }); });
+        double tImg32 = timePerCall([&] { grid([&](int x, int y) { blitImage(a32, img, x, y); }); });
+        double tPix32 = timePerCall([&] { grid([&](int x, int y) { blitImage(b32, pix, x, y); }); });
+
+        // Hit-test mask agrees with the alpha test
+        bool maskOk = true;
+        for (int y = 0; y < TH && maskOk; ++y)
+            for (int x = 0; x < TW && maskOk; ++x)
+                maskOk = pix.solidAt(x, y) == (img.channels == 3 || img.data[((size_t)y * TW + x) * 4 + 3] >= kBlitAlphaCutoff);
+        bool same = bufA == bufB;
+        for (size_t i = 0; i < buf32A.size() && same; ++i)   // X bytes are don't-care
+            same = ((buf32A[i] ^ buf32B[i]) & 0x00FFFFFFu) == 0;
+        const char* cover = pix.coverage() == PixelImage::Opaque ? "opaque" : pix.coverage() == PixelImage::Mixed ? "mixed" : "clear";
+        printf("  %-18s %-6s RGB24 %7.1f -> %7.1f Mpx/s (x%.2f)   RGBX %7.1f -> %7.1f Mpx/s (x%.2f)  %s%s\n",
+            c.name, cover, pixels / tImg * 1e-6, pixels / tPix * 1e-6, tImg / tPix,
+            pixels / tImg32 * 1e-6, pixels / tPix32 * 1e-6, tImg32 / tPix32,
+            same ? "matches" : "MISMATCH", maskOk ? "" : ", MASK MISMATCH");
+    }
+}
+
+/* Map loading -----------------------------------------------------------------
+ * Text (tiles.txt format) vs compiled binary maps of growing size: text
+ * parse, conversion, binary map + first full read, and a cell-by-cell
+ * comparison of the two loads.
+ * ---------------------------------------------------------------------------*/
+static bool writeTextMap(const std::string& path, int w, int h)
+{
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+    fprintf(f, "tileswide %d\ntileshigh %d\ntilewidth 32\ntileheight 32\n\nlayer 0\n", w, h);
+    std::string line;
+    unsigned int seed = 77u;
+    for (int y = 0; y < h; ++y) {
+        line.clear();
+        for (int x = 0; x < w; ++x) {
+            char num[8];
+            int n = snprintf(num, sizeof(num), "%u,", benchRand(seed) % 24);
+            line.append(num, n);
+        }
+        line += '\n';
+        fwrite(line.data(), 1, line.size(), f);
+    }
+    return fclose(f) == 0;
+}
+
+static void benchMapLoad()
+{
+    const int sizes[] = { 42, 1024, 8192 };
+    const auto tmp = std::filesystem::temp_directory_path();
+    printf("[mapload] text vs compiled binary maps\n");
+    for (int n : sizes) {
+        const std::string txt = (tmp / ("bench_map.txt")).string();
+        const std::string bin = (tmp / ("bench_map.map")).string();
+        if (!writeTextMap(txt, n, n)) { printf("  %dx%d: cannot write %s, skipped\n", n, n, txt.c_str()); continue; }
+        const double textMB = std::filesystem::file_size(txt) / 1048576.0;
+
+        TileMap text, binary;
+        double t0 = nowSeconds();
+        const bool okText = text.load(txt.c_str());
+        const double tText = nowSeconds() - t0;
+        t0 = nowSeconds();
+        const bool okSave = okText && text.saveBinary(bin.c_str());
+        const double tSave = nowSeconds() - t0;
+        t0 = nowSeconds();
+        const bool okBin = okSave && binary.load(bin.c_str());
+        const double tMap = nowSeconds() - t0;
+
+        // First full read faults every page in; the same walk checks the cells
+        t0 = nowSeconds();
+        long long sum = 0;
+        for (int y = 0; y < n; ++y)
+            for (int x = 0; x < n; ++x) sum += binary.get(x, y);
+        const double tTouch = nowSeconds() - t0;
+        bool same = okBin;
+        for (int y = 0; y < n && same; ++y)
+            for (int x = 0; x < n && same; ++x) same = text.get(x, y) == binary.get(x, y);
+
+        printf("  %5dx%-5d text %7.1f MB parse %9.2f ms | binary %7.1f MB: convert %8.2f ms, map %6.3f ms, first read %8.2f ms  (x%.0f)  %s\n",
+            n, n, textMB, tText * 1e3, std::filesystem::file_size(bin) / 1048576.0, tSave * 1e3,
+            tMap * 1e3, tTouch * 1e3, tText / (tMap + tTouch), same ? "matches" : "MISMATCH");
+        if (sum < 0) printf("unreachable\n");
+        std::error_code ec;
+        std::filesystem::remove(txt, ec);
+        std::filesystem::remove(bin, ec);
+    }
+}
+
+/* Layer parsing ---------------------------------------------------------------
+ * The old getline + per-character parseInts loop against IntListParser over
+ * the mapped file (parse only, and the whole TileMap::load), with the values
+ * compared; then a few malformed layers must fail at the right line/column
+ * and leave the loaded map as it was.
+ * ---------------------------------------------------------------------------*/
+static int referenceParseInts(const std::string& line, int* dst, int maxWrite)
+{
+    int written = 0;
+    int i = 0, n = (int)line.size();
+    while (i < n && written < maxWrite) {
+        while (i < n && !(line[i] == '-' || (line[i] >= '0' && line[i] <= '9'))) ++i;
+        if (i >= n) break;
+        int sign = 1;
+        if (line[i] == '-') { sign = -1; ++i; }
+        long val = 0;
+        bool hasDigit = false;
+        while (i < n && (line[i] >= '0' && line[i] <= '9')) {
+            val = val * 10 + (line[i] - '0');
+            ++i; hasDigit = true;
+        }
+        if (hasDigit) dst[written++] = (int)(sign * val);
+        while (i < n && (line[i] == ',' || line[i] == ' ' || line[i] == '\t' || line[i] == '\r')) ++i;
+    }
+    return written;
+}
+
+static void benchParse()
+{
+    const int n = 4096;
+    const std::string txt = (std::filesystem::temp_directory_path() / "bench_parse.txt").string();
+    if (!writeTextMap(txt, n, n)) { printf("[parse] cannot write %s, skipped\n", txt.c_str()); return; }
+    const double mb = std::filesystem::file_size(txt) / 1048576.0;
+    std::vector<int> ref((size_t)n * n), bulk((size_t)n * n);
+
+    double t0 = nowSeconds();
+    {
+        std::ifstream f(txt);
+        std::string line;
+        while (std::getline(f, line)) if (line.compare(0, 5, "layer") == 0) break;
+        int idx = 0;
+        while (idx < n * n && std::getline(f, line))
+            if (!line.empty()) idx += referenceParseInts(line, ref.data() + idx, n * n - idx);
+    }
+    const double tRef = nowSeconds() - t0;
+
+    t0 = nowSeconds();
+    int got = 0;
+    {
+        MappedFile f;
+        f.open(txt.c_str());
+        const char* text = (const char*)f.data();
+        const char* layer = strstr(text, "layer");   // the header is tiny and NUL-free
+        size_t at = (size_t)(layer - text);
+        while (at < f.size() && text[at] != '\n') ++at;
+        IntListParser parser(text, f.size(), at);
+        for (int k; got < n * n && (k = parser.next(bulk.data() + got, n * n - got)) > 0; ) got += k;
+    }
+    const double tBulk = nowSeconds() - t0;
+
+    TileMap map;
+    t0 = nowSeconds();
+    const bool loaded = map.load(txt.c_str());
+    const double tLoad = nowSeconds() - t0;
+    bool same = got == n * n && ref == bulk && loaded;
+    for (int y = 0; y < n && same; y += 7)
+        for (int x = 0; x < n && same; x += 3) same = map.get(x, y) == ref[(size_t)y * n + x];
+
+    printf("[parse] %dx%d layer, %.1f MB\n", n, n, mb);
+    printf("  getline + parseInts %8.1f ms  %7.1f MB/s\n", tRef * 1e3, mb / tRef);
+    printf("  IntListParser       %8.1f ms  %7.1f MB/s  (x%.1f)\n", tBulk * 1e3, mb / tBulk, tRef / tBulk);
+    printf("  TileMap::load       %8.1f ms  %7.1f MB/s  %s\n", tLoad * 1e3, mb / tLoad, same ? "matches" : "MISMATCH");
+
+    struct Bad { const char* text; int line, column; };
+    const Bad bad[] = {
+        { "tileswide 3\ntileshigh 2\ntilewidth 32\ntileheight 32\nlayer 0\n1,2,3,\n4,x,6,\n", 7, 3 },
+        { "tileswide 3\ntileshigh 2\ntilewidth 32\ntileheight 32\nlayer 0\n1,2,3,\n4,5-1,6,\n", 7, 4 },
+        { "tileswide 3\ntileshigh 2\ntilewidth 32\ntileheight 32\nlayer 0\n1,2,99999999999,\n", 6, 5 },
+        { "tileswide 3\ntileshigh 2\ntilewidth 32\ntileheight 32\nlayer 0\n1,2,3,4,5,-,\n", 6, 11 },
+    };
+    bool errorsOk = true;
+    for (const Bad& b : bad) {
+        FILE* f = fopen(txt.c_str(), "wb");
+        fputs(b.text, f);
+        fclose(f);
+        char want[32];
+        snprintf(want, sizeof(want), "line %d, column %d:", b.line, b.column);
+        const bool ok = !map.load(txt.c_str()) && map.getLoadError().find(want) != std::string::npos;
+        if (!ok) printf("  expected \"%s\", got \"%s\"\n", want, map.getLoadError().c_str());
+        bool kept = loaded && map.getWidth() == n && map.getHeight() == n && map.getTileW() == 32;
+        for (int y = 0; y < n && kept; y += 61)
+            for (int x = 0; x < n && kept; x += 59) kept = map.get(x, y) == ref[(size_t)y * n + x];
+        if (!kept) printf("  failed load changed the map\n");
+        errorsOk = errorsOk && ok && kept;
+    }
+    printf("  malformed layers: %s\n", errorsOk ? "reported at the right line/column, map kept" : "WRONG");
+    std::error_code ec;
+    std::filesystem::remove(txt, ec);
+}
+
+/* Chunked world ---------------------------------------------------------------
+ * Walks the camera 100k tiles east and back: resident chunks must stay at the
+ * update window, an edit made at the start must still be there on return, and
+ * regenerated terrain must match what was first generated. Then random reads
+ * inside the window, and a TileMap with the world attached.
+ * ---------------------------------------------------------------------------*/
+static void benchWorld()
+{
+    NoiseTerrainGenerator terrain(42);
+    ChunkedWorld world(&terrain);
+    const int radius = 2, step = 48, steps = 100000 / step;
+
+    std::vector<int> before(64 * 64);
+    world.update(0, 0, radius);
+    for (int y = 0; y < 64; ++y)
+        for (int x = 0; x < 64; ++x) before[y * 64 + x] = world.get(x - 32, y - 32);
+    world.set(5, -7, 9);
+    before[(-7 + 32) * 64 + 5 + 32] = 9;
+
+    int maxResident = 0;
+    size_t maxBytes = 0;
+    double t0 = nowSeconds();
+    for (int i = 0; i <= 2 * steps + 1; ++i) {
+        world.update((i <= steps ? i : 2 * steps + 1 - i) * step, 0, radius);
+        maxResident = std::max(maxResident, world.residentChunks());
+        maxBytes = std::max(maxBytes, world.residentBytes());
+    }
+    const double tWalk = nowSeconds() - t0;
+
+    bool same = true;
+    for (int y = 0; y < 64 && same; ++y)
+        for (int x = 0; x < 64 && same; ++x) same = world.get(x - 32, y - 32) == before[y * 64 + x];
+    for (int y = -40; y < 40 && same; ++y)
+        for (int x = 900; x < 980 && same; ++x) same = world.get(x, y) == terrain.tileAt(x, y);
+
+    const int window = (2 * radius + 1) * 16;
+    const int reads = 4000000;
+    long long sum = 0;
+    uint32_t r = 1;
+    t0 = nowSeconds();
+    for (int i = 0; i < reads; ++i) {
+        r = r * 1664525u + 1013904223u;
+        sum += world.get((int)((r >> 8) % window) - window / 2, (int)((r >> 20) % window) - window / 2);
+    }
+    const double tRandom = nowSeconds() - t0;
+    t0 = nowSeconds();
+    for (int y = -window / 2; y < window / 2; ++y)
+        for (int x = -window / 2; x < window / 2; ++x) sum += world.get(x, y);
+    const double tRows = nowSeconds() - t0;
+
+    printf("[world] radius %d, walked %d tiles out and back in %d updates\n", radius, steps * step, 2 * (steps + 1));
+    printf("  update %6.2f us/step | resident max %d chunks (%zu KB), %d parked | generated %d, unloaded %d\n",
+        tWalk * 1e6 / (2 * (steps + 1)), maxResident, maxBytes >> 10,
+        world.parkedChunks(), world.generatedCount(), world.unloadCount());
+    printf("  get: random %5.1f ns, row order %5.1f ns  | edit kept + regenerated terrain %s\n",
+        tRandom * 1e9 / reads, tRows * 1e9 / (window * window), same ? "matches" : "MISMATCH");
+
+    // Home map inside the generated world
+    const std::string txt = (std::filesystem::temp_directory_path() / "bench_world.txt").string();
+    TileMap map;
+    if (!writeTextMap(txt, 42, 42) || !map.load(txt.c_str())) { printf("  cannot write %s, skipped\n", txt.c_str()); return; }
+    TileMap plain;
+    plain.load(txt.c_str());
+    map.attachWorld(&world);
+    bool home = true;
+    for (int y = -20; y < 62 && home; ++y)
+        for (int x = -20; x < 62 && home; ++x) {
+            const bool inside = x >= 0 && y >= 0 && x < 42 && y < 42;
+            home = map.get(x, y) == (inside ? plain.get(x, y) : (x == 5 && y == -7 ? 9 : terrain.tileAt(x, y)));
+        }
+    printf("  TileMap with world: home map inside, terrain outside %s\n", home ? "matches" : "MISMATCH");
+    if (sum < 0) printf("unreachable\n");
+    std::error_code ec;
+    std::filesystem::remove(txt, ec);
+}
+
+/* Collision -------------------------------------------------------------------
+ * Hitbox-sized spans (1-4 tiles) probed the old way (get() + ID range per
+ * tile) and through the bitset, as rows and as columns (Player's horizontal
+ * sweeps), in fixed, wrap and world mode; every answer is compared, also
+ * after set() and setBlocking() changed the map.
+ * ---------------------------------------------------------------------------*/
+static void benchCollide()
+{
+    const int n = 1024;
+    const std::string txt = (std::filesystem::temp_directory_path() / "bench_collide.txt").string();
+    TileMap map;
+    if (!writeTextMap(txt, n, n) || !map.load(txt.c_str())) { printf("[collide] cannot write %s, skipped\n", txt.c_str()); return; }
+    for (int id = 15; id <= 22; ++id) map.setBlocking(id, false);   // ~4% water, like real maps
+
+    auto oldBlocked = [&](int x, int y) { int id = map.get(x, y); return id >= 0 && map.isBlockedId(id); };
+    const int queries = 2000000;
+    struct Span { int row, x0, x1; };
+    std::vector<Span> spans(queries);
+    unsigned int seed = 5u;
+    for (Span& q : spans) {
+        q.row = (int)(benchRand(seed) % (n + 64)) - 32;
+        q.x0 = (int)(benchRand(seed) % (n + 64)) - 32;
+        q.x1 = q.x0 + (int)(benchRand(seed) % 4);
+    }
+
+    printf("[collide] %dx%d map, %d hitbox spans of 1-4 tiles\n", n, n, queries);
+    NoiseTerrainGenerator terrain;
+    ChunkedWorld world(&terrain);
+    const char* const modes[] = { "fixed", "wrap", "world" };
+    for (int pass = 0; pass < 3; ++pass) {
+        map.setWrap(pass == 1);
+        if (pass == 2) map.attachWorld(&world);
+        map.isBlockedAt(0, 0);   // build the bitset outside the timing
+
+        int hitsOld = 0, hitsNew = 0;
+        double t0 = nowSeconds();
+        for (const Span& q : spans) {
+            bool any = false;
+            for (int x = q.x0; x <= q.x1 && !any; ++x) any = oldBlocked(x, q.row);
+            hitsOld += any;
+        }
+        const double tOld = nowSeconds() - t0;
+        t0 = nowSeconds();
+        for (const Span& q : spans) hitsNew += map.anyBlockedInRow(q.row, q.x0, q.x1);
+        const double tNew = nowSeconds() - t0;
+
+        // The same spans as columns: q.row is the column, [x0, x1] the rows
+        int colsOld = 0, colsNew = 0;
+        t0 = nowSeconds();
+        for (const Span& q : spans) {
+            bool any = false;
+            for (int y = q.x0; y <= q.x1 && !any; ++y) any = map.isBlockedAt(q.row, y);
+            colsOld += any;
+        }
+        const double tColOld = nowSeconds() - t0;
+        t0 = nowSeconds();
+        for (const Span& q : spans) colsNew += map.anyBlockedInColumn(q.row, q.x0, q.x1);
+        const double tColNew = nowSeconds() - t0;
+
+        bool same = hitsOld == hitsNew && colsOld == colsNew;
+        for (int i = 0; i < 200000 && same; ++i) {
+            const Span& q = spans[i];
+            bool any = false, anyCol = false;
+            for (int x = q.x0; x <= q.x1; ++x) any = any || oldBlocked(x, q.row);
+            for (int y = q.x0; y <= q.x1; ++y) anyCol = anyCol || oldBlocked(q.row, y);
+            same = any == map.anyBlockedInRow(q.row, q.x0, q.x1) && oldBlocked(q.x0, q.row) == map.isBlockedAt(q.x0, q.row) &&
+                anyCol == map.anyBlockedInColumn(q.row, q.x0, q.x1) &&
+                map.anyBlockedInColumn(q.x0, q.row, q.row + 2) == map.anyBlockedInRect(q.x0, q.row, q.x0, q.row + 2);
+            if (i == 100000) { map.set(q.x0, q.row, 14); map.set(q.x1, q.row, 0); map.setBlocking(0, true); }
+        }
+        map.setBlocking(0, false);
+        printf("  %-5s get + range %6.1f ns/span   bitset %6.1f ns/span  (x%.1f)  %d%% hit  %s\n",
+            modes[pass], tOld * 1e9 / queries, tNew * 1e9 / queries, tOld / tNew,
+            hitsNew * 100 / queries, same ? "matches" : "MISMATCH");
+        printf("        column: per tile %6.1f ns/span   span   %6.1f ns/span  (x%.1f)  %d%% hit\n",
+            tColOld * 1e9 / queries, tColNew * 1e9 / queries, tColOld / tColNew, colsNew * 100 / queries);
+    }
+    std::error_code ec;
+    std::filesystem::remove(txt, ec);
+}
+
+/* Flow field ------------------------------------------------------------------
+ * Rebuild time per window radius over generated terrain (lakes and shores),
+ * then the per-frame cost of every NPC sampling its heading. Each reachable
+ * tile must walk to the goal one step closer per move, never onto water.
+ * ---------------------------------------------------------------------------*/
+static void benchFlow()
+{
+    const std::string txt = (std::filesystem::temp_directory_path() / "bench_flow.txt").string();
+    TileMap map;
+    if (!writeTextMap(txt, 16, 16) || !map.load(txt.c_str())) { printf("[flow] cannot write %s, skipped\n", txt.c_str()); return; }
+    NoiseTerrainGenerator terrain(7);
+    ChunkedWorld world(&terrain);
+    map.attachWorld(&world);
+
+    // Goal far out in generated land
+    int goalX = 5000, goalY = 5000;
+    while (map.isBlockedAt(goalX, goalY)) ++goalX;
+    world.update(goalX, goalY, 128 / kMapChunkTiles + 1);
+
+    printf("[flow] goal on generated terrain, BFS over (2r+1)^2 tiles\n");
+    const int radii[] = { 16, 32, 64, 128 };
+    for (int r : radii) {
+        FlowField field;
+        field.setRadius(r);
+        const int reps = r <= 32 ? 200 : 20;
+        double t0 = nowSeconds();
+        for (int i = 0; i < reps; ++i) field.update(map, goalX + (i & 1), goalY);   // the goal moves every time
+        const double tBuild = (nowSeconds() - t0) / reps;
+        field.update(map, goalX, goalY);
+
+        // Walk every reachable tile back to the goal
+        bool valid = true;
+        for (int ty = goalY - r; ty <= goalY + r && valid; ++ty)
+            for (int tx = goalX - r; tx <= goalX + r && valid; ++tx) {
+                uint16_t d = field.distanceAt(tx, ty);
+                if (d == FlowField::kUnreachable) continue;
+                int x = tx, y = ty;
+                while (d > 0 && valid) {
+                    float dx, dy;
+                    valid = field.direction(x * 32.f + 16.f, y * 32.f + 16.f, dx, dy);
+                    x += (dx > 0.1f) - (dx < -0.1f);
+                    y += (dy > 0.1f) - (dy < -0.1f);
+                    valid = valid && !map.isBlockedAt(x, y) && field.distanceAt(x, y) == d - 1;
+                    d = field.distanceAt(x, y);
+                }
+            }
+        const int side = 2 * r + 1;
+        printf("  radius %3d: %6d tiles, %6d reachable  rebuild %8.1f us  (%5.1f ns/tile)  paths %s\n",
+            r, side * side, field.reachedTiles(), tBuild * 1e6, tBuild * 1e9 / (side * side), valid ? "valid" : "BROKEN");
+    }
+
+    // Per-frame sampling cost for the default window
+    FlowField field;
+    field.update(map, goalX, goalY);
+    const int counts[] = { 128, 1024, 8192 };
+    const int span = (2 * field.getRadius() + 1) * 32;
+    for (int n : counts) {
+        std::vector<float> px(n), py(n);
+        unsigned int seed = 9u;
+        for (int i = 0; i < n; ++i) {
+            px[i] = (goalX - field.getRadius()) * 32.f + (float)(benchRand(seed) % span);
+            py[i] = (goalY - field.getRadius()) * 32.f + (float)(benchRand(seed) % span);
+        }
+        const int frames = 2000000 / n;
+        float sum = 0.f;
+        int hits = 0;
+        double t0 = nowSeconds();
+        for (int f = 0; f < frames; ++f)
+            for (int i = 0; i < n; ++i) {
+                float dx, dy;
+                if (field.direction(px[i], py[i], dx, dy)) { sum += dx + dy; ++hits; }
+            }
+        const double tFrame = (nowSeconds() - t0) / frames;
+        printf("  %5d NPCs: sampling %7.2f us/frame (%4.1f ns/NPC), %d%% on a path\n",
+            n, tFrame * 1e6, tFrame * 1e9 / n, hits / frames * 100 / n);
+        if (sum > 1e30f) printf("unreachable\n");
+    }
+    std::error_code ec;
+    std::filesystem::remove(txt, ec);
+}
+
+/* NPC steering ----------------------------------------------------------------
+ * One frame of chasers/turrets/lights/heavies (plus an unlisted type 4)
+ * homing on a target: the old array of NPC objects (NPC::update each)
+ * against NPCStore::steerAll per ISA, the wanted-heading fill included. Positions after 10 frames must
+ * match the objects to within a hundredth of a pixel.
+ * ---------------------------------------------------------------------------*/
+static void benchNPCs()
+{
+    const int counts[] = { 128, 10000, 100000 };
+    const int worldW = 1 << 14, worldH = 1 << 14;
+    const float dt = 1.f / 60.f;
+    const CpuIsa isas[] = { CpuIsa::Scalar, CpuIsa::SSE2, CpuIsa::AVX2 };
+    const char* const isaNames[] = { "scalar", "sse", "avx2" };
+    printf("[npcs] steering + integration + clamp, NPC updates per second\n");
+
+    for (int n : counts) {
+        std::vector<NPC> objects(n);
+        NPCStore store;
+        store.resize(n);
+        unsigned int seed = 3u;
+        for (int i = 0; i < n; ++i) {
+            NPC& o = objects[i];
+            const unsigned char type = (unsigned char)(benchRand(seed) % 5);   // 4: unknown type, steers as a chaser
+            const float speeds[5] = { 60.f, 0.f, 110.f, 40.f, 60.f };
+            o.initSpawn((float)(benchRand(seed) % worldW), (float)(benchRand(seed) % worldH), type, speeds[type],
+                (float)(benchRand(seed) % worldW), (float)(benchRand(seed) % worldH));
+            const int slot = store.spawn(o);
+            if (i % 16 == 5) { o.kill(); store.kill(slot); }    // a few dead slots, as in a live pool
+        }
+        const NPCStore start = store;
+        const float tx = worldW * 0.5f, ty = worldH * 0.5f;
+        const int frames = std::max(10, 2000000 / n);
+
+        double t0 = nowSeconds();
+        for (int f = 0; f < frames; ++f)
+            for (NPC& o : objects) o.update(dt, tx, ty, worldW, worldH);
+        const double tObjects = (nowSeconds() - t0) / frames;
+        printf("  %6d NPCs  objects %7.1f M/s", n, n / tObjects * 1e-6);
+
+        for (int k = 0; k < 3; ++k) {
+            if ((int)isas[k] > (int)cpuDetectIsa()) continue;
+            store = start;
+            t0 = nowSeconds();
+            for (int f = 0; f < frames; ++f) {
+                for (int i = 0; i < n; ++i) { store.wantX[i] = tx - store.x[i]; store.wantY[i] = ty - store.y[i]; }
+                store.steerAll(dt, worldW, worldH, isas[k]);
+            }
+            const double tStore = (nowSeconds() - t0) / frames;
+
+            // Same 10 frames from the same start
+            store = start;
+            std::vector<NPC> ref(n);
+            for (int i = 0; i < n; ++i) ref[i] = start.get(i);
+            float worst = 0.f;
+            for (int f = 0; f < 10; ++f) {
+                for (int i = 0; i < n; ++i) { store.wantX[i] = tx - store.x[i]; store.wantY[i] = ty - store.y[i]; }
+                store.steerAll(dt, worldW, worldH, isas[k]);
+                for (NPC& o : ref) if (o.isAlive()) o.update(dt, tx, ty, worldW, worldH);
+            }
+            for (int i = 0; i < n; ++i)
+                if (ref[i].isAlive()) worst = std::max(worst, std::max(std::fabs(store.x[i] - ref[i].getX()), std::fabs(store.y[i] - ref[i].getY())));
+            printf(" | %-6s %7.1f M/s (x%4.1f) %s", isaNames[k], n / tStore * 1e-6, tObjects / tStore,
+                worst < 0.01f ? "ok" : "MISMATCH");
+        }
+        printf("\n");
+    }
+}
+
+/* Pools -----------------------------------------------------------------------
+ * Spawn/despawn churn on a 90%-full pool: the old first-fit scan over an
+ * alive flag vs Pool<T>'s free list. Also checks that handles to a released
+ * slot stop resolving and that a full pool drops instead of overwriting.
+ * ---------------------------------------------------------------------------*/
+static void benchPool()
+{
+    struct Item { bool alive = false; float x = 0.f, y = 0.f; };
+    const int capacities[] = { 256, 10000, 100000 };
+    printf("[pool] despawn + spawn churn at 90%% occupancy, ns per pair\n");
+
+    for (int cap : capacities) {
+        const int live = cap - cap / 10;
+        const int ops = 2000000;
+
+        // First-fit: kill a random live slot, rescan from 0 for a free one
+        std::vector<Item> flat((size_t)cap);
+        std::vector<int> liveSlots((size_t)live);
+        for (int i = 0; i < live; ++i) { flat[i].alive = true; liveSlots[i] = i; }
+        unsigned int seed = 5u;
+        double t0 = nowSeconds();
+        for (int op = 0; op < ops; ++op) {
+            const int k = (int)(benchRand(seed) % (unsigned int)live);
+            flat[liveSlots[k]].alive = false;
+            int slot = -1;
+            for (int i = 0; i < cap; ++i) if (!flat[i].alive) { slot = i; break; }
+            flat[slot].alive = true;
+            flat[slot].x = (float)op;
+            liveSlots[k] = slot;
+        }
+        const double tScan = (nowSeconds() - t0) / ops;
+
+        // Free list: release a random live slot, pop the free-list head
+        Pool<Item> pool;
+        pool.reset(cap);
+        for (int i = 0; i < live; ++i) pool[pool.acquire()].alive = true;
+        seed = 5u;
+        t0 = nowSeconds();
+        for (int op = 0; op < ops; ++op) {
+            pool.release(pool.liveAt((int)(benchRand(seed) % (unsigned int)live)));
+            const int slot = pool.acquire();
+            pool[slot].alive = true;
+            pool[slot].x = (float)op;
+        }
+        const double tPool = (nowSeconds() - t0) / ops;
+
+        // Handles go stale on release; a full pool drops the spawn
+        const int victim = pool.liveAt(0);
+        const PoolHandle h = pool.handle(victim);
+        bool ok = pool.get(h) == &pool[victim];
+        pool.release(victim);
+        ok = ok && pool.get(h) == nullptr;
+        const int again = pool.acquire();
+        ok = ok && again == victim && pool.get(h) == nullptr && pool.get(pool.handle(again)) != nullptr;
+        while (pool.acquire() >= 0) {}
+        ok = ok && pool.full() && pool.liveCount() == cap && pool.drops() == 1;
+
+        printf("  capacity %6d  first-fit %8.1f ns | free list %5.1f ns (x%6.1f) %s\n",
+            cap, tScan * 1e9, tPool * 1e9, tScan / tPool, ok ? "ok" : "MISMATCH");
+    }
+}
+
+/* Bullet hits -----------------------------------------------------------------
+ * EnemyManager::checkNPCHit with the uniform-grid broadphase vs the full
+ * bullet x NPC scan, on the same scene (NPCs at constant density, parked
+ * hero bullets). Both must kill the same NPCs and leave the same HP as the
+ * original fixed-array loop: bullets in slot order, lowest NPC slot first.
+ * ---------------------------------------------------------------------------*/
+static void benchHits()
+{
+    const int npcCounts[] = { 128, 1024, 10000, 100000 };
+    const int bulletCounts[] = { 256, 4096 };
+    printf("[hits] hero bullets vs NPCs, one checkNPCHit pass\n");
+
+    for (int bullets : bulletCounts) {
+        for (int n : npcCounts) {
+            EnemyManager base;
+            base.setCapacity(n, 16, bullets);
+            base.init(nullptr);
+            const float side = std::sqrt((float)n) * 60.f;   // ~16% of the area covered
+            unsigned int seed = 11u;
+            NPCStore& store = base.getStore();
+            for (int i = 0; i < n; ++i) {
+                NPC o;
+                o.initSpawn((float)(benchRand(seed) % (unsigned int)side), (float)(benchRand(seed) % (unsigned int)side),
+                    0, 60.f, 0.f, 0.f);
+                store.hp[store.spawn(o)] = 1 + (int)(benchRand(seed) % 3);
+            }
+            std::vector<float> bx(bullets), by(bullets);   // fresh pool: slot i is bullet i
+            for (int i = 0; i < bullets; ++i) {
+                bx[i] = (float)(benchRand(seed) % (unsigned int)side);
+                by[i] = (float)(benchRand(seed) % (unsigned int)side);
+                base.spawnHeroBullet(bx[i], by[i], 1.f, 0.f, 0.f, 10.f);
+            }
+
+            // Reference: the pre-pool loop over fixed arrays
+            std::vector<int> refHP(store.hp.begin(), store.hp.begin() + n);
+            std::vector<char> refAlive(n, 1);
+            int refKills = 0;
+            const PlayerProjectile shot;
+            for (int bi = 0; bi < bullets; ++bi)
+                for (int i = 0; i < n; ++i) {
+                    if (!refAlive[i]
+                        || bx[bi] + shot.w <= store.x[i] || store.x[i] + store.w[i] <= bx[bi]
+                        || by[bi] + shot.h <= store.y[i] || store.y[i] + store.h[i] <= by[bi])
+                        continue;
+                    if ((refHP[i] -= shot.damage) <= 0) { refAlive[i] = 0; ++refKills; }
+                    break;
+                }
+
+            double tPass[2] = { 0.0, 0.0 };
+            int kills[2] = { 0, 0 };
+            EnemyManager result[2];
+            const long long work = (long long)n * bullets;
+            const int reps = (int)std::max(3LL, std::min(200LL, 400000000LL / work));
+            for (int pass = 0; pass < 2; ++pass) {
+                for (int r = 0; r < reps; ++r) {
+                    result[pass] = base;
+                    result[pass].setHitGridEnabled(pass == 1);
+                    const double t0 = nowSeconds();
+                    kills[pass] = result[pass].checkNPCHit();
+                    tPass[pass] += nowSeconds() - t0;
+                }
+                tPass[pass] /= reps;
+            }
+
+            const NPCStore& a = result[0].getStore();
+            const NPCStore& b = result[1].getStore();
+            bool same = kills[0] == kills[1] && kills[0] == refKills && a.liveCount() == b.liveCount();
+            for (int i = 0; same && i < n; ++i)
+                same = a.isAlive(i) == b.isAlive(i) && a.hp[i] == b.hp[i] && a.isAlive(i) == (refAlive[i] != 0) && a.hp[i] == refHP[i];
+            for (int k = 0; same && k < a.liveCount(); ++k) same = a.liveAt(k) == b.liveAt(k);
+            printf("  %5d bullets %6d NPCs  scan %9.1f us | grid %7.1f us (x%6.1f)  %4d kills %s\n",
+                bullets, n, tPass[0] * 1e6, tPass[1] * 1e6, tPass[0] / tPass[1], kills[1], same ? "matches" : "MISMATCH");
+        }
+    }
+}
+
+/* Spatial queries -------------------------------------------------------------
+ * EnemyManager's grid-backed queries vs linear scans over the live NPCs, per
+ * query, at constant NPC density. The grid rebuild is timed separately (one
+ * per frame serves every query). Results must equal the scans'; the hero
+ * push-out (checkPlayerCollision) is checked against the old fixed-array
+ * loop, which resolved NPCs in slot order.
+ * ---------------------------------------------------------------------------*/
+static void benchQuery()
+{
+    const int counts[] = { 1000, 10000, 100000 };
+    const int queries = 2000;
+    printf("[query] NPC spatial queries, us per query (grid vs linear scan)\n");
+
+    for (int n : counts) {
+        EnemyManager em;
+        em.setCapacity(n);
+        em.init(nullptr);
+        const float side = std::sqrt((float)n) * 60.f;
+        unsigned int seed = 21u;
+        for (int i = 0; i < n; ++i) {
+            NPC o;
+            o.initSpawn((float)(benchRand(seed) % (unsigned int)side), (float)(benchRand(seed) % (unsigned int)side),
+                0, 60.f, 0.f, 0.f);
+            em.getStore().spawn(o);
+        }
+        for (int i = 0; i < n; i += 7) em.getStore().kill(i);   // holes, as in play
+        const NPCStore& store = static_cast<const EnemyManager&>(em).getStore();
+
+        std::vector<float> qx(queries), qy(queries);
+        for (int q = 0; q < queries; ++q) {
+            qx[q] = (float)(benchRand(seed) % (unsigned int)side);
+            qy[q] = (float)(benchRand(seed) % (unsigned int)side);
+        }
+        auto centerD2 = [&](int i, float px, float py) {
+            const float dx = store.x[i] + store.w[i] * 0.5f - px, dy = store.y[i] + store.h[i] * 0.5f - py;
+            return dx * dx + dy * dy;
+        };
+
+        // Rebuild cost
+        double t0 = nowSeconds();
+        const int builds = std::max(3, 200000 / n);
+        std::vector<int> out, ref;
+        for (int b = 0; b < builds; ++b) { em.getStore(); em.queryNearest(0.f, 0.f, 1, out); }
+        const double tBuild = (nowSeconds() - t0) / builds;
+        printf("  %6d NPCs  rebuild %8.1f us\n", n, tBuild * 1e6);
+
+        bool same = true;
+        const char* const names[] = { "nearest 1", "nearest 8", "radius 150", "rect 64x64" };
+        for (int kind = 0; kind < 4; ++kind) {
+            auto runGrid = [&](int q) {
+                switch (kind) {
+                case 0:  return em.queryNearest(qx[q], qy[q], 1, out);
+                case 1:  return em.queryNearest(qx[q], qy[q], 8, out);
+                case 2:  return em.queryRadius(qx[q], qy[q], 150.f, out);
+                default: return em.queryRect(qx[q], qy[q], qx[q] + 64.f, qy[q] + 64.f, out);
+                }
+            };
+            auto runScan = [&](int q) {
+                ref.clear();
+                if (kind <= 1) {
+                    const int k = kind == 0 ? 1 : 8;
+                    std::vector<std::pair<float, int>> best;
+                    for (int j = 0; j < store.liveCount(); ++j) {
+                        const int i = store.liveAt(j);
+                        best.emplace_back(centerD2(i, qx[q], qy[q]), i);
+                    }
+                    const int m = std::min(k, (int)best.size());
+                    std::partial_sort(best.begin(), best.begin() + m, best.end());
+                    for (int j = 0; j < m; ++j) ref.push_back(best[j].second);
+                }
+                else {
+                    for (int j = 0; j < store.liveCount(); ++j) {
+                        const int i = store.liveAt(j);
+                        const bool hit = kind == 2 ? centerD2(i, qx[q], qy[q]) <= 150.f * 150.f
+                            : EnemyManager::aabbIntersect(qx[q], qy[q], 64.f, 64.f, store.x[i], store.y[i], (float)store.w[i], (float)store.h[i]);
+                        if (hit) ref.push_back(i);
+                    }
+                }
+                return (int)ref.size();
+            };
+
+            long long found = 0;
+            t0 = nowSeconds();
+            for (int q = 0; q < queries; ++q) found += runGrid(q);
+            const double tGrid = (nowSeconds() - t0) / queries;
+            const int scanQueries = std::max(20, queries * 1000 / n);
+            t0 = nowSeconds();
+            for (int q = 0; q < scanQueries; ++q) runScan(q);
+            const double tScan = (nowSeconds() - t0) / scanQueries;
+
+            for (int q = 0; q < scanQueries && same; ++q) {
+                runGrid(q); runScan(q);
+                if (kind >= 2) { std::sort(out.begin(), out.end()); std::sort(ref.begin(), ref.end()); }
+                same = out == ref;
+            }
+            printf("    %-10s grid %7.2f us | scan %8.2f us (x%6.1f)  %5.1f hits/query\n",
+                names[kind], tGrid * 1e6, tScan * 1e6, tScan / tGrid, (double)found / queries);
+        }
+
+        // Hero push-out vs the old slot-order loop (positions only)
+        for (int q = 0; q < 200 && same; ++q) {
+            Player hero;
+            hero.setPosition(qx[q], qy[q]);
+            float hx = hero.getHitboxX(), hy = hero.getHitboxY();
+            const float hw = (float)hero.getHitboxW(), hh = (float)hero.getHitboxH();
+            for (int i = 0; i < store.capacity(); ++i) {
+                if (!store.isAlive(i)) continue;
+                const float nx = store.x[i], ny = store.y[i], nw = (float)store.w[i], nh = (float)store.h[i];
+                if (!EnemyManager::aabbIntersect(hx, hy, hw, hh, nx, ny, nw, nh)) continue;
+                const float dx = hx + hw * 0.5f - (nx + nw * 0.5f), dy = hy + hh * 0.5f - (ny + nh * 0.5f);
+                const float ox = (hw * 0.5f + nw * 0.5f) - std::fabs(dx), oy = (hh * 0.5f + nh * 0.5f) - std::fabs(dy);
+                if (ox < oy) hx += (dx >= 0 ? ox : -ox);
+                else         hy += (dy >= 0 ? oy : -oy);
+            }
+            Player expect = hero;   // the loop stores hitbox - (getW() - hitbox) / 2
+            if (hx != hero.getHitboxX() || hy != hero.getHitboxY())
+                expect.setPosition(hx - (hero.getW() - hw) * 0.5f, hy - (hero.getH() - hh) * 0.5f);
+            em.checkPlayerCollision(hero);
+            same = hero.getHitboxX() == expect.getHitboxX() && hero.getHitboxY() == expect.getHitboxY();
+        }
+        printf("    results %s\n", same ? "match" : "MISMATCH");
+    }
+}
+
+/* AOE targeting ---------------------------------------------------------------
+ * EnemyManager::selectTargets (one pass, bounded heap) vs the old selection
+ * (N passes over the live NPCs, each taking the best unpicked one), for
+ * every policy and aoeN of 3, 50 and 500. HP spans 1-5, so most scores tie
+ * and the live-order tie-break is exercised. The picks must be identical.
+ * Both sides are timed with their scoring, since selectTargets rescores on
+ * every call; for "densest" that is a radius count per NPC.
+ * ---------------------------------------------------------------------------*/
+static void benchAoe()
+{
+    const int counts[] = { 1000, 10000 };
+    const int picks[] = { 3, 50, 500 };
+    const TargetPolicy policies[] = { TargetPolicy::HighestHP, TargetPolicy::LowestHP, TargetPolicy::Nearest, TargetPolicy::Densest };
+    const char* const names[] = { "highest hp", "lowest hp", "nearest", "densest" };
+    printf("[aoe] top-N target selection, us per strike (heap vs N passes)\n");
+
+    for (int m : counts) {
+        EnemyManager em;
+        em.setCapacity(m);
+        em.init(nullptr);
+        const float side = std::sqrt((float)m) * 60.f;
+        unsigned int seed = 31u;
+        for (int i = 0; i < m; ++i) {
+            NPC o;
+            o.initSpawn((float)(benchRand(seed) % (unsigned int)side), (float)(benchRand(seed) % (unsigned int)side),
+                0, 60.f, 0.f, 0.f);
+            em.getStore().hp[em.getStore().spawn(o)] = 1 + (int)(benchRand(seed) % 5);
+        }
+        for (int i = 0; i < m; i += 9) em.getStore().kill(i);   // holes reorder the live list
+        const NPCStore& store = static_cast<const EnemyManager&>(em).getStore();
+        const float cx = side * 0.5f, cy = side * 0.5f;
+
+        for (int p = 0; p < 4; ++p) {
+            // Same scores as selectTargets, by slot
+            std::vector<float> score((size_t)m);
+            std::vector<int> neighbours;
+            auto scoreAll = [&] {
+                for (int i = 0; i < m; ++i) {
+                    if (!store.isAlive(i)) continue;
+                    const float ncx = store.x[i] + store.w[i] * 0.5f, ncy = store.y[i] + store.h[i] * 0.5f;
+                    const int hp = store.hp[i] > 0 ? store.hp[i] : 1;
+                    switch (policies[p]) {
+                    case TargetPolicy::HighestHP: score[i] = (float)hp; break;
+                    case TargetPolicy::LowestHP:  score[i] = -(float)hp; break;
+                    case TargetPolicy::Nearest:   score[i] = -((ncx - cx) * (ncx - cx) + (ncy - cy) * (ncy - cy)); break;
+                    case TargetPolicy::Densest:   score[i] = (float)em.queryRadius(ncx, ncy, EnemyManager::kClusterRadius, neighbours); break;
+                    }
+                }
+            };
+
+            printf("  %5d NPCs %-10s", m, names[p]);
+            for (int n : picks) {
+                std::vector<int> out, ref;
+                const int reps = std::max(3, 2000000 / (m * std::min(n, 64)));
+                double t0 = nowSeconds();
+                for (int r = 0; r < reps; ++r) em.selectTargets(n, policies[p], cx, cy, out);
+                const double tHeap = (nowSeconds() - t0) / reps;
+
+                const int passReps = std::max(1, reps / 8);
+                t0 = nowSeconds();
+                for (int r = 0; r < passReps; ++r) {
+                    scoreAll();
+                    ref.clear();
+                    std::vector<bool> picked(m, false);   // the original slot-order passes
+                    for (int j = 0; j < n; ++j) {
+                        int best = -1;
+                        for (int i = 0; i < m; ++i)
+                            if (store.isAlive(i) && !picked[i] && (best < 0 || score[i] > score[best])) best = i;
+                        if (best < 0) break;
+                        picked[best] = true;
+                        ref.push_back(best);
+                    }
+                }
+                const double tPasses = (nowSeconds() - t0) / passReps;
+                printf(" | N=%-3d %8.1f us vs %9.1f us (x%6.1f) %s", n, tHeap * 1e6, tPasses * 1e6, tPasses / tHeap,
+                    out == ref ? "ok" : "MISMATCH");
+            }
+            printf("\n");
+        }
+    }
+}
+
+/* Registry --------------------------------------------------------------------*/
+struct BenchCase { const char* name; void (*fn)(); };
+
+static const BenchCase kBenches[] = {
+    { "blit", benchBlit },
+    { "spans", benchSpans },
+    { "scroll", benchScroll },
+    { "dirty", benchDirty },
+    { "bands", benchBands },
+    { "fill", benchFill },
+    { "atlas", benchAtlas },
+    { "hud", benchHud },
+    { "pack", benchPack },
+    { "decode", benchDecode },
+    { "stream", benchStream },
+    { "normalize", benchNormalize },
+    { "mapload", benchMapLoad },
+    { "parse", benchParse },
+    { "world", benchWorld },
+    { "collide", benchCollide },
+    { "flow", benchFlow },
+    { "npcs", benchNPCs },
+    { "pool", benchPool },
+    { "hits", benchHits },
+    { "query", benchQuery },
+    { "aoe", benchAoe },
+};
+
+int runBenchmarks(int argc, char** argv)
+{
+    const int n = (int)(sizeof(kBenches) / sizeof(kBenches[0]));
+    int ran = 0;
+    for (int i = 0; i < n; ++i) {
+        bool selected = (argc == 0);
+        for (int a = 0; a < argc && !selected; ++a)
+            selected = (strcmp(argv[a], kBenches[i].name) == 0);
+        if (!selected) continue;
+        kBenches[i].fn();
+        ++ran;
+    }
+    if (ran == 0) {
+        printf("Unknown benchmark. Available:");
+        for (int i = 0; i < n; ++i) printf(" %s", kBenches[i].name);
+        printf("\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+﻿#pragma once
+
+/*
+ * Headless micro-benchmarks.
+ * ------------------------------------------------
+ * Run as:   MyGame.exe --bench            (all cases)
+ *           MyGame.exe --bench blit ...   (named cases only)
+ *
+ * No window or D3D device is created; cases render into plain RGB24
+ * surfaces and print throughput to stdout. Returns the process exit code.
+ */
+int runBenchmarks(int argc, char** argv);
@@ -1,10 +1,245 @@
 ﻿#include "blit.h"
+#include <cstring>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BLIT_X86 1
+#include <immintrin.h>
+#endif
+
+// MSVC exposes every intrinsic regardless of /arch; GCC/Clang need the target
+// attribute on the function that uses them (runtime dispatch picks the caller).
+#if defined(BLIT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BLIT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BLIT_TARGET(isa)
+#endif
+
 using namespace GamesEngineeringBase;
 
+/* Scalar kernels --------------------------------------------------------------
+ * Reference behaviour for every SIMD path and the tail handler for partial
+ * vectors. One pointer walk per row instead of two index computations per pixel.
+ * ---------------------------------------------------------------------------*/
+static void blitRowRGBAScalar(unsigned char* dst, const unsigned char* src, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4, dst += 3)
+    {
+        if (src[3] < kBlitAlphaCutoff) continue; // Skip nearly transparent pixels
+        dst[0] = src[0];
+        dst[1] = src[1];
+        dst[2] = src[2];
+    }
+}
+
+void blitRowRGB(unsigned char* dstRGB, const unsigned char* srcRGB, int count)
+{
+    // 3-channel images have no alpha: layout already matches the back buffer
+    if (count > 0) memcpy(dstRGB, srcRGB, (size_t)count * 3);
+}
+
+#if defined(BLIT_X86)
+
+/* SSE2 kernel -----------------------------------------------------------------
+ * Classifies 4 pixels per step with one compare on the alpha high nibble
+ * (a >= 16  <=>  (a & 0xF0) != 0). Fully transparent groups are skipped,
+ * fully opaque groups are packed RGBA->RGB with an 8 + 4 byte store, mixed
+ * groups fall back to per-pixel writes. SSE2 has no byte shuffle, hence the
+ * scalar packing.
+ * ---------------------------------------------------------------------------*/
+BLIT_TARGET("sse2")
+static void blitRowRGBASSE2(unsigned char* dst, const unsigned char* src, int count)
+{
+    const __m128i alphaHi = _mm_set1_epi32((int)0xF0000000u);
+    const __m128i zero = _mm_setzero_si128();
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4, src += 16, dst += 12)
+    {
+        __m128i px = _mm_loadu_si128((const __m128i*)src);
+        __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(px, alphaHi), zero);
+        int transparent = _mm_movemask_ps(_mm_castsi128_ps(clear));
+        if (transparent == 0xF) continue;
+
+        if (transparent == 0) {
+            uint64_t a, b;                       // a = p1:p0, b = p3:p2
+            memcpy(&a, src, 8);
+            memcpy(&b, src + 8, 8);
+            uint64_t lo = (a & 0xFFFFFFull) | ((a >> 8) & 0xFFFFFF000000ull) | (b << 48);
+            uint32_t hi = (uint32_t)((b >> 16) & 0xFFu) | (uint32_t)((b >> 24) & 0xFFFFFF00u);
+            memcpy(dst, &lo, 8);
+            memcpy(dst + 8, &hi, 4);
+        }
+        else {
+            blitRowRGBAScalar(dst, src, 4);
+        }
+    }
+    blitRowRGBAScalar(dst, src, count - i);
+}
+
+/* SSSE3 kernel ----------------------------------------------------------------
+ * Same classification, then one pshufb packs 4 RGBA pixels into 12 RGB bytes
+ * and, for mixed groups, the lane mask (shuffled the same way) selects between
+ * source and destination:
+ *     out = (rgb & mask) | (dst & ~mask)
+ * Mixed groups read 16 destination bytes, so the vector loop keeps 2 pixels of
+ * headroom in the row. Results are written as exactly 12 bytes (8 + 4): a
+ * 16-byte store would overlap the next group's load and defeat store-to-load
+ * forwarding.
+ * ---------------------------------------------------------------------------*/
+BLIT_TARGET("sse2")
+static inline void store12(unsigned char* dst, __m128i v)
+{
+    _mm_storel_epi64((__m128i*)dst, v);
+    int tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+    memcpy(dst + 8, &tail, 4);
+}
+
+// One 4-pixel group; force-inlined so the AVX2 kernel gets a VEX-encoded copy
+// (calling a legacy-SSE function from AVX code costs a state transition).
+#if defined(_MSC_VER)
+#define BLIT_INLINE __forceinline
+#else
+#define BLIT_INLINE inline __attribute__((always_inline))
+#endif
+
+BLIT_TARGET("ssse3")
+static BLIT_INLINE void blitGroup4SSSE3(unsigned char* dst, const unsigned char* src)
+{
+    const __m128i alphaHi = _mm_set1_epi32((int)0xF0000000u);
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14,
+        -1, -1, -1, -1);
+
+    __m128i px = _mm_loadu_si128((const __m128i*)src);
+    __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(px, alphaHi), _mm_setzero_si128());
+    int transparent = _mm_movemask_ps(_mm_castsi128_ps(clear));
+    if (transparent == 0xF) return;
+
+    __m128i rgb = _mm_shuffle_epi8(px, pack);
+    if (transparent != 0) {
+        __m128i mask = _mm_shuffle_epi8(_mm_andnot_si128(clear, _mm_set1_epi32(-1)), pack);
+        __m128i d = _mm_loadu_si128((const __m128i*)dst);
+        rgb = _mm_or_si128(_mm_and_si128(mask, rgb), _mm_andnot_si128(mask, d));
+    }
+    store12(dst, rgb);
+}
+
+BLIT_TARGET("ssse3")
+static void blitRowRGBASSSE3(unsigned char* dst, const unsigned char* src, int count)
+{
+    int i = 0;
+    for (; i + 6 <= count; i += 4, src += 16, dst += 12)
+        blitGroup4SSSE3(dst, src);
+    blitRowRGBAScalar(dst, src, count - i);
+}
+
+/* AVX2 kernel -----------------------------------------------------------------
+ * 8 pixels per step: one 256-bit compare builds the alpha mask, the in-lane
+ * pshufb packs each 128-bit half to 12 bytes, and the two halves are blended
+ * into dst and dst+12 as two 12-byte stores. Mixed groups load 16 bytes at
+ * dst+12, so the vector loop keeps 2 pixels of headroom past the group.
+ * ---------------------------------------------------------------------------*/
+BLIT_TARGET("avx2")
+static void blitRowRGBAAVX2(unsigned char* dst, const unsigned char* src, int count)
+{
+    const __m256i alphaHi = _mm256_set1_epi32((int)0xF0000000u);
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i ones = _mm256_set1_epi32(-1);
+    const __m256i pack = _mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1,
+        0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+
+    int i = 0;
+    for (; i + 10 <= count; i += 8, src += 32, dst += 24)
+    {
+        __m256i px = _mm256_loadu_si256((const __m256i*)src);
+        __m256i clear = _mm256_cmpeq_epi32(_mm256_and_si256(px, alphaHi), zero);
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(clear)) == 0xFF) continue;
+
+        __m256i rgb = _mm256_shuffle_epi8(px, pack);
+        __m128i cLo = _mm256_castsi256_si128(rgb), cHi = _mm256_extracti128_si256(rgb, 1);
+
+        if (_mm256_movemask_ps(_mm256_castsi256_ps(clear)) != 0) {
+            __m256i mask = _mm256_shuffle_epi8(_mm256_andnot_si256(clear, ones), pack);
+            __m128i mLo = _mm256_castsi256_si128(mask), mHi = _mm256_extracti128_si256(mask, 1);
+            __m128i dLo = _mm_loadu_si128((const __m128i*)dst);
+            __m128i dHi = _mm_loadu_si128((const __m128i*)(dst + 12));
+            cLo = _mm_or_si128(_mm_and_si128(mLo, cLo), _mm_andnot_si128(mLo, dLo));
+            cHi = _mm_or_si128(_mm_and_si128(mHi, cHi), _mm_andnot_si128(mHi, dHi));
+        }
+        store12(dst, cLo);
+        store12(dst + 12, cHi);
+    }
+    for (; i + 6 <= count; i += 4, src += 16, dst += 12)  // 4-wide steps before the scalar tail
+        blitGroup4SSSE3(dst, src);
+    blitRowRGBAScalar(dst, src, count - i);
+}
+
+#endif // BLIT_X86
+
+/* Dispatch --------------------------------------------------------------------
+ * The kernel is resolved once, by the first caller on any thread (a
+ * function-local static, like cpuDetectIsa), so band workers can make the
+ * first blit at the same time. blitSelectIsa() may lower it afterwards; it
+ * is a main-thread override and must not run while blits are in flight.
+ * ---------------------------------------------------------------------------*/
+typedef void (*BlitRowFn)(unsigned char*, const unsigned char*, int);
+
+static BlitRowFn kernelFor(BlitIsa isa)
+{
+#if defined(BLIT_X86)
+    switch (isa) {
+    case BlitIsa::AVX2:  return blitRowRGBAAVX2;
+    case BlitIsa::SSSE3: return blitRowRGBASSSE3;
+    case BlitIsa::SSE2:  return blitRowRGBASSE2;
+    default: break;
+    }
+#endif
+    (void)isa;
+    return blitRowRGBAScalar;
+}
+
+struct BlitDispatch { BlitIsa active; BlitRowFn rowRGBA; };
+
+static BlitDispatch& dispatch()
+{
+    static BlitDispatch d = { cpuDetectIsa(), kernelFor(cpuDetectIsa()) };
+    return d;
+}
+
+BlitIsa blitDetectIsa()
+{
+    return cpuDetectIsa();
+}
+
+BlitIsa blitActiveIsa()
+{
+    return dispatch().active;
+}
+
+bool blitSelectIsa(BlitIsa isa)
+{
+    if ((int)isa > (int)cpuDetectIsa()) return false;
+    BlitDispatch& d = dispatch();
+    d.active = isa;
+    d.rowRGBA = kernelFor(isa);
+    return true;
+}
+
+const char* blitIsaName(BlitIsa isa)
+{
+    return cpuIsaName(isa);
+}
+
+void blitRowRGBA(unsigned char* dstRGB, const unsigned char* srcRGBA, int count)
+{
+    dispatch().rowRGBA(dstRGB, srcRGBA, count);
+}
+
 /*
  * blitImage()
  * ------------------------------------------------------------------------
- * Draws an entire image onto the window’s back buffer at the given position.
+ * Draws an entire image onto the window’s back buffer (or any Surface)
+ * at the given position.
  *
  * Features:
  * - Performs clipping to ensure drawing remains within window bounds.
@@ -17,37 +252,16 @@ using namespace GamesEngineeringBase;
  *   dstX,Y : destination top-left position in screen coordinates.
  *
  * Implementation notes:
- * - Uses the window’s linear framebuffer indexing (y * width + x).
- * - Designed for efficiency in software rendering.
+ * - A whole-image special case of blitSubImage(); shares its row kernels.
  */
 void blitImage(Window& window, const GamesEngineeringBase::Image& img, int dstX, int dstY)
 {
-    const int W = (int)window.getWidth();
-    const int H = (int)window.getHeight();
-
-    // Compute visible rectangle and clip against window bounds
-    int x0 = dstX, y0 = dstY;
-    int x1 = dstX + (int)img.width;
-    int y1 = dstY + (int)img.height;
-    if (x0 >= W || y0 >= H || x1 <= 0 || y1 <= 0) return;
-    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
-    if (x1 > W) x1 = W; if (y1 > H) y1 = H;
+    blitSubImage(Surface::of(window), img, 0, 0, (int)img.width, (int)img.height, dstX, dstY);
+}
 
-    // Copy pixels row by row
-    for (int y = y0; y < y1; ++y)
-    {
-        int srcY = y - dstY;
-        int base = y * W;
-        for (int x = x0; x < x1; ++x)
-        {
-            int srcX = x - dstX;
-            unsigned char a = img.alphaAtUnchecked(srcX, srcY);
-            if (a < 16) continue; // Skip nearly transparent pixels
-
-            unsigned char* p = img.atUnchecked(srcX, srcY); // RGB pointer
-            window.draw(base + x, p[0], p[1], p[2]);        // Write to framebuffer
-        }
-    }
+void blitImage(const Surface& dst, const GamesEngineeringBase::Image& img, int dstX, int dstY)
+{
+    blitSubImage(dst, img, 0, 0, (int)img.width, (int)img.height, dstX, dstY);
 }
 
 
@@ -72,15 +286,25 @@ void blitImage(Window& window, const GamesEngineeringBase::Image& img, int dstX,
  *
  * Implementation notes:
  * - The function manually clamps coordinates on both sides.
- * - Works efficiently in software pixel loops.
+ * - Each visible row is one blitRowRGBA()/blitRowRGB() call on raw pointers
+ *   into the image and the back buffer.
  */
 void blitSubImage(Window& window,
     const Image& img,
     int srcX, int srcY, int subW, int subH,
     int dstX, int dstY)
 {
-    const int W = (int)window.getWidth();
-    const int H = (int)window.getHeight();
+    blitSubImage(Surface::of(window), img, srcX, srcY, subW, subH, dstX, dstY);
+}
+
+void blitSubImage(const Surface& dst,
+    const Image& img,
+    int srcX, int srcY, int subW, int subH,
+    int dstX, int dstY)
+{
+    const int W = dst.width;
+    const int H = dst.height;
+    if (!img.data || (img.channels != 3 && img.channels != 4)) return;
 
     // Clip source region inside image bounds
     if (srcX < 0) { int d = -srcX; srcX = 0; subW -= d; dstX += d; }
@@ -101,24 +325,21 @@ void blitSubImage(Window& window,
 
     int drawW = x1 - x0;
     int drawH = y1 - y0;
+    dst.markDirty(x0, y0, drawW, drawH);
 
-    // Copy each visible pixel
-    for (int y = 0; y < drawH; ++y)
-    {
-        int sy = srcY + y;
-        int dy = y0 + y;
-        int baseDest = dy * W;
-
-        for (int x = 0; x < drawW; ++x)
-        {
-            int sx = srcX + x;
-            int dx = x0 + x;
-
-            unsigned char a = img.alphaAtUnchecked((unsigned int)sx, (unsigned int)sy);
-            if (a < 16) continue; // Skip transparent pixels
+    const int ch = (int)img.channels;
+    const size_t srcPitch = (size_t)img.width * ch;
+    const size_t dstPitch = (size_t)dst.pitch;
+    const unsigned char* sp = img.data + (size_t)srcY * srcPitch + (size_t)srcX * ch;
+    unsigned char* dp = dst.row(y0) + (size_t)x0 * 3;
 
-            unsigned char* sp = img.atUnchecked((unsigned int)sx, (unsigned int)sy);
-            window.draw(baseDest + dx, sp[0], sp[1], sp[2]);
-        }
+    // Copy each visible row
+    if (ch == 4) {
+        for (int y = 0; y < drawH; ++y, sp += srcPitch, dp += dstPitch)
+            blitRowRGBA(dp, sp, drawW);
+    }
+    else {
+        for (int y = 0; y < drawH; ++y, sp += srcPitch, dp += dstPitch)
+            blitRowRGB(dp, sp, drawW);
     }
 }
@@ -1,5 +1,7 @@
 #pragma once
-#include "GamesEngineeringBase.h"
+#include "Image.h"
+#include "Surface.h"
+#include "CpuFeatures.h"
 
 /*
  * Basic blitting utilities for 2D image rendering.
@@ -20,6 +22,8 @@
  * - Coordinates are in pixels.
  * - These are direct copies (no alpha blending, no scaling).
  * - Used for sprite rendering, tile drawing, and HUD elements.
+ * - Both functions clip once, then hand each visible row to a row kernel
+ *   (see below), so the inner loop never touches Window::draw.
  */
 void blitImage(GamesEngineeringBase::Window& window,
     const GamesEngineeringBase::Image& img,
@@ -29,3 +33,40 @@ void blitSubImage(GamesEngineeringBase::Window& window,
     const GamesEngineeringBase::Image& img,
     int srcX, int srcY, int subW, int subH,
     int dstX, int dstY);
+
+// Same operations on any RGB24 surface (offscreen buffers, headless benchmarks).
+void blitImage(const Surface& dst,
+    const GamesEngineeringBase::Image& img,
+    int dstX, int dstY);
+
+void blitSubImage(const Surface& dst,
+    const GamesEngineeringBase::Image& img,
+    int srcX, int srcY, int subW, int subH,
+    int dstX, int dstY);
+
+/*
+ * Row kernels
+ * ------------------------------------------------
+ * Copy `count` source pixels into a packed RGB24 row (the back-buffer layout).
+ * - blitRowRGBA(): 4-channel source, pixels with alpha < kBlitAlphaCutoff are
+ *   left untouched in the destination (same alpha test the blitters use).
+ * - blitRowRGB():  3-channel source, always opaque, plain row copy.
+ *
+ * blitRowRGBA() dispatches to the widest kernel the CPU supports
+ * (AVX2 -> SSSE3 -> SSE2 -> scalar, see cpuDetectIsa()), resolved once on
+ * first use from any thread. blitSelectIsa() can pin a lower level
+ * (benchmarks, debugging) from the main thread while no blits run; it
+ * returns false and keeps the current kernel if the CPU cannot run the
+ * requested one.
+ */
+static const unsigned char kBlitAlphaCutoff = 16;
+
+typedef CpuIsa BlitIsa;
+
+void blitRowRGBA(unsigned char* dstRGB, const unsigned char* srcRGBA, int count);
+void blitRowRGB(unsigned char* dstRGB, const unsigned char* srcRGB, int count);
+
+BlitIsa     blitDetectIsa();               // cpuDetectIsa()
+BlitIsa     blitActiveIsa();               // level currently used by blitRowRGBA
+bool        blitSelectIsa(BlitIsa isa);    // pin a level (<= detected)
+const char* blitIsaName(BlitIsa isa);       // cpuIsaName()
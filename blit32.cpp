@@ -0,0 +1,231 @@
+﻿#include "blit32.h"
+#include "blit.h"
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define BLIT_X86 1
+#include <immintrin.h>
+#endif
+
+// See blit.cpp: GCC/Clang need the target attribute for non-baseline intrinsics
+#if defined(BLIT_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BLIT_TARGET(isa) __attribute__((target(isa)))
+#else
+#define BLIT_TARGET(isa)
+#endif
+
+using namespace GamesEngineeringBase;
+
+/* Span kernels ----------------------------------------------------------------
+ * Whole-pixel stores: 16 pixels (four 16-byte stores) per step, then single
+ * words. blitRowRGBA32 classifies 4 pixels with the same alpha-nibble compare
+ * as blitRowRGBASSE2 and blends with and/andnot/or; no packing is needed
+ * because source and destination share the 4-byte stride.
+ * ---------------------------------------------------------------------------*/
+#if defined(BLIT_X86)
+
+BLIT_TARGET("sse2")
+void fillSpan32(uint32_t* dst, uint32_t px, int count)
+{
+    const __m128i v = _mm_set1_epi32((int)px);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        _mm_storeu_si128((__m128i*)(dst + i), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 4), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 8), v);
+        _mm_storeu_si128((__m128i*)(dst + i + 12), v);
+    }
+    for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i*)(dst + i), v);
+    for (; i < count; ++i) dst[i] = px;
+}
+
+BLIT_TARGET("sse2")
+void blitRowRGBA32(uint32_t* dst, const unsigned char* src, int count)
+{
+    const __m128i alphaHi = _mm_set1_epi32((int)0xF0000000u);
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4, src += 16) {
+        __m128i s = _mm_loadu_si128((const __m128i*)src);
+        __m128i clear = _mm_cmpeq_epi32(_mm_and_si128(s, alphaHi), zero);
+        int transparent = _mm_movemask_ps(_mm_castsi128_ps(clear));
+        if (transparent == 0xF) continue;
+        if (transparent != 0) {
+            __m128i d = _mm_loadu_si128((const __m128i*)(dst + i));
+            s = _mm_or_si128(_mm_and_si128(clear, d), _mm_andnot_si128(clear, s));
+        }
+        _mm_storeu_si128((__m128i*)(dst + i), s);
+    }
+    for (; i < count; ++i, src += 4)
+        if (src[3] >= kBlitAlphaCutoff) memcpy(dst + i, src, 4);
+}
+
+// pshufb versions: 3 <-> 4 byte pixels, 4 pixels per step. The expand loads 16
+// source bytes for 12 used, so it keeps 2 pixels of headroom like blit.cpp.
+BLIT_TARGET("ssse3")
+static void blitRowRGB32SSSE3(uint32_t* dst, const unsigned char* src, int count)
+{
+    const __m128i expand = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    int i = 0;
+    for (; i + 6 <= count; i += 4, src += 12)
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)src), expand));
+    for (; i < count; ++i, src += 3)
+        dst[i] = packRGBX(src[0], src[1], src[2]);
+}
+
+BLIT_TARGET("ssse3")
+static void packRowRGBXSSSE3(unsigned char* dst, const uint32_t* src, int count)
+{
+    const __m128i pack = _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    int i = 0;
+    // 16 pixels -> three full 16-byte stores
+    for (; i + 16 <= count; i += 16, dst += 48) {
+        const __m128i v0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i)), pack);
+        const __m128i v1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i + 4)), pack);
+        const __m128i v2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i + 8)), pack);
+        const __m128i v3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i + 12)), pack);
+        _mm_storeu_si128((__m128i*)dst, _mm_or_si128(v0, _mm_slli_si128(v1, 12)));
+        _mm_storeu_si128((__m128i*)(dst + 16), _mm_or_si128(_mm_srli_si128(v1, 4), _mm_slli_si128(v2, 8)));
+        _mm_storeu_si128((__m128i*)(dst + 32), _mm_or_si128(_mm_srli_si128(v2, 8), _mm_slli_si128(v3, 4)));
+    }
+    for (; i + 4 <= count; i += 4, dst += 12) {
+        __m128i v = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(src + i)), pack);
+        _mm_storel_epi64((__m128i*)dst, v);
+        int tail = _mm_cvtsi128_si32(_mm_srli_si128(v, 8));
+        memcpy(dst + 8, &tail, 4);
+    }
+    for (; i < count; ++i, dst += 3) memcpy(dst, src + i, 3);
+}
+
+static bool hasSSSE3() { return (int)blitActiveIsa() >= (int)BlitIsa::SSSE3; }
+
+#else
+
+void fillSpan32(uint32_t* dst, uint32_t px, int count)
+{
+    for (int i = 0; i < count; ++i) dst[i] = px;
+}
+
+void blitRowRGBA32(uint32_t* dst, const unsigned char* src, int count)
+{
+    for (int i = 0; i < count; ++i, src += 4)
+        if (src[3] >= kBlitAlphaCutoff) memcpy(dst + i, src, 4);
+}
+
+static bool hasSSSE3() { return false; }
+
+#endif // BLIT_X86
+
+void copySpan32(uint32_t* dst, const uint32_t* src, int count)
+{
+    if (count > 0) memcpy(dst, src, (size_t)count * 4);
+}
+
+void blitRowRGB32(uint32_t* dst, const unsigned char* src, int count)
+{
+#if defined(BLIT_X86)
+    if (hasSSSE3()) { blitRowRGB32SSSE3(dst, src, count); return; }
+#endif
+    for (int i = 0; i < count; ++i, src += 3)
+        dst[i] = packRGBX(src[0], src[1], src[2]);
+}
+
+void packRowRGBX(unsigned char* dst, const uint32_t* src, int count)
+{
+#if defined(BLIT_X86)
+    if (hasSSSE3()) { packRowRGBXSSSE3(dst, src, count); return; }
+#endif
+    for (int i = 0; i < count; ++i, dst += 3) {
+        const uint32_t p = src[i];
+        dst[0] = (unsigned char)p; dst[1] = (unsigned char)(p >> 8); dst[2] = (unsigned char)(p >> 16);
+    }
+}
+
+/* Rect operations -------------------------------------------------------------*/
+void fillRect(const Surface32& dst, int x0, int y0, int w, int h,
+    unsigned char r, unsigned char g, unsigned char b)
+{
+    int x1 = x0 + w, y1 = y0 + h;
+    if (x0 >= dst.width || y0 >= dst.height || x1 <= 0 || y1 <= 0) return;
+    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
+    if (x1 > dst.width) x1 = dst.width; if (y1 > dst.height) y1 = dst.height;
+    dst.markDirty(x0, y0, x1 - x0, y1 - y0);
+
+    const uint32_t px = packRGBX(r, g, b);
+    for (int y = y0; y < y1; ++y) fillSpan32(dst.row(y) + x0, px, x1 - x0);
+}
+
+// Pattern follows surface coordinates, as in the RGB24 version
+void fillRectStipple(const Surface32& dst, int x0, int y0, int wdt, int hgt,
+    unsigned char r, unsigned char g, unsigned char b, int pattern)
+{
+    int x1 = x0 + wdt, y1 = y0 + hgt;
+    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
+    if (x1 > dst.width) x1 = dst.width; if (y1 > dst.height) y1 = dst.height;
+    if (x0 >= x1 || y0 >= y1) return;
+    dst.markDirty(x0, y0, x1 - x0, y1 - y0);
+
+    const uint32_t px = packRGBX(r, g, b);
+    for (int y = y0; y < y1; ++y) {
+        if (pattern != 0 && (y & 1)) continue;
+        uint32_t* line = dst.row(y);
+        const int parity = (pattern == 0) ? (y & 1) : 0;   // first painted x has (x & 1) == parity
+        for (int x = x0 + ((x0 & 1) != parity ? 1 : 0); x < x1; x += 2) line[x] = px;
+    }
+}
+
+void putPix(const Surface32& dst, int x, int y,
+    unsigned char r, unsigned char g, unsigned char b)
+{
+    if ((unsigned)x >= (unsigned)dst.width || (unsigned)y >= (unsigned)dst.height) return;
+    dst.row(y)[x] = packRGBX(r, g, b);
+}
+
+void blitImage(const Surface32& dst, const Image& img, int dstX, int dstY)
+{
+    blitSubImage(dst, img, 0, 0, (int)img.width, (int)img.height, dstX, dstY);
+}
+
+void blitSubImage(const Surface32& dst,
+    const Image& img,
+    int srcX, int srcY, int subW, int subH,
+    int dstX, int dstY)
+{
+    const int W = dst.width;
+    const int H = dst.height;
+    if (!img.data || (img.channels != 3 && img.channels != 4)) return;
+
+    if (srcX < 0) { int d = -srcX; srcX = 0; subW -= d; dstX += d; }
+    if (srcY < 0) { int d = -srcY; srcY = 0; subH -= d; dstY += d; }
+    if (srcX + subW > (int)img.width)  subW = (int)img.width - srcX;
+    if (srcY + subH > (int)img.height) subH = (int)img.height - srcY;
+    if (subW <= 0 || subH <= 0) return;
+
+    int x0 = dstX, y0 = dstY;
+    int x1 = dstX + subW;
+    int y1 = dstY + subH;
+    if (x0 >= W || y0 >= H || x1 <= 0 || y1 <= 0) return;
+    if (x0 < 0) { int d = -x0; x0 = 0; srcX += d; }
+    if (y0 < 0) { int d = -y0; y0 = 0; srcY += d; }
+    if (x1 > W) x1 = W;
+    if (y1 > H) y1 = H;
+
+    const int drawW = x1 - x0, drawH = y1 - y0;
+    dst.markDirty(x0, y0, drawW, drawH);
+
+    const int ch = (int)img.channels;
+    const size_t srcPitch = (size_t)img.width * ch;
+    const unsigned char* sp = img.data + (size_t)srcY * srcPitch + (size_t)srcX * ch;
+    for (int y = 0; y < drawH; ++y, sp += srcPitch) {
+        if (ch == 4) blitRowRGBA32(dst.row(y0 + y) + x0, sp, drawW);
+        else         blitRowRGB32(dst.row(y0 + y) + x0, sp, drawW);
+    }
+}
+
+void convertToRGB24(const Surface32& src, const Surface& dst, int y0, int y1)
+{
+    if (y1 < 0 || y1 > src.height) y1 = src.height;
+    if (y1 > dst.height) y1 = dst.height;
+    const int w = src.width < dst.width ? src.width : dst.width;
+    for (int y = y0; y < y1; ++y) packRowRGBX(dst.row(y), src.row(y), w);
+}
@@ -0,0 +1,41 @@
+﻿#pragma once
+#include "Image.h"
+#include "Surface.h"
+#include <cstdint>
+
+/*
+ * RGBX8888 drawing primitives (see Surface32 in Surface.h).
+ * ------------------------------------------------
+ * Same semantics as the RGB24 versions in blit.h / gfx_utils.h, but every
+ * pixel is a whole 32-bit word:
+ * - Span kernels: fill/copy `count` pixels; SIMD stores where available.
+ * - blitRowRGBA32(): alpha test identical to blitRowRGBA() (a < 16 skipped).
+ * - blitRowRGB32():  3-channel source expanded to RGBX.
+ * - packRowRGBX():   RGBX -> RGB24, used once per frame to hand the result to
+ *   Window::present (or to a headless RGB24 buffer).
+ */
+void fillSpan32(uint32_t* dst, uint32_t px, int count);
+void copySpan32(uint32_t* dst, const uint32_t* src, int count);
+void blitRowRGBA32(uint32_t* dst, const unsigned char* srcRGBA, int count);
+void blitRowRGB32(uint32_t* dst, const unsigned char* srcRGB, int count);
+void packRowRGBX(unsigned char* dstRGB, const uint32_t* src, int count);
+
+// Rect-level operations, clipped to the surface (same rules as the RGB24 ones)
+void fillRect(const Surface32& dst, int x0, int y0, int w, int h,
+    unsigned char r, unsigned char g, unsigned char b);
+void fillRectStipple(const Surface32& dst, int x0, int y0, int wdt, int hgt,
+    unsigned char r, unsigned char g, unsigned char b, int pattern);
+void putPix(const Surface32& dst, int x, int y,
+    unsigned char r, unsigned char g, unsigned char b);
+
+void blitImage(const Surface32& dst,
+    const GamesEngineeringBase::Image& img,
+    int dstX, int dstY);
+
+void blitSubImage(const Surface32& dst,
+    const GamesEngineeringBase::Image& img,
+    int srcX, int srcY, int subW, int subH,
+    int dstX, int dstY);
+
+// Converts rows [y0, y1) of src into dst (same width/height); whole surface by default
+void convertToRGB24(const Surface32& src, const Surface& dst, int y0 = 0, int y1 = -1);
@@ -1,4 +1,8 @@
 ﻿#include "gfx_utils.h"
+#include "FrameCommands.h"
+#include "blit32.h"
+#include "GlyphCache.h"
+#include "HudLayer.h"
 using namespace GamesEngineeringBase;
 
 /*
@@ -21,9 +25,16 @@ using namespace GamesEngineeringBase;
 void fillRect(Window& canvas, int x0, int y0, int w, int h,
     unsigned char r, unsigned char g, unsigned char b)
 {
-    // Clamp to window boundaries before writing to buffer
-    int W = (int)canvas.getWidth();
-    int H = (int)canvas.getHeight();
+    fillRect(Surface::of(canvas), x0, y0, w, h, r, g, b);
+}
+
+// Same fill on any RGB24 surface (offscreen buffers, tile chunk baking).
+void fillRect(const Surface& dst, int x0, int y0, int w, int h,
+    unsigned char r, unsigned char g, unsigned char b)
+{
+    // Clamp to surface boundaries before writing to buffer
+    int W = dst.width;
+    int H = dst.height;
     int x1 = x0 + w;
     int y1 = y0 + h;
 
@@ -32,14 +43,15 @@ void fillRect(Window& canvas, int x0, int y0, int w, int h,
     if (y0 < 0) y0 = 0;
     if (x1 > W) x1 = W;
     if (y1 > H) y1 = H;
+    dst.markDirty(x0, y0, x1 - x0, y1 - y0);
 
-    // Write RGB values directly into the back buffer
+    // Write RGB values directly into the buffer
     for (int y = y0; y < y1; ++y)
     {
-        int base = y * W;
-        for (int x = x0; x < x1; ++x)
+        unsigned char* p = dst.row(y) + (size_t)x0 * 3;
+        for (int x = x0; x < x1; ++x, p += 3)
         {
-            canvas.draw(base + x, r, g, b);
+            p[0] = r; p[1] = g; p[2] = b;
         }
     }
 }
@@ -70,96 +82,165 @@ void idToColor(int id, unsigned char& r, unsigned char& g, unsigned char& b)
 void putPix(GamesEngineeringBase::Window& w, int x, int y,
     unsigned char r, unsigned char g, unsigned char b)
 {
-    const int W = (int)w.getWidth(), H = (int)w.getHeight();
-    if ((unsigned)x >= (unsigned)W || (unsigned)y >= (unsigned)H) return;
-    w.draw(y * W + x, r, g, b);
+    putPix(Surface::of(w), x, y, r, g, b);
 }
 
-void fillRectUI(GamesEngineeringBase::Window& w, int x0, int y0, int wdt, int hgt,
+void putPix(const Surface& dst, int x, int y,
     unsigned char r, unsigned char g, unsigned char b)
 {
-    const int W = (int)w.getWidth(), H = (int)w.getHeight();
-    int x1 = x0 + wdt, y1 = y0 + hgt;
-    if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
-    if (x1 > W) x1 = W; if (y1 > H) y1 = H;
-    if (x0 >= x1 || y0 >= y1) return;
-    for (int y = y0; y < y1; ++y) {
-        int base = y * W;
-        for (int x = x0; x < x1; ++x) {
-            w.draw(base + x, r, g, b);
-        }
-    }
+    if ((unsigned)x >= (unsigned)dst.width || (unsigned)y >= (unsigned)dst.height) return;
+    unsigned char* p = dst.row(y) + (size_t)x * 3;
+    p[0] = r; p[1] = g; p[2] = b;
 }
 
+void fillRectUI(GamesEngineeringBase::Window& w, int x0, int y0, int wdt, int hgt,
+    unsigned char r, unsigned char g, unsigned char b)
+{
+    fillRect(Surface::of(w), x0, y0, wdt, hgt, r, g, b);
+}
 
-// Minimal ASCII set used by HUD.
+// Printable ASCII (0x20–0x7E). Digits and the original HUD capitals keep
+// their first hand-drawn shapes; the rest follow the classic 5x7 LCD font.
 const Glyph5x7* getGlyph5x7(char c)
 {
-    // digits 0–9
-    static const Glyph5x7 G0 = { {0x1E,0x11,0x13,0x15,0x19,0x11,0x1E} };
-    static const Glyph5x7 G1 = { {0x04,0x0C,0x14,0x04,0x04,0x04,0x1F} };
-    static const Glyph5x7 G2 = { {0x1E,0x01,0x01,0x1E,0x10,0x10,0x1F} };
-    static const Glyph5x7 G3 = { {0x1E,0x01,0x01,0x0E,0x01,0x01,0x1E} };
-    static const Glyph5x7 G4 = { {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02} };
-    static const Glyph5x7 G5 = { {0x1F,0x10,0x10,0x1E,0x01,0x01,0x1E} };
-    static const Glyph5x7 G6 = { {0x0E,0x10,0x10,0x1E,0x11,0x11,0x1E} };
-    static const Glyph5x7 G7 = { {0x1F,0x01,0x02,0x04,0x08,0x08,0x08} };
-    static const Glyph5x7 G8 = { {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E} };
-    static const Glyph5x7 G9 = { {0x1E,0x11,0x11,0x1E,0x01,0x01,0x0E} };
-
-    // letters we actually print: TIME, FPS, KILLS, etc.
-    static const Glyph5x7 GT = { {0x1F,0x04,0x04,0x04,0x04,0x04,0x04} };
-    static const Glyph5x7 GI = { {0x1F,0x04,0x04,0x04,0x04,0x04,0x1F} };
-    static const Glyph5x7 GM = { {0x11,0x1B,0x15,0x11,0x11,0x11,0x11} };
-    static const Glyph5x7 GE = { {0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F} };
-    static const Glyph5x7 GF = { {0x1F,0x10,0x10,0x1E,0x10,0x10,0x10} };
-    static const Glyph5x7 GP = { {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10} };
-    static const Glyph5x7 GS = { {0x0F,0x10,0x10,0x1E,0x01,0x01,0x1E} };
-    static const Glyph5x7 GK = { {0x11,0x12,0x14,0x18,0x14,0x12,0x11} };
-    static const Glyph5x7 GL = { {0x10,0x10,0x10,0x10,0x10,0x10,0x1F} };
-    static const Glyph5x7 GO = { {0x0E,0x11,0x11,0x11,0x11,0x11,0x0E} };
-    static const Glyph5x7 GR = { {0x1E,0x11,0x11,0x1E,0x14,0x12,0x11} };
-
-    static const Glyph5x7 GCOL = { {0x00,0x04,0x00,0x00,0x00,0x04,0x00} }; // ':'
-
-    if (c >= '0' && c <= '9') {
-        static const Glyph5x7* DIG[10] = { &G0,&G1,&G2,&G3,&G4,&G5,&G6,&G7,&G8,&G9 };
-        return DIG[c - '0'];
-    }
-    switch (c) {
-    case 'T': return &GT; case 'I': return &GI; case 'M': return &GM; case 'E': return &GE;
-    case 'F': return &GF; case 'P': return &GP; case 'S': return &GS;
-    case 'K': return &GK; case 'L': return &GL; case 'O': return &GO; case 'R': return &GR;
-    case ':': return &GCOL;
-    }
-    return nullptr;
+    static const Glyph5x7 FONT[95] = {
+        { {0x00,0x00,0x00,0x00,0x00,0x00,0x00} }, // ' '
+        { {0x04,0x04,0x04,0x04,0x00,0x00,0x04} }, // '!'
+        { {0x0A,0x0A,0x0A,0x00,0x00,0x00,0x00} }, // '"'
+        { {0x0A,0x0A,0x1F,0x0A,0x1F,0x0A,0x0A} }, // '#'
+        { {0x04,0x0F,0x14,0x0E,0x05,0x1E,0x04} }, // '$'
+        { {0x18,0x19,0x02,0x04,0x08,0x13,0x03} }, // '%'
+        { {0x0C,0x12,0x14,0x08,0x15,0x12,0x0D} }, // '&'
+        { {0x0C,0x04,0x08,0x00,0x00,0x00,0x00} }, // '\''
+        { {0x02,0x04,0x08,0x08,0x08,0x04,0x02} }, // '('
+        { {0x08,0x04,0x02,0x02,0x02,0x04,0x08} }, // ')'
+        { {0x00,0x04,0x15,0x0E,0x15,0x04,0x00} }, // '*'
+        { {0x00,0x04,0x04,0x1F,0x04,0x04,0x00} }, // '+'
+        { {0x00,0x00,0x00,0x00,0x0C,0x04,0x08} }, // ','
+        { {0x00,0x00,0x00,0x1F,0x00,0x00,0x00} }, // '-'
+        { {0x00,0x00,0x00,0x00,0x00,0x0C,0x0C} }, // '.'
+        { {0x00,0x01,0x02,0x04,0x08,0x10,0x00} }, // '/'
+        { {0x1E,0x11,0x13,0x15,0x19,0x11,0x1E} }, // '0'
+        { {0x04,0x0C,0x14,0x04,0x04,0x04,0x1F} }, // '1'
+        { {0x1E,0x01,0x01,0x1E,0x10,0x10,0x1F} }, // '2'
+        { {0x1E,0x01,0x01,0x0E,0x01,0x01,0x1E} }, // '3'
+        { {0x02,0x06,0x0A,0x12,0x1F,0x02,0x02} }, // '4'
+        { {0x1F,0x10,0x10,0x1E,0x01,0x01,0x1E} }, // '5'
+        { {0x0E,0x10,0x10,0x1E,0x11,0x11,0x1E} }, // '6'
+        { {0x1F,0x01,0x02,0x04,0x08,0x08,0x08} }, // '7'
+        { {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E} }, // '8'
+        { {0x1E,0x11,0x11,0x1E,0x01,0x01,0x0E} }, // '9'
+        { {0x00,0x04,0x00,0x00,0x00,0x04,0x00} }, // ':'
+        { {0x00,0x0C,0x0C,0x00,0x0C,0x04,0x08} }, // ';'
+        { {0x02,0x04,0x08,0x10,0x08,0x04,0x02} }, // '<'
+        { {0x00,0x00,0x1F,0x00,0x1F,0x00,0x00} }, // '='
+        { {0x08,0x04,0x02,0x01,0x02,0x04,0x08} }, // '>'
+        { {0x0E,0x11,0x01,0x02,0x04,0x00,0x04} }, // '?'
+        { {0x0E,0x11,0x01,0x0D,0x15,0x15,0x0E} }, // '@'
+        { {0x0E,0x11,0x11,0x11,0x1F,0x11,0x11} }, // 'A'
+        { {0x1E,0x11,0x11,0x1E,0x11,0x11,0x1E} }, // 'B'
+        { {0x0E,0x11,0x10,0x10,0x10,0x11,0x0E} }, // 'C'
+        { {0x1C,0x12,0x11,0x11,0x11,0x12,0x1C} }, // 'D'
+        { {0x1F,0x10,0x10,0x1E,0x10,0x10,0x1F} }, // 'E'
+        { {0x1F,0x10,0x10,0x1E,0x10,0x10,0x10} }, // 'F'
+        { {0x0E,0x11,0x10,0x17,0x11,0x11,0x0F} }, // 'G'
+        { {0x11,0x11,0x11,0x1F,0x11,0x11,0x11} }, // 'H'
+        { {0x1F,0x04,0x04,0x04,0x04,0x04,0x1F} }, // 'I'
+        { {0x07,0x02,0x02,0x02,0x02,0x12,0x0C} }, // 'J'
+        { {0x11,0x12,0x14,0x18,0x14,0x12,0x11} }, // 'K'
+        { {0x10,0x10,0x10,0x10,0x10,0x10,0x1F} }, // 'L'
+        { {0x11,0x1B,0x15,0x11,0x11,0x11,0x11} }, // 'M'
+        { {0x11,0x11,0x19,0x15,0x13,0x11,0x11} }, // 'N'
+        { {0x0E,0x11,0x11,0x11,0x11,0x11,0x0E} }, // 'O'
+        { {0x1E,0x11,0x11,0x1E,0x10,0x10,0x10} }, // 'P'
+        { {0x0E,0x11,0x11,0x11,0x15,0x12,0x0D} }, // 'Q'
+        { {0x1E,0x11,0x11,0x1E,0x14,0x12,0x11} }, // 'R'
+        { {0x0F,0x10,0x10,0x1E,0x01,0x01,0x1E} }, // 'S'
+        { {0x1F,0x04,0x04,0x04,0x04,0x04,0x04} }, // 'T'
+        { {0x11,0x11,0x11,0x11,0x11,0x11,0x0E} }, // 'U'
+        { {0x11,0x11,0x11,0x11,0x11,0x0A,0x04} }, // 'V'
+        { {0x11,0x11,0x11,0x15,0x15,0x15,0x0A} }, // 'W'
+        { {0x11,0x11,0x0A,0x04,0x0A,0x11,0x11} }, // 'X'
+        { {0x11,0x11,0x11,0x0A,0x04,0x04,0x04} }, // 'Y'
+        { {0x1F,0x01,0x02,0x04,0x08,0x10,0x1F} }, // 'Z'
+        { {0x0E,0x08,0x08,0x08,0x08,0x08,0x0E} }, // '['
+        { {0x00,0x10,0x08,0x04,0x02,0x01,0x00} }, // backslash
+        { {0x0E,0x02,0x02,0x02,0x02,0x02,0x0E} }, // ']'
+        { {0x04,0x0A,0x11,0x00,0x00,0x00,0x00} }, // '^'
+        { {0x00,0x00,0x00,0x00,0x00,0x00,0x1F} }, // '_'
+        { {0x08,0x04,0x02,0x00,0x00,0x00,0x00} }, // '`'
+        { {0x00,0x00,0x0E,0x01,0x0F,0x11,0x0F} }, // 'a'
+        { {0x10,0x10,0x16,0x19,0x11,0x11,0x1E} }, // 'b'
+        { {0x00,0x00,0x0E,0x10,0x10,0x11,0x0E} }, // 'c'
+        { {0x01,0x01,0x0D,0x13,0x11,0x11,0x0F} }, // 'd'
+        { {0x00,0x00,0x0E,0x11,0x1F,0x10,0x0E} }, // 'e'
+        { {0x06,0x09,0x08,0x1C,0x08,0x08,0x08} }, // 'f'
+        { {0x00,0x0F,0x11,0x11,0x0F,0x01,0x0E} }, // 'g'
+        { {0x10,0x10,0x16,0x19,0x11,0x11,0x11} }, // 'h'
+        { {0x04,0x00,0x0C,0x04,0x04,0x04,0x0E} }, // 'i'
+        { {0x02,0x00,0x06,0x02,0x02,0x12,0x0C} }, // 'j'
+        { {0x10,0x10,0x12,0x14,0x18,0x14,0x12} }, // 'k'
+        { {0x0C,0x04,0x04,0x04,0x04,0x04,0x0E} }, // 'l'
+        { {0x00,0x00,0x1A,0x15,0x15,0x11,0x11} }, // 'm'
+        { {0x00,0x00,0x16,0x19,0x11,0x11,0x11} }, // 'n'
+        { {0x00,0x00,0x0E,0x11,0x11,0x11,0x0E} }, // 'o'
+        { {0x00,0x00,0x1E,0x11,0x1E,0x10,0x10} }, // 'p'
+        { {0x00,0x00,0x0D,0x13,0x0F,0x01,0x01} }, // 'q'
+        { {0x00,0x00,0x16,0x19,0x10,0x10,0x10} }, // 'r'
+        { {0x00,0x00,0x0E,0x10,0x0E,0x01,0x1E} }, // 's'
+        { {0x08,0x08,0x1C,0x08,0x08,0x09,0x06} }, // 't'
+        { {0x00,0x00,0x11,0x11,0x11,0x13,0x0D} }, // 'u'
+        { {0x00,0x00,0x11,0x11,0x11,0x0A,0x04} }, // 'v'
+        { {0x00,0x00,0x11,0x11,0x15,0x15,0x0A} }, // 'w'
+        { {0x00,0x00,0x11,0x0A,0x04,0x0A,0x11} }, // 'x'
+        { {0x00,0x00,0x11,0x11,0x0F,0x01,0x0E} }, // 'y'
+        { {0x00,0x00,0x1F,0x02,0x04,0x08,0x1F} }, // 'z'
+        { {0x02,0x04,0x04,0x08,0x04,0x04,0x02} }, // '{'
+        { {0x04,0x04,0x04,0x04,0x04,0x04,0x04} }, // '|'
+        { {0x08,0x04,0x04,0x02,0x04,0x04,0x08} }, // '}'
+        { {0x00,0x00,0x08,0x15,0x02,0x00,0x00} }, // '~'
+    };
+    if (c < ' ' || c > '~') return nullptr;
+    return &FONT[c - ' '];
 }
 
 void drawChar5x7(GamesEngineeringBase::Window& w, int x, int y,
     char c, unsigned char r, unsigned char g, unsigned char b, int scale = 2)
 {
-    const Glyph5x7* gph = getGlyph5x7(c);
-    if (!gph) return;
-    for (int ry = 0; ry < 7; ++ry) {
-        unsigned char mask = gph->row[ry];
-        for (int rx = 0; rx < 5; ++rx) {
-            if (mask & (1 << (4 - rx))) {
-                // scale each lit pixel into a scale×scale block
-                for (int yy = 0; yy < scale; ++yy)
-                    for (int xx = 0; xx < scale; ++xx)
-                        putPix(w, x + rx * scale + xx, y + ry * scale + yy, r, g, b);
-            }
-        }
-    }
+    drawChar5x7(Surface::of(w), x, y, c, r, g, b, scale);
+}
+
+// Template bodies are shared by the RGB24 and RGBX8888 overloads below.
+// Glyphs come pre-rendered from the GlyphCache as opaque spans.
+template <class S>
+static void drawChar5x7T(const S& w, int x, int y,
+    char c, unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    if (const SpanSprite* spr = glyphCache().glyph(c, scale, r, g, b))
+        spr->draw(w, x, y);
 }
 
 void drawText5x7(GamesEngineeringBase::Window& w, int x, int y,
     const char* s, unsigned char r, unsigned char g, unsigned char b, int scale = 2, int spacing = 1)
 {
+    drawText5x7(Surface::of(w), x, y, s, r, g, b, scale, spacing);
+}
+
+// Resolves glyphs a chunk at a time, so the cache is locked once per chunk
+// rather than once per character.
+template <class S>
+static void drawText5x7T(const S& w, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    const SpanSprite* spr[64];
     int cx = x;
-    for (int i = 0; s[i]; ++i) {
-        drawChar5x7(w, cx, y, s[i], r, g, b, scale);
-        cx += 5 * scale + spacing;
+    while (*s) {
+        int n = 0;
+        while (n < 64 && s[n]) ++n;
+        glyphCache().glyphs(s, n, scale, r, g, b, spr);
+        for (int i = 0; i < n; ++i, cx += 5 * scale + spacing)
+            if (spr[i]) spr[i]->draw(w, cx, y);
+        s += n;
     }
 }
 
@@ -167,15 +248,76 @@ void drawText5x7(GamesEngineeringBase::Window& w, int x, int y,
 void drawNumber(GamesEngineeringBase::Window& w, int x, int y, int v,
     unsigned char r, unsigned char g, unsigned char b, int scale = 2)
 {
-    if (v == 0) { drawChar5x7(w, x, y, '0', r, g, b, scale); return; }
-    int buf[12]; int n = 0;
-    int t = (v < 0 ? -v : v);
-    while (t > 0 && n < 12) { buf[n++] = t % 10; t /= 10; }
-    if (v < 0) { drawChar5x7(w, x, y, '-', r, g, b, scale); x += 5 * scale + 1; }
-    for (int i = n - 1; i >= 0; --i) {
-        drawChar5x7(w, x, y, (char)('0' + buf[i]), r, g, b, scale);
-        x += 5 * scale + 1;
-    }
+    drawNumber(Surface::of(w), x, y, v, r, g, b, scale);
+}
+
+template <class S>
+static void drawNumberT(const S& w, int x, int y, int v,
+    unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    char buf[13]; int n = 13;
+    buf[--n] = '\0';
+    unsigned int t = (v < 0 ? 0u - (unsigned int)v : (unsigned int)v);
+    do { buf[--n] = (char)('0' + t % 10); t /= 10; } while (t > 0);
+    if (v < 0) buf[--n] = '-';
+    drawText5x7T(w, x, y, buf + n, r, g, b, scale, 1);
+}
+
+void drawChar5x7(const Surface& w, int x, int y,
+    char c, unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    drawChar5x7T(w, x, y, c, r, g, b, scale);
+}
+
+void drawChar5x7(const Surface32& w, int x, int y,
+    char c, unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    drawChar5x7T(w, x, y, c, r, g, b, scale);
+}
+
+void drawText5x7(const Surface& w, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    drawText5x7T(w, x, y, s, r, g, b, scale, spacing);
+}
+
+void drawText5x7(const Surface32& w, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    drawText5x7T(w, x, y, s, r, g, b, scale, spacing);
+}
+
+void drawNumber(const Surface& w, int x, int y, int v,
+    unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    drawNumberT(w, x, y, v, r, g, b, scale);
+}
+
+void drawNumber(const Surface32& w, int x, int y, int v,
+    unsigned char r, unsigned char g, unsigned char b, int scale)
+{
+    drawNumberT(w, x, y, v, r, g, b, scale);
+}
+
+// Static strings: the whole run is one cached sprite (see GlyphCache::run)
+template <class S>
+static void drawLabel5x7T(const S& w, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    if (const SpanSprite* spr = glyphCache().run(s, scale, spacing, r, g, b))
+        spr->draw(w, x, y);
+}
+
+void drawLabel5x7(const Surface& w, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    drawLabel5x7T(w, x, y, s, r, g, b, scale, spacing);
+}
+
+void drawLabel5x7(const Surface32& w, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing)
+{
+    drawLabel5x7T(w, x, y, s, r, g, b, scale, spacing);
 }
 
 // Stippled fill to fake translucency over the back buffer.
@@ -183,18 +325,27 @@ void drawNumber(GamesEngineeringBase::Window& w, int x, int y, int v,
 void fillRectStipple(GamesEngineeringBase::Window& w, int x0, int y0, int wdt, int hgt,
     unsigned char r, unsigned char g, unsigned char b, int pattern = 0)
 {
-    const int W = (int)w.getWidth(), H = (int)w.getHeight();
+    fillRectStipple(Surface::of(w), x0, y0, wdt, hgt, r, g, b, pattern);
+}
+
+// The pattern follows surface coordinates; views must start on even rows and
+// columns to line up with the full-screen pattern.
+void fillRectStipple(const Surface& dst, int x0, int y0, int wdt, int hgt,
+    unsigned char r, unsigned char g, unsigned char b, int pattern)
+{
+    const int W = dst.width, H = dst.height;
     int x1 = x0 + wdt, y1 = y0 + hgt;
     if (x0 < 0) x0 = 0; if (y0 < 0) y0 = 0;
     if (x1 > W) x1 = W; if (y1 > H) y1 = H;
     if (x0 >= x1 || y0 >= y1) return;
+    dst.markDirty(x0, y0, x1 - x0, y1 - y0);
 
     for (int y = y0; y < y1; ++y) {
-        int base = y * W;
+        unsigned char* line = dst.row(y);
         for (int x = x0; x < x1; ++x) {
             bool paint = (pattern == 0) ? (((x ^ y) & 1) == 0)
                 : (((x & 1) == 0) && ((y & 1) == 0));
-            if (paint) w.draw(base + x, r, g, b);
+            if (paint) { unsigned char* p = line + (size_t)x * 3; p[0] = r; p[1] = g; p[2] = b; }
         }
     }
 }
@@ -202,20 +353,66 @@ void fillRectStipple(GamesEngineeringBase::Window& w, int x0, int y0, int wdt, i
 // Compact HUD: TIME, FPS, KILLS; uses the 5×7 font above.
 void drawHUD(GamesEngineeringBase::Window& w,
     int remainSec, int fpsInt, int kills)
+{
+    drawHUD(Surface::of(w), remainSec, fpsInt, kills);
+}
+
+void drawHUD(const Surface& w,
+    int remainSec, int fpsInt, int kills)
 {
     const int panelX = 10, panelY = 10, panelW = 220, panelH = 80;
     fillRectStipple(w, panelX, panelY, panelW, panelH, 18, 18, 18, /*pattern=*/0);
 
-    drawText5x7(w, panelX + 8, panelY + 8, "TIME:", 255, 240, 180, 2);
+    drawLabel5x7(w, panelX + 8, panelY + 8, "TIME:", 255, 240, 180, 2);
     drawNumber(w, panelX + 92, panelY + 8, remainSec, 255, 240, 180, 2);
 
-    drawText5x7(w, panelX + 8, panelY + 32, "FPS:", 180, 220, 255, 2);
+    drawLabel5x7(w, panelX + 8, panelY + 32, "FPS:", 180, 220, 255, 2);
     drawNumber(w, panelX + 72, panelY + 32, fpsInt, 180, 220, 255, 2);
 
-    drawText5x7(w, panelX + 8, panelY + 56, "KILLS:", 200, 255, 200, 2);
+    drawLabel5x7(w, panelX + 8, panelY + 56, "KILLS:", 200, 255, 200, 2);
     drawNumber(w, panelX + 96, panelY + 56, kills, 200, 255, 200, 2);
 }
 
+void recordHUD(FrameCommands& out,
+    int remainSec, int fpsInt, int kills)
+{
+    const int panelX = 10, panelY = 10, panelW = 220, panelH = 80;
+    out.fillRectStipple(panelX, panelY, panelW, panelH, 18, 18, 18, /*pattern=*/0);
+
+    out.text(panelX + 8, panelY + 8, "TIME:", 255, 240, 180, 2);
+    out.number(panelX + 92, panelY + 8, remainSec, 255, 240, 180, 2);
+
+    out.text(panelX + 8, panelY + 32, "FPS:", 180, 220, 255, 2);
+    out.number(panelX + 72, panelY + 32, fpsInt, 180, 220, 255, 2);
+
+    out.text(panelX + 8, panelY + 56, "KILLS:", 200, 255, 200, 2);
+    out.number(panelX + 96, panelY + 56, kills, 200, 255, 200, 2);
+}
+
+// Retained version of drawHUD(): same layout, numbers as fields 0..2
+void buildHUDLayer(HudLayer& hud)
+{
+    const int panelX = 10, panelY = 10, panelW = 220, panelH = 80;
+    hud.create(panelX, panelY, panelW, panelH, HudLayer::Stipple, 18, 18, 18, /*pattern=*/0);
+
+    hud.addLabel(8, 8, "TIME:", 255, 240, 180, 2);
+    hud.addNumber(92, 8, 255, 240, 180, 2);
+
+    hud.addLabel(8, 32, "FPS:", 180, 220, 255, 2);
+    hud.addNumber(72, 32, 180, 220, 255, 2);
+
+    hud.addLabel(8, 56, "KILLS:", 200, 255, 200, 2);
+    hud.addNumber(96, 56, 200, 255, 200, 2);
+}
+
+void updateHUDLayer(HudLayer& hud,
+    int remainSec, int fpsInt, int kills)
+{
+    hud.setValue(0, remainSec);
+    hud.setValue(1, fpsInt);
+    hud.setValue(2, kills);
+}
+
 
 // ============================== Game Over panel ===============================
 // Block input loop that overlays stats and waits for ENTER/Q/ESC to exit.
@@ -230,21 +427,21 @@ void showGameOverScreen(GamesEngineeringBase::Window& w,
     // background mask
     fillRectStipple(w, 0, 0, W, H, 0, 0, 0, 1);
 
-    // centered panel
+    // centered panel, built as a retained layer like the in-game HUD
     const int panelW = 360, panelH = 200;
-    const int panelX = (W - panelW) / 2;
-    const int panelY = (H - panelH) / 2;
-    fillRectUI(w, panelX, panelY, panelW, panelH, 24, 24, 24);
+    HudLayer panel;
+    panel.create((W - panelW) / 2, (H - panelH) / 2, panelW, panelH, HudLayer::Solid, 24, 24, 24);
 
     // title + stats
-    drawText5x7(w, panelX + 24, panelY + 20, "== GAME OVER ==", 255, 220, 180, 3);
-    drawText5x7(w, panelX + 24, panelY + 80, "KILLS:", 200, 255, 200, 2);
-    drawNumber(w, panelX + 130, panelY + 80, kills, 200, 255, 200, 2);
-    drawText5x7(w, panelX + 24, panelY + 110, "FPS:", 180, 220, 255, 2);
-    drawNumber(w, panelX + 100, panelY + 110, fpsInt, 180, 220, 255, 2);
+    panel.addLabel(24, 20, "== GAME OVER ==", 255, 220, 180, 3);
+    panel.addLabel(24, 80, "KILLS:", 200, 255, 200, 2);
+    panel.setValue(panel.addNumber(130, 80, 200, 255, 200, 2), kills);
+    panel.addLabel(24, 110, "FPS:", 180, 220, 255, 2);
+    panel.setValue(panel.addNumber(100, 110, 180, 220, 255, 2), fpsInt);
 
-    drawText5x7(w, panelX + 24, panelY + 150, "Press ENTER / Q / ESC to quit",
+    panel.addLabel(24, 150, "Press ENTER / Q / ESC to quit",
         255, 240, 180, 2);
+    panel.draw(Surface::of(w));
 
     // push once, then idle in a light input loop
     w.present();
@@ -1,5 +1,9 @@
 ﻿#pragma once
 #include "GamesEngineeringBase.h"
+#include "Surface.h"
+
+class FrameCommands;
+class HudLayer;
 
 /*
  * Utility: solid rectangle blit for tile/GUI primitives.
@@ -10,14 +14,19 @@
 void fillRect(GamesEngineeringBase::Window& canvas,
     int x0, int y0, int w, int h,
     unsigned char r, unsigned char g, unsigned char b);
+void fillRect(const Surface& dst,
+    int x0, int y0, int w, int h,
+    unsigned char r, unsigned char g, unsigned char b);
 void idToColor(int id, unsigned char& r, unsigned char& g, unsigned char& b);
 void putPix(GamesEngineeringBase::Window& w, int x, int y,
     unsigned char r, unsigned char g, unsigned char b);
+void putPix(const Surface& dst, int x, int y,
+    unsigned char r, unsigned char g, unsigned char b);
 void fillRectUI(GamesEngineeringBase::Window& w, int x0, int y0, int wdt, int hgt,
     unsigned char r, unsigned char g, unsigned char b);
 // 5x7 glyph: 7 rows, low 5 bits per row are pixels (MSB-left ordering below).
 struct Glyph5x7 { unsigned char row[7]; };
-// Minimal ASCII set used by HUD.
+// Printable ASCII (0x20–0x7E); nullptr for anything else.
 const Glyph5x7* getGlyph5x7(char c);
 void drawChar5x7(GamesEngineeringBase::Window& w, int x, int y,
     char c, unsigned char r, unsigned char g, unsigned char b, int scale);
@@ -29,5 +38,35 @@ void fillRectStipple(GamesEngineeringBase::Window& w, int x0, int y0, int wdt, i
     unsigned char r, unsigned char g, unsigned char b, int pattern);
 void drawHUD(GamesEngineeringBase::Window& w,
     int remainSec, int fpsInt, int kills);
+// Surface versions of the HUD primitives (offscreen/banded rendering)
+void drawChar5x7(const Surface& dst, int x, int y,
+    char c, unsigned char r, unsigned char g, unsigned char b, int scale);
+void drawText5x7(const Surface& dst, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing = 1);
+void drawNumber(const Surface& dst, int x, int y, int v,
+    unsigned char r, unsigned char g, unsigned char b, int scale);
+void fillRectStipple(const Surface& dst, int x0, int y0, int wdt, int hgt,
+    unsigned char r, unsigned char g, unsigned char b, int pattern);
+void drawHUD(const Surface& dst,
+    int remainSec, int fpsInt, int kills);
+// Text that never changes (labels): drawn from a cached per-string sprite
+void drawLabel5x7(const Surface& dst, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing = 1);
+void drawLabel5x7(const Surface32& dst, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing = 1);
+// RGBX8888 text (see blit32.h for the fill/blit primitives)
+void drawChar5x7(const Surface32& dst, int x, int y,
+    char c, unsigned char r, unsigned char g, unsigned char b, int scale);
+void drawText5x7(const Surface32& dst, int x, int y,
+    const char* s, unsigned char r, unsigned char g, unsigned char b, int scale, int spacing = 1);
+void drawNumber(const Surface32& dst, int x, int y, int v,
+    unsigned char r, unsigned char g, unsigned char b, int scale);
+// Records the same HUD into a command list (banded renderer)
+void recordHUD(FrameCommands& out,
+    int remainSec, int fpsInt, int kills);
+// Retained HUD: build once, update values every frame, then hud.draw()/record()
+void buildHUDLayer(HudLayer& hud);
+void updateHUDLayer(HudLayer& hud,
+    int remainSec, int fpsInt, int kills);
 void showGameOverScreen(GamesEngineeringBase::Window& w,
     int kills, int fpsInt);
\ No newline at end of file
@@ -5,40 +5,66 @@
 #include <iostream>
 #include <filesystem>
 #include <iomanip>
+#include <cstring>
+#include <thread>
 #include "GamesEngineeringBase.h"
 #include "gfx_utils.h"
 #include "blit.h"
 #include "TileMap.h"
+#include "ScrollingBackground.h"
+#include "DirtyRects.h"
+#include "FrameCommands.h"
+#include "FrameBuffer32.h"
+#include "TextureAtlas.h"
+#include "HudLayer.h"
+#include "AssetPack.h"
 #include "SpriteSheet.h"
 #include "Animator.h"
 #include "Player.h" 
 #include "NPCSystem.h"
 #include "PickupSystem.h"
 #include "SaveLoad.h"
+#include "bench.h"
 
 using namespace GamesEngineeringBase;
 using namespace std;
 
 // -----------------------------------------------------------------------------
 // Runtime mode toggle. Fixed = finite map with camera clamping.
-// Infinite = wrapping map; spawn/culling rules differ in systems.
+// Infinite = wrapping map (or, when generated, the map inside an endless
+// ChunkedWorld); spawn/culling rules differ in systems.
 // -----------------------------------------------------------------------------
 enum class GameMode { Fixed, Infinite };
 GameMode gMode = GameMode::Fixed;
 
+// Back-buffer pixel format. false = draw straight into Window's RGB24 buffer;
+// true = draw into an RGBX8888 frame (whole-word/SIMD writes) and convert the
+// changed rects to RGB24 before present. See "--bench fill" to choose per platform.
+static const bool kBackBuffer32 = false;
+
 struct PerfLogger {
     std::ofstream out;
     double accum = 0.0;
     bool ready = false;
+    long long redrawnPx = 0;   // background pixels re-rendered since the last row
+    long long clearedBytes = 0; // background bytes zeroed (not covered by opaque tiles)
+    int frames = 0;
+    double dirtyRatio = 0.0;   // sum of per-frame uploaded/total pixel ratios
 
     void init(const char* path) {
         std::filesystem::create_directories("logs");
         out.open(path, std::ios::out | std::ios::trunc);
         if (out) {
-            out << "time,fps,enemies\n"; // CSV header
+            out << "time,fps,enemies,bg_px_per_frame,bg_cleared_bytes_per_frame,dirty_pct\n"; // CSV header
             ready = true;
         }
     }
+    // Called once per frame with the pixels ScrollingBackground had to redraw
+    // and the bytes it had to clear before drawing them
+    void addRedrawn(long long px, long long cleared) { redrawnPx += px; clearedBytes += cleared; ++frames; }
+    // Called once per frame with the pixels DirtyFrame uploaded
+    void addDirty(long long px, long long total) { if (total > 0) dirtyRatio += (double)px / total; }
+
     void tick(float dt,
         float totalTime,
         float fpsSmoothed,
@@ -51,15 +77,22 @@ struct PerfLogger {
 
         // count alive enemies without touching internals
         int alive = 0;
-        const NPC* arr = mgr.getArray();
-        for (int i = 0; i < EnemyManager::MAX; ++i)
-            if (arr[i].isAlive()) ++alive;
+        const NPCStore& store = mgr.getStore();
+        for (int i = 0; i < store.capacity(); ++i)
+            if (store.isAlive(i)) ++alive;
 
         out << std::fixed << std::setprecision(2)
             << totalTime << ","
             << (double)fpsSmoothed << ","
-            << alive << "\n";
+            << alive << ","
+            << (frames ? (double)redrawnPx / frames : 0.0) << ","
+            << (frames ? (double)clearedBytes / frames : 0.0) << ","
+            << (frames ? 100.0 * dirtyRatio / frames : 0.0) << "\n";
         out.flush();
+        redrawnPx = 0;
+        clearedBytes = 0;
+        frames = 0;
+        dirtyRatio = 0.0;
     }
     void close() { if (out) out.close(); }
 };
@@ -79,36 +112,104 @@ void initFpsBuffer() {
     dtIdx = 0; dtCount = 0; dtSum = 0.0; fpsDisplay = 60;
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    // Headless benchmarks: no window, no D3D device
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return runBenchmarks(argc - 2, argv + 2);
+
+    // Offline asset packing: decode Resources/*.png once into a mapped pack
+    if (argc > 1 && strcmp(argv[1], "--pack-assets") == 0) {
+        const char* out = argc > 2 ? argv[2] : "Resources/assets.pak";
+        int n = writeAssetPack("Resources", out);
+        if (n < 0) { printf("[PACK] failed to write %s\n", out); return 1; }
+        printf("[PACK] %d images -> %s\n", n, out);
+        return 0;
+    }
+
+    // Offline map compiling: tiles.txt -> binary map mapped at startup
+    if (argc > 1 && strcmp(argv[1], "--compile-map") == 0) {
+        const char* in = argc > 2 ? argv[2] : "Resources/tiles.txt";
+        const char* out = argc > 3 ? argv[3] : "Resources/tiles.map";
+        TileMap src;
+        if (!src.load(in)) { printf("[MAP] %s\n", src.getLoadError().c_str()); return 1; }
+        if (!src.saveBinary(out)) { printf("[MAP] failed to write %s\n", out); return 1; }
+        printf("[MAP] %dx%d tiles -> %s\n", src.getWidth(), src.getHeight(), out);
+        return 0;
+    }
+
     // Window + content bootstrap
     Window canvas;
     canvas.create(960, 540, "prototype");
 
+    // Compiled map (see --compile-map) unless tiles.txt was edited after it
+    // was compiled; a stale or unreadable tiles.map falls back to the text
     TileMap map;
-    if (!map.load("Resources/tiles.txt")) {
-        printf("Failed to load tiles.txt\n");
+    const char* mapText = "Resources/tiles.txt";
+    const char* mapPath = mapText;
+    {
+        std::error_code ecBin, ecText;
+        const auto binTime = std::filesystem::last_write_time("Resources/tiles.map", ecBin);
+        const auto textTime = std::filesystem::last_write_time(mapText, ecText);
+        if (!ecBin && (ecText || binTime >= textTime)) mapPath = "Resources/tiles.map";
+        else if (!ecBin) printf("[MAP] tiles.txt is newer than tiles.map, loading the text (re-run --compile-map)\n");
+    }
+    if (!map.load(mapPath) && (mapPath == mapText || !map.load(mapText))) {
+        printf("Failed to load tiles.txt (%s)\n", map.getLoadError().c_str());
         return 1;
     }
     map.setImageFolder("Resources/"); // expects 0.png, 1.png, ... co-located
 
+    // Pre-decoded pack (see --pack-assets); without it images are decoded on demand
+    AssetPack assets;
+    if (assets.open("Resources/assets.pak")) {
+        map.attachAssetPack(&assets);
+        printf("Assets: %d images mapped from Resources/assets.pak\n", assets.count());
+    }
+
+    // Tiles the preload below misses (e.g. set() at runtime) stream in on a
+    // background thread instead of stalling a frame
+    map.enableStreaming(64u << 20, 30.0);
+
     // Mode selection at startup (console)
-    printf("Select mode: [1] Fixed world   [2] Infinite (wrapping) world\n");
+    printf("Select mode: [1] Fixed world   [2] Infinite (wrapping) world   [3] Infinite (generated) world\n");
     printf("Your choice: ");
     int m = 1;
     std::cin >> m;
-    gMode = (m == 2 ? GameMode::Infinite : GameMode::Fixed);
+    gMode = (m == 2 || m == 3 ? GameMode::Infinite : GameMode::Fixed);
 
-    // Map wrapping mirrors the chosen mode
+    // Map wrapping mirrors the chosen mode; a generated world instead
+    // surrounds the map with noise terrain streamed in around the hero
     map.setWrap(gMode == GameMode::Infinite);
+    NoiseTerrainGenerator terrain;
+    ChunkedWorld world(&terrain);
+    const int kWorldRadiusChunks = 2;   // 5x5 chunks = 80x80 tiles, over a screen each way
+    if (m == 3) map.attachWorld(&world);
 
     // Hero sprite (rows: down/right/left/up in that order; 4 columns for walk cycle)
+    // Decoded on a side thread while the tile pool decodes every referenced tile
     SpriteSheet heroSheet;
-    if (!heroSheet.load("Resources/Abigail.png", /*frameW*/16, /*frameH*/32, /*rows*/13, /*cols*/4)) {
+    bool heroLoaded = false;
+    std::thread heroLoader([&] {
+        heroLoaded = heroSheet.load("Resources/Abigail.png", /*frameW*/16, /*frameH*/32, /*rows*/13, /*cols*/4, &assets);
+    });
+    int preloaded = map.preloadTiles();
+    heroLoader.join();
+    printf("Preloaded %d tile images\n", preloaded);
+    if (!heroLoaded) {
         printf("❌ Failed to load Abigail sprite\n");
         return 1;
     }
 
+    // Pack every referenced tile into one atlas (hero frames draw as spans)
+    TextureAtlas atlas;
+    int atlasTiles = map.addTilesToAtlas(atlas);
+    if (atlas.build()) {
+        map.attachAtlas(&atlas);
+        printf("Atlas: %d tiles, %zu KB (%.0f%% used)\n",
+            atlasTiles, atlas.bytes() >> 10, atlas.occupancy() * 100.f);
+    }
+
     // Player wiring
     Player hero;
     hero.attachSprite(&heroSheet);
@@ -148,6 +249,13 @@ int main()
 
     initFpsBuffer();
     PerfLogger perf;
+    ScrollingBackground background;
+    DirtyFrame dirty;
+    BandRasterizer raster(0);    // one band per hardware thread; 1 = serial path
+    FrameCommands frameCmds;
+    FrameBuffer32 frame32;       // only used when kBackBuffer32 is set
+    HudLayer hud;                // panel + labels rendered once, numbers on change
+    buildHUDLayer(hud);
     bool isInfinite = (gMode == GameMode::Infinite);
     if (isInfinite)
         perf.init("logs/performance_infinite.csv");
@@ -289,22 +397,65 @@ int main()
         }
 
         // =============================== Render ===============================
-        canvas.clear();
-
-        map.draw(canvas, camX, camY);                       // world tiles (wrapping if enabled)
-        npcSys.drawAll(canvas, (float)camX, (float)camY);   // enemies
-        npcSys.drawBullets(canvas, (float)camX, (float)camY);
-        npcSys.drawHeroBullets(canvas, (float)camX, (float)camY);
-        pickups.draw(canvas, (float)camX, (float)camY);
-        hero.draw(canvas, camX, camY);                      // hero on top
+        // Draws from here on record their rects into dirty.current()
+        dirty.begin(canvas);
+        Surface screen = Surface::of(canvas);
+
+        // World tiles: scroll last frame's background and draw only the exposed
+        // strips, then copy it in (this also stands in for canvas.clear()).
+        // With a still camera only last frame's sprite rects need restoring.
+        map.pumpStreaming();
+        if (map.getWorld()) {
+            const int heroTileX = (int)std::floor((hero.getX() + hero.getW() * 0.5f) / map.getTileW());
+            const int heroTileY = (int)std::floor((hero.getY() + hero.getH() * 0.5f) / map.getTileH());
+            world.update(heroTileX, heroTileY, kWorldRadiusChunks);
+        }
+        background.update(map, camX, camY, (int)canvas.getWidth(), (int)canvas.getHeight());
+        perf.addRedrawn(background.redrawnPixels(), background.clearedBytes());
 
         // HUD (time left clamps at 0 for neatness)
         int remain = (int)((120.f - totalTime) + 0.999f);
         if (remain < 0) remain = 0;
-        drawHUD(canvas, remain, fpsDisplay, totalKills);
+        updateHUDLayer(hud, remain, fpsDisplay, totalKills);
+
+        if (kBackBuffer32 || raster.getThreads() > 1) {
+            // Record the frame, then rasterize it in horizontal bands in parallel
+            frameCmds.clear();
+            if (background.changed()) frameCmds.background(background);
+            else                      frameCmds.background(background, &dirty.stale());
+            npcSys.recordAll(frameCmds, (float)camX, (float)camY);
+            npcSys.recordBullets(frameCmds, (float)camX, (float)camY);
+            npcSys.recordHeroBullets(frameCmds, (float)camX, (float)camY);
+            pickups.record(frameCmds, (float)camX, (float)camY);
+            hero.record(frameCmds, camX, camY);
+            hud.record(frameCmds);
+            if (kBackBuffer32) {
+                // Render RGBX8888, then convert what changed into the RGB24 back buffer
+                frame32.resize((int)canvas.getWidth(), (int)canvas.getHeight());
+                Surface32 target = frame32.surface();
+                target.dirty = &dirty.current();
+                raster.run(frameCmds, target);
+                frame32.resolve(screen, dirty.stale());
+                frame32.resolve(screen, dirty.current());
+            }
+            else {
+                raster.run(frameCmds, screen);
+            }
+        }
+        else {
+            if (background.changed()) background.composite(screen);
+            else                      background.composite(screen, dirty.stale());
+            npcSys.drawAll(canvas, (float)camX, (float)camY);   // enemies
+            npcSys.drawBullets(canvas, (float)camX, (float)camY);
+            npcSys.drawHeroBullets(canvas, (float)camX, (float)camY);
+            pickups.draw(canvas, (float)camX, (float)camY);
+            hero.draw(canvas, camX, camY);                      // hero on top
+            hud.draw(screen);
+        }
 
-        // Present back buffer
-        canvas.present();
+        // Present back buffer (uploads only this frame's and last frame's rects)
+        dirty.present(canvas);
+        perf.addDirty(dirty.dirtyPixels(), (long long)canvas.getWidth() * canvas.getHeight());
 
         // Two-minute session ends the loop; show stats and exit cleanly
         if (totalTime >= 120.f) {